@@ -2,7 +2,9 @@
 #include "natives.h"
 #include "modules/tags.h"
 #include "modules/amxutils.h"
+#include "modules/memory.h"
 #include <unordered_map>
+#include <stdexcept>
 
 #include "subhook/subhook.h"
 
@@ -36,6 +38,16 @@ struct natives_extra : public amx::extra
 
 static std::unordered_map<AMX*, std::shared_ptr<amx::instance>> amx_map;
 
+size_t amx::new_extra_slot()
+{
+	static size_t count = 0;
+	if(count >= max_extras)
+	{
+		throw std::logic_error("[PawnPlus] Too many extra types. Adjust max_extras and recompile.");
+	}
+	return count++;
+}
+
 bool amx::valid(AMX *amx)
 {
 	return amx_map.find(amx) != amx_map.end();
@@ -72,6 +84,7 @@ const amx::object &amx::clone_lock(AMX *amx, AMX *new_amx)
 
 bool amx::unload(AMX *amx)
 {
+	memory::unload(amx);
 	auto it = amx_map.find(amx);
 	if(it != amx_map.end())
 	{
@@ -7,7 +7,7 @@
 #include "sdk/amx/amxdbg.h"
 #include <string>
 #include <vector>
-#include <typeindex>
+#include <array>
 #include <unordered_map>
 #include <cstring>
 #include <memory>
@@ -35,6 +35,73 @@ namespace amx
 		virtual ~extra() = default;
 	};
 
+	constexpr size_t max_extras = 32;
+
+	size_t new_extra_slot();
+
+	// Each extra type is assigned its own slot during static initialization
+	template <class ExtraType>
+	struct extra_slot
+	{
+		static const size_t index;
+	};
+
+	template <class ExtraType>
+	const size_t extra_slot<ExtraType>::index = new_extra_slot();
+
+	class extra_table
+	{
+		std::array<std::unique_ptr<extra>, max_extras> extras;
+
+	public:
+		extra_table() = default;
+		extra_table(const extra_table&) = delete;
+		extra_table(extra_table&&) = default;
+
+		extra_table &operator=(const extra_table&) = delete;
+		extra_table &operator=(extra_table&&) = default;
+
+		template <class ExtraType>
+		ExtraType &get(AMX *amx)
+		{
+			auto &ptr = extras[extra_slot<ExtraType>::index];
+			if(!ptr)
+			{
+				ptr = std::unique_ptr<extra>(new ExtraType(amx));
+			}
+			return static_cast<ExtraType&>(*ptr);
+		}
+
+		template <class ExtraType>
+		bool has() const
+		{
+			return extras[extra_slot<ExtraType>::index] != nullptr;
+		}
+
+		template <class ExtraType>
+		bool remove()
+		{
+			auto &ptr = extras[extra_slot<ExtraType>::index];
+			if(ptr)
+			{
+				ptr.reset();
+				return true;
+			}
+			return false;
+		}
+
+		void clone_from(const extra_table &obj)
+		{
+			for(size_t i = 0; i < max_extras; i++)
+			{
+				if(obj.extras[i])
+				{
+					extras[i] = obj.extras[i]->clone();
+				}
+			}
+		}
+	};
+
 	typedef std::weak_ptr<class instance> handle;
 	typedef std::shared_ptr<class instance> object;
 
@@ -45,7 +112,7 @@ namespace amx
 		friend bool invalidate(AMX *amx);
 
 		AMX *_amx;
-		std::unordered_map<std::type_index, std::unique_ptr<extra>> extras;
+		extra_table extras;
 		bool initialized = false;
 
 		void invalidate()
@@ -69,24 +136,13 @@ namespace amx
 
 		instance(const instance &obj, AMX *new_amx) : _amx(new_amx), name(obj.name), dbg(obj.dbg)
 		{
-			for(const auto &pair : obj.extras)
-			{
-				if(pair.second)
-				{
-					auto clone = pair.second->clone();
-					if(clone)
-					{
-						extras[pair.first] = std::move(clone);
-					}
-				}
-			}
+			extras.clone_from(obj.extras);
 		}
 
 		instance(const instance &obj) = delete;
 		instance(instance &&obj) : _amx(obj._amx), extras(std::move(obj.extras)), name(std::move(obj.name)), dbg(std::move(obj.dbg))
 		{
 			obj._amx = nullptr;
-			obj.extras.clear();
 		}
 
 		bool valid() const
@@ -104,7 +160,6 @@ namespace amx
 				name = std::move(obj.name);
 				dbg = std::move(obj.dbg);
 				obj._amx = nullptr;
-				obj.extras.clear();
 				obj.dbg = {};
 			}
 			return *this;
@@ -113,36 +168,19 @@ namespace amx
 		template <class ExtraType>
 		ExtraType &get_extra()
 		{
-			std::type_index key = typeid(ExtraType);
-
-			auto it = extras.find(key);
-			if(it == extras.end())
-			{
-				it = extras.insert(std::make_pair(key, std::unique_ptr<ExtraType>(new ExtraType(_amx)))).first;
-			}
-			return static_cast<ExtraType&>(*it->second);
+			return extras.get<ExtraType>(_amx);
 		}
 
 		template <class ExtraType>
 		bool has_extra() const
 		{
-			std::type_index key = typeid(ExtraType);
-
-			return extras.find(key) != extras.end();
+			return extras.has<ExtraType>();
 		}
 
 		template <class ExtraType>
 		bool remove_extra()
 		{
-			std::type_index key = typeid(ExtraType);
-
-			auto it = extras.find(key);
-			if(it != extras.end())
-			{
-				extras.erase(it);
-				return true;
-			}
-			return false;
+			return extras.remove<ExtraType>();
 		}
 
 		AMX *get()
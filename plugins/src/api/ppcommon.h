@@ -119,6 +119,38 @@ namespace pp
 		{
 			return get<cell(cell *value, void *tag, cell(*binary_reader)(void*, char*, cell), void *binary_reader_cookie, void*(*object_reader)(void*), void *object_reader_cookie)>(15)(&value, tag, binary_reader, binary_reader_cookie, object_reader, object_reader_cookie);
 		}
+
+		void native_stats_enable(bool enable)
+		{
+			return get<void(cell enable)>(16)(enable);
+		}
+
+		void native_stats_reset()
+		{
+			return get<void()>(17)();
+		}
+
+		cell native_stats_count()
+		{
+			return get<cell()>(18)();
+		}
+
+		// durations are in nanoseconds; returns the number of histogram buckets written, or -1 for an invalid index
+		cell native_stats_get(cell index, const char **name, long long *calls, long long *total, long long *max, long long *histogram, cell histogram_size)
+		{
+			return get<cell(cell index, const char **name, long long *calls, long long *total, long long *max, long long *histogram, cell histogram_size)>(19)(index, name, calls, total, max, histogram, histogram_size);
+		}
+
+		// the pool is one of the memory_pool values; counted only while memory tracking is enabled, returns false for an invalid pool
+		bool memory_usage(cell pool, cell *objects, cell *bytes, cell *peak)
+		{
+			return get<cell(cell pool, cell *objects, cell *bytes, cell *peak)>(20)(pool, objects, bytes, peak);
+		}
+
+		void snapshot_memory(AMX *amx, cell *live, cell *peak, cell *shared, cell *cached)
+		{
+			return get<void(AMX *amx, cell *live, cell *peak, cell *shared, cell *cached)>(21)(amx, live, peak, shared, cached);
+		}
 	};
 
 	class tag_table : public api_table
@@ -639,6 +671,23 @@ namespace pp
 		{
 			return get<void*(void *task)>(17)(task);
 		}
+
+		// the post functions may be called from any thread and complete the task on the main thread
+
+		void post_completed(cell id, cell value, const void *tag)
+		{
+			return get<void(cell id, cell value, const void *tag)>(18)(id, value, tag);
+		}
+
+		void post_completed_arr(cell id, const cell *arr, cell size, const void *tag)
+		{
+			return get<void(cell id, const cell *arr, cell size, const void *tag)>(19)(id, arr, size, tag);
+		}
+
+		void post_faulted(cell id, cell error)
+		{
+			return get<void(cell id, cell error)>(20)(id, error);
+		}
 	};
 
 	extern main_table main;
@@ -3,7 +3,8 @@
 
 #include <unordered_map>
 #include <forward_list>
-#include <deque>
+#include <vector>
+#include <memory>
 #include <stdexcept>
 
 int globalExecLevel = 0;
@@ -12,14 +13,38 @@ bool runGroundCallback = false;
 
 const int &amx::context_level = globalExecLevel;
 
+size_t context_alloc_count = 0;
+
 struct AMX_STATE : public amx::extra
 {
-	std::deque<amx::context> contexts;
+	// contexts above depth are kept allocated for the next push
+	std::vector<std::unique_ptr<amx::context>> contexts;
+	size_t depth = 0;
 
 	AMX_STATE(AMX *amx) : amx::extra(amx)
 	{
 
 	}
+
+	amx::context &push(AMX *amx, int index)
+	{
+		if(depth == contexts.size())
+		{
+			contexts.emplace_back(new amx::context(amx, index));
+			if(is_main_thread)
+			{
+				context_alloc_count++;
+			}
+		}else{
+			*contexts[depth] = amx::context(amx, index);
+		}
+		return *contexts[depth++];
+	}
+
+	amx::context &top()
+	{
+		return *contexts[depth - 1];
+	}
 };
 
 AMX_STATE &get_state(AMX *amx, amx::object &obj)
@@ -56,7 +81,7 @@ int amx::push(AMX *amx, int index)
 {
 	globalExecLevel++;
 	amx::object obj;
-	get_state(amx, obj).contexts.emplace_back(amx, index);
+	get_state(amx, obj).push(amx, index);
 	return globalExecLevel;
 }
 
@@ -68,10 +93,10 @@ int amx::pop(AMX *amx)
 	}
 
 	amx::object obj;
-	auto &contexts = get_state(amx, obj).contexts;
+	auto &state = get_state(amx, obj);
 	{
-		auto top = std::move(contexts.back());
-		contexts.pop_back();
+		auto top = std::move(state.top());
+		state.depth--;
 	}
 
 	globalExecLevel--;
@@ -100,7 +125,7 @@ bool amx::has_context(AMX *amx)
 		return false;
 	}
 	amx::object obj;
-	return get_state(amx, obj).contexts.size() > 0;
+	return get_state(amx, obj).depth > 0;
 }
 
 amx::context &amx::get_context(AMX *amx, amx::object &obj)
@@ -109,10 +134,9 @@ amx::context &amx::get_context(AMX *amx, amx::object &obj)
 	{
 		obj = std::make_shared<amx::instance>(amx);
 		auto &state = obj->get_extra<AMX_STATE>();
-		state.contexts.emplace_back(amx, 0);
-		return state.contexts.back();
+		return state.push(amx, 0);
 	}
-	return get_state(amx, obj).contexts.back();
+	return get_state(amx, obj).top();
 }
 
 bool amx::has_parent_context(AMX *amx)
@@ -122,7 +146,7 @@ bool amx::has_parent_context(AMX *amx)
 		return false;
 	}
 	amx::object obj;
-	return get_state(amx, obj).contexts.size() > 1;
+	return get_state(amx, obj).depth > 1;
 }
 
 amx::context &amx::get_parent_context(AMX *amx, amx::object &obj)
@@ -131,7 +155,8 @@ amx::context &amx::get_parent_context(AMX *amx, amx::object &obj)
 	{
 		return get_context(amx, obj);
 	}
-	return *std::prev(get_state(amx, obj).contexts.end(), 2);
+	auto &state = get_state(amx, obj);
+	return *state.contexts[state.depth - 2];
 }
 
 void amx::restore(AMX *amx, context &&context)
@@ -140,6 +165,11 @@ void amx::restore(AMX *amx, context &&context)
 	get_context(amx, obj) = std::move(context);
 }
 
+size_t amx::context_allocs()
+{
+	return context_alloc_count;
+}
+
 void amx::on_bottom(void(*callback)(AMX*))
 {
 	ground_callbacks.add(callback);
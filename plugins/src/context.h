@@ -46,7 +46,7 @@ namespace amx
 	{
 		AMX *_amx;
 		int _index;
-		std::unordered_map<std::type_index, std::unique_ptr<extra>> extras;
+		extra_table extras;
 
 	public:
 		context() : _amx(nullptr), _index(0)
@@ -63,7 +63,6 @@ namespace amx
 		context(context &&obj) : _amx(obj._amx), _index(obj._index), extras(std::move(obj.extras))
 		{
 			obj._amx = nullptr;
-			obj.extras.clear();
 		}
 
 		context &operator=(const context &obj) = delete;
@@ -75,7 +74,6 @@ namespace amx
 				_index = obj._index;
 				extras = std::move(obj.extras);
 				obj._amx = nullptr;
-				obj.extras.clear();
 			}
 			return *this;
 		}
@@ -88,36 +86,19 @@ namespace amx
 		template <class ExtraType>
 		ExtraType &get_extra()
 		{
-			std::type_index key = typeid(ExtraType);
-
-			auto it = extras.find(key);
-			if(it == extras.end())
-			{
-				it = extras.insert(std::make_pair(key, std::unique_ptr<ExtraType>(new ExtraType(_amx)))).first;
-			}
-			return static_cast<ExtraType&>(*it->second);
+			return extras.get<ExtraType>(_amx);
 		}
 
 		template <class ExtraType>
 		bool has_extra() const
 		{
-			std::type_index key = typeid(ExtraType);
-
-			return extras.find(key) != extras.end();
+			return extras.has<ExtraType>();
 		}
 
 		template <class ExtraType>
 		bool remove_extra()
 		{
-			std::type_index key = typeid(ExtraType);
-
-			auto it = extras.find(key);
-			if(it != extras.end())
-			{
-				extras.erase(it);
-				return true;
-			}
-			return false;
+			return extras.remove<ExtraType>();
 		}
 	};
 
@@ -130,6 +111,8 @@ namespace amx
 	bool has_parent_context(AMX *amx);
 	context &get_parent_context(AMX *amx, object &obj);
 
+	size_t context_allocs();
+
 	void on_bottom(void(*callback)(AMX*));
 }
 
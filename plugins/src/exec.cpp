@@ -90,6 +90,39 @@ int AMXAPI amx_on_debug(AMX *amx)
 	return AMX_ERR_NONE;
 }
 
+static parallel_context *get_parallel_debug(AMX *amx)
+{
+	if(amx->debug == amx_on_debug)
+	{
+		amx::object owner;
+		auto &ctx = amx::get_context(amx, owner);
+		if(ctx.has_extra<parallel_context>())
+		{
+			return &ctx.get_extra<parallel_context>();
+		}
+	}
+	return nullptr;
+}
+
+AMX_DEBUG amx_get_debug_hook(AMX *amx)
+{
+	if(auto extra = get_parallel_debug(amx))
+	{
+		return extra->old_debug;
+	}
+	return amx->debug;
+}
+
+void amx_set_debug_hook(AMX *amx, AMX_DEBUG hook)
+{
+	if(auto extra = get_parallel_debug(amx))
+	{
+		extra->old_debug = hook;
+	}else{
+		amx->debug = hook;
+	}
+}
+
 int AMXAPI amx_ExecContext(AMX *amx, cell *retval, int index, bool restore, amx::reset *reset, bool forked)
 {
 	bool main_thread = is_main_thread;
@@ -98,6 +131,10 @@ int AMXAPI amx_ExecContext(AMX *amx, cell *retval, int index, bool restore, amx:
 	bool restore_context = false;
 	AMX_DEBUG old_debug;
 	bool restore_debug = false;
+	// the hook was replaced by the one of a parallel section in this context
+	bool parallel_debug = false;
+	// the hook of the parallel section in the parent context was removed for this call
+	bool parent_debug = false;
 	if(main_thread)
 	{
 		if(amx::context_level >= maxRecursionLevel)
@@ -146,6 +183,7 @@ int AMXAPI amx_ExecContext(AMX *amx, cell *retval, int index, bool restore, amx:
 				ctx.get_extra<parallel_context>().old_debug = old_debug = amx->debug;
 				amx->debug = amx_on_debug;
 				restore_debug = true;
+				parallel_debug = true;
 			}
 		}else if(amx->debug == amx_on_debug && amx::has_parent_context(amx))
 		{
@@ -157,6 +195,7 @@ int AMXAPI amx_ExecContext(AMX *amx, cell *retval, int index, bool restore, amx:
 				amx->debug = extra.old_debug;
 				old_debug = amx_on_debug;
 				restore_debug = true;
+				parent_debug = true;
 			}
 		}
 	}
@@ -202,13 +241,13 @@ int AMXAPI amx_ExecContext(AMX *amx, cell *retval, int index, bool restore, amx:
 				if(extra.on_break)
 				{
 					extra.on_break = false;
-					extra.old_debug = nullptr;
 
 					if(restore_debug)
 					{
-						amx->debug = old_debug;
+						amx->debug = parallel_debug ? extra.old_debug : old_debug;
 						restore_debug = false;
 					}
+					extra.old_debug = nullptr;
 
 					amx->pri = 0;
 					amx->error = ret = AMX_ERR_NONE;
@@ -544,18 +583,15 @@ int AMXAPI amx_ExecContext(AMX *amx, cell *retval, int index, bool restore, amx:
 						*--stk = num;
 
 						auto sym = dbg->symboltbl[index];
-						for(uint16_t i = 0; i < dbg->hdr->symbols; i++)
+						for(uint16_t i : debug::get_symbols(dbg).parameters(sym))
 						{
 							auto vsym = dbg->symboltbl[i];
-							if(vsym->ident == iVARIABLE && vsym->vclass == 1 && vsym->codestart >= sym->codestart && vsym->codeend <= sym->codeend)
+							if(vsym->ident == iVARIABLE)
 							{
 								cell addr = vsym->address - 2 * sizeof(cell);
-								if(addr > 0)
-								{
-									auto arg = reinterpret_cast<cell*>(reinterpret_cast<unsigned char*>(stk) + addr);
-									cell val = *arg;
-									*arg = *reinterpret_cast<cell*>(data + val);
-								}
+								auto arg = reinterpret_cast<cell*>(reinterpret_cast<unsigned char*>(stk) + addr);
+								cell val = *arg;
+								*arg = *reinterpret_cast<cell*>(data + val);
 							}
 						}
 
@@ -691,6 +727,25 @@ int AMXAPI amx_ExecContext(AMX *amx, cell *retval, int index, bool restore, amx:
 
 		if(restore_debug)
 		{
+			if(parallel_debug)
+			{
+				// the hooks under the one of the section may have been changed
+				amx::object owner;
+				auto &ctx = amx::get_context(amx, owner);
+				if(ctx.has_extra<parallel_context>())
+				{
+					old_debug = ctx.get_extra<parallel_context>().old_debug;
+				}
+			}else if(parent_debug)
+			{
+				// hooks installed during the call are kept under the one of the section
+				amx::object owner;
+				auto &ctx = amx::get_parent_context(amx, owner);
+				if(ctx.has_extra<parallel_context>())
+				{
+					ctx.get_extra<parallel_context>().old_debug = amx->debug;
+				}
+			}
 			amx->debug = old_debug;
 		}
 
@@ -7,6 +7,9 @@
 extern int maxRecursionLevel;
 
 int AMXAPI amx_ExecContext(AMX *amx, cell *retval, int index, bool restore, amx::reset *reset, bool forked = false);
+// the debug hook of the program; while a parallel section runs, the one called by the hook of the section
+AMX_DEBUG amx_get_debug_hook(AMX *amx);
+void amx_set_debug_hook(AMX *amx, AMX_DEBUG hook);
 
 // Holds the original code of the program (i.e. before relocation)
 struct amx_code_info : public amx::extra
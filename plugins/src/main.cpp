@@ -12,12 +12,17 @@
 #include "modules/tags.h"
 #include "modules/debug.h"
 #include "modules/expressions.h"
+#include "modules/indexes.h"
+#include "modules/memory.h"
+#include "modules/snapshots.h"
 
 #include "sdk/amx/amx.h"
 #include "sdk/plugincommon.h"
 
 #include <list>
 #include <limits>
+#include <chrono>
+#include <algorithm>
 
 logprintf_t logprintf;
 extern void *pAMXFunctions;
@@ -60,6 +65,9 @@ PLUGIN_EXPORT void PLUGIN_CALL Unload() noexcept
 	map_pool.clear();
 	linked_list_pool.clear();
 	pool_pool.clear();
+	bitset_pool.clear();
+	snapshot_pool.clear();
+	index_pool.clear();
 	expression_pool.clear();
 	iter_pool.clear();
 	tasks::clear();
@@ -96,6 +104,11 @@ void pp_tick()
 {
 	tasks::tick();
 	Threads::SyncThreads();
+	gc_step();
+	if(memory::tracking)
+	{
+		memory::update();
+	}
 }
 
 PLUGIN_EXPORT void PLUGIN_CALL ProcessTick() noexcept
@@ -106,19 +119,104 @@ PLUGIN_EXPORT void PLUGIN_CALL ProcessTick() noexcept
 
 std::list<void(*)()> gc_list;
 
-void gc_collect()
+bool gc_incremental = false;
+size_t gc_sync_limit = 1024;
+size_t gc_batch_size = 4096;
+cell gc_time_budget = 0;
+gc_pause_stats gc_stats;
+
+typedef std::chrono::steady_clock gc_clock;
+
+void gc_record_pause(gc_clock::time_point start)
+{
+	auto pause = std::chrono::duration_cast<std::chrono::microseconds>(gc_clock::now() - start).count();
+	gc_stats.last = pause;
+	if(pause > gc_stats.max)
+	{
+		gc_stats.max = pause;
+	}
+	gc_stats.total += pause;
+	gc_stats.count++;
+}
+
+template <class Pool>
+void gc_collect_pool(Pool &pool, bool incremental)
 {
-	variants::pool.clear_tmp();
-	handle_pool.clear_tmp();
-	expression_pool.clear_tmp();
-	iter_pool.clear_tmp();
-	strings::pool.clear_tmp();
+	if(incremental && pool.local_size() > gc_sync_limit)
+	{
+		pool.clear_tmp_deferred();
+	}else{
+		pool.clear_tmp();
+	}
+}
+
+void gc_collect_local(bool incremental)
+{
+	gc_collect_pool(variants::pool, incremental);
+	gc_collect_pool(handle_pool, incremental);
+	gc_collect_pool(expression_pool, incremental);
+	gc_collect_pool(iter_pool, incremental);
+	gc_collect_pool(strings::pool, incremental);
 	for(const auto &it : gc_list)
 	{
 		it();
 	}
 }
 
+void gc_collect()
+{
+	auto start = gc_clock::now();
+	gc_collect_local(gc_incremental);
+	gc_record_pause(start);
+}
+
+template <class Pool>
+bool gc_step_pool(Pool &pool, size_t &budget, gc_clock::time_point start)
+{
+	// check the clock every few objects only
+	constexpr size_t chunk = 64;
+	while(budget > 0 && pool.garbage_size() > 0)
+	{
+		budget -= pool.collect_garbage(std::min(budget, chunk));
+		if(gc_time_budget > 0 && gc_clock::now() - start >= std::chrono::microseconds(gc_time_budget))
+		{
+			return false;
+		}
+	}
+	return budget > 0;
+}
+
+void gc_step()
+{
+	if(gc_pending() == 0) return;
+	auto start = gc_clock::now();
+	size_t budget = gc_batch_size > 0 ? gc_batch_size : std::numeric_limits<size_t>::max();
+	gc_step_pool(variants::pool, budget, start) &&
+	gc_step_pool(handle_pool, budget, start) &&
+	gc_step_pool(expression_pool, budget, start) &&
+	gc_step_pool(iter_pool, budget, start) &&
+	gc_step_pool(strings::pool, budget, start);
+	gc_record_pause(start);
+}
+
+void gc_collect_full()
+{
+	auto start = gc_clock::now();
+	gc_collect_local(false);
+	size_t count = std::numeric_limits<size_t>::max();
+	variants::pool.collect_garbage(count);
+	handle_pool.collect_garbage(count);
+	expression_pool.collect_garbage(count);
+	iter_pool.collect_garbage(count);
+	strings::pool.collect_garbage(count);
+	gc_record_pause(start);
+}
+
+size_t gc_pending()
+{
+	return variants::pool.garbage_size() + handle_pool.garbage_size() + expression_pool.garbage_size() + iter_pool.garbage_size() + strings::pool.garbage_size();
+}
+
 void *gc_register(void(*func)())
 {
 	gc_list.push_back(func);
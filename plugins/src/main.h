@@ -46,7 +46,24 @@ void logdebug(const char *format, Args&&... args)
 
 void pp_tick();
 
+struct gc_pause_stats
+{
+	long long last = 0;
+	long long max = 0;
+	long long total = 0;
+	size_t count = 0;
+};
+
+extern bool gc_incremental;
+extern size_t gc_sync_limit;
+extern size_t gc_batch_size;
+extern cell gc_time_budget;
+extern gc_pause_stats gc_stats;
+
 void gc_collect();
+void gc_collect_full();
+void gc_step();
+size_t gc_pending();
 void *gc_register(void(*func)());
 void gc_unregister(void *id);
 
@@ -1,5 +1,7 @@
 #include "amxhook.h"
 #include "amxinfo.h"
+#include "native_stats.h"
+#include "tracing.h"
 #include "main.h"
 #include "utils/func_pool.h"
 #include "objects/stored_param.h"
@@ -36,6 +38,7 @@ public:
 	hook_handler(AMX *amx, const char *func_format, const char *function, const char *format, const cell *args, size_t numargs);
 	virtual bool invoke(class hooked_func &parent, AMX *amx, cell *params, cell &result);
 	bool valid() const;
+	const std::string &get_handler() const { return handler; }
 };
 
 class filter_handler : public hook_handler
@@ -52,6 +55,7 @@ class hooked_func
 	std::string name;
 	AMX_NATIVE native;
 	size_t index;
+	size_t stats_index;
 	subhook_t hook = nullptr;
 	std::vector<std::unique_ptr<hook_handler>> handlers;
 	size_t handler_level = -1;
@@ -163,6 +167,7 @@ bool amxhook::remove_hook(cell id)
 
 	size_t index = it->second;
 	hook_handlers.erase(it);
+	tracing::remove(id);
 	hooked_func &hook = *native_hooks[index];
 	if(!hook.remove_handler(id)) return false;
 
@@ -176,7 +181,7 @@ bool amxhook::remove_hook(cell id)
 	return true;
 }
 
-hooked_func::hooked_func(std::string name, AMX_NATIVE native, AMX_NATIVE hook, size_t index) : name(name), native(native), index(index)
+hooked_func::hooked_func(std::string name, AMX_NATIVE native, AMX_NATIVE hook, size_t index) : name(name), native(native), index(index), stats_index(native_stats::add_hooked(name))
 {
 	this->hook = subhook_new(reinterpret_cast<void*>(native), reinterpret_cast<void*>(hook), {});
 	subhook_install(this->hook);
@@ -219,6 +224,7 @@ bool hooked_func::remove_handler(cell id)
 
 cell hooked_func::invoke(AMX *amx, cell *params)
 {
+	native_stats::scope stats(stats_index);
 	try{
 		cell result = std::numeric_limits<cell>::min();
 
@@ -237,7 +243,21 @@ cell hooked_func::invoke(AMX *amx, cell *params)
 				ok = true;
 			}else{
 				handler_level--;
-				ok = handlers[handler_level]->invoke(*this, amx, params, result);
+				auto &handler = handlers[handler_level];
+				cell id = reinterpret_cast<cell>(handler.get());
+				tracing::scope trace;
+				if(tracing::active() && handler->valid())
+				{
+					auto &stats = tracing::get(id);
+					if(!stats.kind)
+					{
+						stats.kind = "hook";
+						stats.handler = handler->get_handler();
+						stats.target = name;
+					}
+					trace.begin(id, stats);
+				}
+				ok = handler->invoke(*this, amx, params, result);
 			}
 		}
 
@@ -249,6 +269,7 @@ cell hooked_func::invoke(AMX *amx, cell *params)
 			{
 				if(!(*it)->valid())
 				{
+					tracing::remove(reinterpret_cast<cell>(it->get()));
 					it = handlers.erase(it);
 				}else{
 					++it;
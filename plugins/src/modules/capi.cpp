@@ -7,6 +7,9 @@
 #include "strings.h"
 #include "tasks.h"
 #include "serialize.h"
+#include "native_stats.h"
+#include "memory.h"
+#include "objects/reset.h"
 #include "errors.h"
 #include "natives.h"
 
@@ -145,6 +148,60 @@ static func_ptr main_functions[] = {
 	{
 		return deserialize_value(*value, static_cast<tag_ptr>(tag), binary_reader, binary_reader_cookie, object_reader, object_reader_cookie);
 	},
+	+[]/*native_stats_enable*/(cell enable) -> void
+	{
+		native_stats::enabled = enable;
+	},
+	+[]/*native_stats_reset*/() -> void
+	{
+		native_stats::reset();
+	},
+	+[]/*native_stats_count*/() -> cell
+	{
+		return static_cast<cell>(native_stats::get().size());
+	},
+	+[]/*native_stats_get*/(cell index, const char **name, long long *calls, long long *total, long long *max, long long *histogram, cell histogram_size) -> cell
+	{
+		const auto &list = native_stats::get();
+		if(index < 0 || static_cast<size_t>(index) >= list.size())
+		{
+			return -1;
+		}
+		const auto &stats = list[index];
+		if(name) *name = stats.name.c_str();
+		if(calls) *calls = stats.calls;
+		if(total) *total = stats.total;
+		if(max) *max = stats.max;
+		cell count = 0;
+		if(histogram)
+		{
+			for(; count < histogram_size && static_cast<size_t>(count) < native_stats::histogram_size; count++)
+			{
+				histogram[count] = stats.histogram[count];
+			}
+		}
+		return count;
+	},
+	+[]/*memory_usage*/(cell pool, cell *objects, cell *bytes, cell *peak) -> cell
+	{
+		if(pool < 0 || pool >= static_cast<cell>(memory::pool_type::count))
+		{
+			return 0;
+		}
+		const auto &usage = memory::get(static_cast<memory::pool_type>(pool));
+		if(objects) *objects = static_cast<cell>(usage.objects);
+		if(bytes) *bytes = static_cast<cell>(usage.bytes);
+		if(peak) *peak = static_cast<cell>(usage.peak);
+		return 1;
+	},
+	+[]/*snapshot_memory*/(AMX *amx, cell *live, cell *peak, cell *shared, cell *cached) -> void
+	{
+		auto usage = amx::snapshot_memory(amx);
+		if(live) *live = static_cast<cell>(usage.live);
+		if(peak) *peak = static_cast<cell>(usage.peak);
+		if(shared) *shared = static_cast<cell>(usage.shared);
+		if(cached) *cached = static_cast<cell>(usage.cached);
+	},
 	nullptr
 };
 
@@ -655,6 +712,18 @@ static func_ptr task_functions[] = {
 		}
 		return nullptr;
 	},
+	+[]/*task_post_completed*/(cell id, cell value, const void *tag) -> void
+	{
+		tasks::post_completed(id, value, static_cast<tag_ptr>(tag));
+	},
+	+[]/*task_post_completed_arr*/(cell id, const cell *arr, cell size, const void *tag) -> void
+	{
+		tasks::post_completed(id, arr, size, static_cast<tag_ptr>(tag));
+	},
+	+[]/*task_post_faulted*/(cell id, cell error) -> void
+	{
+		tasks::post_faulted(id, error);
+	},
 	nullptr
 };
 
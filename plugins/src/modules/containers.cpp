@@ -4,51 +4,249 @@ aux::shared_id_set_pool<list_t> list_pool;
 aux::shared_id_set_pool<map_t> map_pool;
 aux::shared_id_set_pool<linked_list_t> linked_list_pool;
 aux::shared_id_set_pool<pool_t> pool_pool;
+aux::shared_id_set_pool<bitset_t> bitset_pool;
 object_pool<dyn_iterator> iter_pool;
 object_pool<handle_t> handle_pool;
 
+element_matcher::element_matcher(const dyn_object &find) : find(find), plain(false), value(0)
+{
+	if(find.is_cell())
+	{
+		switch(find.get_tag()->uid)
+		{
+			case tags::tag_cell:
+			case tags::tag_signed:
+			case tags::tag_unsigned:
+			case tags::tag_address:
+				plain = true;
+				value = *find.begin();
+				break;
+		}
+	}
+}
+
+// whether no user-defined operations run when values of the tag are created or destroyed
+static bool plain_lifetime(tag_ptr tag)
+{
+	for(; tag; tag = tag->base)
+	{
+		if(tag->get_control())
+		{
+			return false;
+		}
+	}
+	return true;
+}
+
+bool list_t::storable(const dyn_object &value)
+{
+	if(!typed)
+	{
+		if(!data.empty() || data.capacity() > 0)
+		{
+			return false;
+		}
+		// nothing can refer to the storage
+		typed = true;
+	}
+	if(!value.is_cell())
+	{
+		return false;
+	}
+	if(value.get_tag() == cell_tag)
+	{
+		return true;
+	}
+	if(cells.empty() && plain_lifetime(value.get_tag()))
+	{
+		cell_tag = value.get_tag();
+		return true;
+	}
+	return false;
+}
+
+void list_t::upgrade()
+{
+	if(typed)
+	{
+		typed = false;
+		data.reserve(cells.capacity());
+		for(cell value : cells)
+		{
+			data.emplace_back(value, cell_tag);
+		}
+		std::vector<cell>().swap(cells);
+	}
+}
+
+void list_t::clear()
+{
+	if(size() > 0 || !typed)
+	{
+		++revision;
+		++modification;
+	}
+	cells.clear();
+	if(!typed)
+	{
+		std::vector<dyn_object>().swap(data);
+		typed = true;
+	}
+	cell_tag = nullptr;
+}
+
+void list_t::swap(list_t &other)
+{
+	using std::swap;
+	swap(data, other.data);
+	swap(cells, other.cells);
+	swap(cell_tag, other.cell_tag);
+	swap(typed, other.typed);
+	++revision;
+	++modification;
+	++other.revision;
+	++other.modification;
+}
+
 void list_t::push_back(dyn_object &&value)
 {
+	++modification;
+	if(storable(value))
+	{
+		bool invalidate = cells.size() == cells.capacity();
+		cells.push_back(*value.begin());
+		if(invalidate)
+		{
+			++revision;
+		}
+		changes.record(modification, change_type::insert, cells.size() - 1);
+		return;
+	}
+	upgrade();
 	bool invalidate = data.size() == data.capacity();
 	data.push_back(std::move(value));
 	if(invalidate)
 	{
 		++revision;
 	}
+	changes.record(modification, change_type::insert, data.size() - 1);
 }
 
 void list_t::push_back(const dyn_object &value)
 {
+	++modification;
+	if(storable(value))
+	{
+		bool invalidate = cells.size() == cells.capacity();
+		cells.push_back(*value.begin());
+		if(invalidate)
+		{
+			++revision;
+		}
+		changes.record(modification, change_type::insert, cells.size() - 1);
+		return;
+	}
+	upgrade();
 	bool invalidate = data.size() == data.capacity();
 	data.push_back(value);
 	if(invalidate)
 	{
 		++revision;
 	}
+	changes.record(modification, change_type::insert, data.size() - 1);
 }
 
 auto list_t::insert(iterator position, dyn_object &&value) -> iterator
 {
+	++modification;
 	bool invalidate = position == data.end() ? data.size() == data.capacity() : true;
 	auto it = data.insert(position, std::move(value));
 	if(invalidate)
 	{
 		++revision;
 	}
+	changes.record(modification, change_type::insert, it - data.begin());
 	return it;
 }
 
 auto list_t::insert(iterator position, const dyn_object &value) -> iterator
 {
+	++modification;
 	bool invalidate = position == data.end() ? data.size() == data.capacity() : true;
 	auto it = data.insert(position, value);
 	if(invalidate)
 	{
 		++revision;
 	}
+	changes.record(modification, change_type::insert, it - data.begin());
+	return it;
+}
+
+void list_t::insert_at(size_t index, dyn_object &&value)
+{
+	if(storable(value))
+	{
+		++modification;
+		bool invalidate = index == cells.size() ? cells.size() == cells.capacity() : true;
+		cells.insert(cells.begin() + index, *value.begin());
+		if(invalidate)
+		{
+			++revision;
+		}
+		changes.record(modification, change_type::insert, index);
+		return;
+	}
+	upgrade();
+	insert(data.begin() + index, std::move(value));
+}
+
+void list_t::set(size_t index, dyn_object &&value)
+{
+	++modification;
+	if(storable(value))
+	{
+		cells[index] = *value.begin();
+	}else{
+		upgrade();
+		data[index] = std::move(value);
+	}
+	changes.record(modification, change_type::set, index);
+}
+
+auto list_t::erase(iterator position) -> iterator
+{
+	size_t index = position - data.begin();
+	auto it = data.erase(position);
+	++revision;
+	++modification;
+	changes.record(modification, change_type::erase, index);
+	return it;
+}
+
+auto list_t::erase(iterator first, iterator last) -> iterator
+{
+	size_t index = first - data.begin();
+	size_t count = last - first;
+	auto it = data.erase(first, last);
+	++revision;
+	++modification;
+	changes.record(modification, change_type::erase, index, count);
 	return it;
 }
 
+void list_t::erase_at(size_t first, size_t last)
+{
+	if(typed)
+	{
+		cells.erase(cells.begin() + first, cells.begin() + last);
+	}else{
+		data.erase(data.begin() + first, data.begin() + last);
+	}
+	++revision;
+	++modification;
+	changes.record(modification, change_type::erase, first, last - first);
+}
+
 bool list_t::insert_dyn(iterator position, const std::type_info &type, void *value, iterator &result)
 {
 	if(type == typeid(dyn_object))
@@ -69,47 +267,91 @@ bool list_t::insert_dyn(iterator position, const std::type_info &type, const voi
 	return false;
 }
 
+void list_t::resized(size_t old_size)
+{
+	size_t new_size = size();
+	if(new_size < old_size)
+	{
+		changes.record(modification, change_type::erase, new_size, old_size - new_size);
+	}else{
+		changes.record(modification, change_type::insert, old_size, new_size - old_size);
+	}
+}
+
 void list_t::resize(size_t count)
 {
+	++modification;
+	size_t old_size = size();
+	if(typed && count <= cells.size())
+	{
+		if(count < cells.size())
+		{
+			cells.resize(count);
+			++revision;
+		}
+		resized(old_size);
+		return;
+	}
+	upgrade();
 	bool invalidate = count < data.size() || count > data.capacity();
 	data.resize(count);
 	if(invalidate)
 	{
 		++revision;
 	}
+	resized(old_size);
 }
 
 void list_t::resize(size_t count, const dyn_object &value)
 {
+	++modification;
+	size_t old_size = size();
+	if(storable(value))
+	{
+		bool invalidate = count < cells.size() || count > cells.capacity();
+		cells.resize(count, *value.begin());
+		if(invalidate)
+		{
+			++revision;
+		}
+		resized(old_size);
+		return;
+	}
+	upgrade();
 	bool invalidate = count < data.size() || count > data.capacity();
 	data.resize(count, value);
 	if(invalidate)
 	{
 		++revision;
 	}
+	resized(old_size);
 }
 
 
 
 dyn_object &map_t::operator[](const dyn_object &key)
 {
+	++modification;
 	bool invalidate = data.size() == data.capacity();
 	auto pair = data.emplace(std::piecewise_construct, std::forward_as_tuple(key), std::forward_as_tuple());
 	if(pair.second && invalidate)
 	{
 		++revision;
 	}
+	changes.record(modification, pair.second ? change_type::insert : change_type::set, &*pair.first);
 	return pair.first->second;
 }
 
 dyn_object &map_t::operator[](dyn_object &&key)
 {
+	++modification;
 	bool invalidate = data.size() == data.capacity();
 	auto pair = data.emplace(std::piecewise_construct, std::forward_as_tuple(std::move(key)), std::forward_as_tuple());
 	if(pair.second && invalidate)
 	{
 		++revision;
 	}
+	changes.record(modification, pair.second ? change_type::insert : change_type::set, &*pair.first);
 	return pair.first->second;
 }
 
@@ -117,9 +359,14 @@ auto map_t::insert(const dyn_object &key, dyn_object const &value) -> std::pair<
 {
 	bool invalidate = data.size() == data.capacity();
 	auto pair = data.emplace(key, value);
-	if(pair.second && invalidate)
+	if(pair.second)
 	{
-		++revision;
+		++modification;
+		if(invalidate)
+		{
+			++revision;
+		}
+		changes.record(modification, change_type::insert, &*pair.first);
 	}
 	return pair;
 }
@@ -128,9 +375,14 @@ auto map_t::insert(const dyn_object &key, dyn_object &&value) -> std::pair<itera
 {
 	bool invalidate = data.size() == data.capacity();
 	auto pair = data.emplace(key, std::move(value));
-	if(pair.second && invalidate)
+	if(pair.second)
 	{
-		++revision;
+		++modification;
+		if(invalidate)
+		{
+			++revision;
+		}
+		changes.record(modification, change_type::insert, &*pair.first);
 	}
 	return pair;
 }
@@ -139,9 +391,14 @@ auto map_t::insert(dyn_object &&key, const dyn_object &value) -> std::pair<itera
 {
 	bool invalidate = data.size() == data.capacity();
 	auto pair = data.emplace(std::move(key), value);
-	if(pair.second && invalidate)
+	if(pair.second)
 	{
-		++revision;
+		++modification;
+		if(invalidate)
+		{
+			++revision;
+		}
+		changes.record(modification, change_type::insert, &*pair.first);
 	}
 	return pair;
 }
@@ -150,9 +407,14 @@ auto map_t::insert(dyn_object &&key, dyn_object &&value) -> std::pair<iterator,
 {
 	bool invalidate = data.size() == data.capacity();
 	auto pair = data.emplace(std::move(key), std::move(value));
-	if(pair.second && invalidate)
+	if(pair.second)
 	{
-		++revision;
+		++modification;
+		if(invalidate)
+		{
+			++revision;
+		}
+		changes.record(modification, change_type::insert, &*pair.first);
 	}
 	return pair;
 }
@@ -164,14 +426,21 @@ auto map_t::find(const dyn_object &key) -> iterator
 
 size_t map_t::erase(const dyn_object &key)
 {
-	size_t size = data.erase(key);
-	++revision;
-	return size;
+	auto it = data.find(key);
+	if(it == data.end())
+	{
+		return 0;
+	}
+	erase(it);
+	return 1;
 }
 
 auto map_t::erase(iterator position) -> iterator
 {
-	return collection_base<aux::hybrid_map<dyn_object, dyn_object>>::erase(position);
+	const value_type *element = &*position;
+	auto it = collection_base<aux::hybrid_map<dyn_object, dyn_object>>::erase(position);
+	changes.record(modification, change_type::erase, element);
+	return it;
 }
 
 bool map_t::insert_dyn(iterator position, const std::type_info &type, void *value, iterator &result)
@@ -190,31 +459,31 @@ dyn_object &linked_list_t::operator[](size_t index)
 {
 	auto it = data.begin();
 	std::advance(it, index);
-	return **it;
+	return *it;
 }
 
 void linked_list_t::push_back(dyn_object &&value)
 {
-	data.push_back(std::make_shared<dyn_object>(std::move(value)));
+	data.push_back(std::move(value));
 	++revision;
 }
 
 void linked_list_t::push_back(const dyn_object &value)
 {
-	data.push_back(std::make_shared<dyn_object>(value));
+	data.push_back(value);
 	++revision;
 }
 
 auto linked_list_t::insert(iterator position, dyn_object &&value) -> iterator
 {
-	auto it = data.insert(position, std::make_shared<dyn_object>(std::move(value)));
+	auto it = data.insert(position, std::move(value));
 	++revision;
 	return it;
 }
 
 auto linked_list_t::insert(iterator position, const dyn_object &value) -> iterator
 {
-	auto it = data.insert(position, std::make_shared<dyn_object>(value));
+	auto it = data.insert(position, value);
 	++revision;
 	return it;
 }
@@ -274,6 +543,11 @@ bool dyn_iterator::expired() const
 	return true;
 }
 
+void dyn_iterator::touch()
+{
+
+}
+
 bool dyn_iterator::valid() const
 {
 	return false;
@@ -385,7 +659,7 @@ bool list_iterator_t::extract_dyn(const std::type_info &type, void *value) const
 			return true;
 		}else if(type == typeid(std::shared_ptr<const std::pair<const dyn_object, dyn_object>>))
 		{
-			if(auto source = lock_same())
+			if(auto source = lock_same(true))
 			{
 				if(_position != source->end())
 				{
@@ -400,24 +674,25 @@ bool list_iterator_t::extract_dyn(const std::type_info &type, void *value) const
 }
 
 
-std::shared_ptr<linked_list_t> linked_list_iterator_t::lock_same()
+aux::local_lock<linked_list_t> linked_list_iterator_t::lock_same(bool strong)
 {
-	if(auto source = _source.lock())
+	if(auto source = lock_source(strong))
 	{
-		if(_current.expired())
+		if(!current_alive())
 		{
 			_position = source->end();
+			_generation = 0;
 		}
 		return source;
 	}
 	return nullptr;
 }
 
-std::shared_ptr<linked_list_t> linked_list_iterator_t::lock_same() const
+aux::local_lock<linked_list_t> linked_list_iterator_t::lock_same(bool strong) const
 {
-	if(auto source = _source.lock())
+	if(auto source = lock_source(strong))
 	{
-		if(!_current.expired())
+		if(current_alive())
 		{
 			return source;
 		}
@@ -462,10 +737,10 @@ bool linked_list_iterator_t::move_next()
 			++_position;
 			if(_position != source->end())
 			{
-				_current = *_position;
+				set_current(source);
 				return true;
 			}else{
-				_current.reset();
+				_generation = 0;
 			}
 		}
 	}
@@ -480,14 +755,14 @@ bool linked_list_iterator_t::move_previous()
 		if(_position == source->begin())
 		{
 			_position = source->end();
-			_current.reset();
+			_generation = 0;
 			return false;
 		}else if(_position == source->end())
 		{
 			return false;
 		}
 		--_position;
-		_current = *_position;
+		set_current(source);
 		return true;
 	}
 	return false;
@@ -495,16 +770,16 @@ bool linked_list_iterator_t::move_previous()
 
 bool linked_list_iterator_t::set_to_first()
 {
-	if(auto source = _source.lock())
+	if(auto source = lock_source())
 	{
 		_position = source->begin();
 		_before = false;
 		if(_position != source->end())
 		{
-			_current = *_position;
+			set_current(source);
 			return true;
 		}else{
-			_current.reset();
+			_generation = 0;
 		}
 	}
 	return false;
@@ -512,17 +787,17 @@ bool linked_list_iterator_t::set_to_first()
 
 bool linked_list_iterator_t::set_to_last()
 {
-	if(auto source = _source.lock())
+	if(auto source = lock_source())
 	{
 		_position = source->end();
 		_before = false;
 		if(_position != source->begin())
 		{
 			--_position;
-			_current = *_position;
+			set_current(source);
 			return true;
 		}else{
-			_current.reset();
+			_generation = 0;
 		}
 	}
 	return false;
@@ -530,10 +805,10 @@ bool linked_list_iterator_t::set_to_last()
 
 bool linked_list_iterator_t::reset()
 {
-	if(auto source = _source.lock())
+	if(auto source = lock_source())
 	{
 		_position = source->end();
-		_current.reset();
+		_generation = 0;
 		_before = false;
 		return true;
 	}
@@ -542,9 +817,9 @@ bool linked_list_iterator_t::reset()
 
 size_t linked_list_iterator_t::get_hash() const
 {
-	if(auto source = _source.lock())
+	if(auto source = lock_source())
 	{
-		if(!_current.expired())
+		if(current_alive())
 		{
 			return std::hash<decltype(&*_position)>()(&*_position);
 		}else{
@@ -556,20 +831,20 @@ size_t linked_list_iterator_t::get_hash() const
 
 bool linked_list_iterator_t::erase(bool stay)
 {
-	if(auto source = lock_same())
+	if(auto source = lock_same(true))
 	{
 		if(_position != source->end() && !_before)
 		{
 			_position = source->erase(_position);
 			if(_position != source->end())
 			{
-				_current = *_position;
+				set_current(source);
 				if(stay)
 				{
 					_before = true;
 				}
 			}else{
-				_current.reset();
+				_generation = 0;
 			}
 		}
 		return true;
@@ -615,7 +890,7 @@ bool linked_list_iterator_t::operator==(const dyn_iterator &obj) const
 	auto other = dynamic_cast<const linked_list_iterator_t*>(&obj);
 	if(other != nullptr)
 	{
-		return !_source.owner_before(other->_source) && !other->_source.owner_before(_source) && _position == other->_position && !_current.owner_before(other->_current) && !other->_current.owner_before(_current) && _before == other->_before;
+		return !_source.owner_before(other->_source) && !other->_source.owner_before(_source) && _position == other->_position && _generation == other->_generation && _before == other->_before;
 	}
 	return false;
 }
@@ -626,15 +901,11 @@ bool linked_list_iterator_t::extract_dyn(const std::type_info &type, void *value
 	{
 		if(type == typeid(dyn_object*))
 		{
-			*reinterpret_cast<dyn_object**>(value) = &**_position;
+			*reinterpret_cast<dyn_object**>(value) = &*_position;
 			return true;
 		}else if(type == typeid(const dyn_object*))
 		{
-			*reinterpret_cast<const dyn_object**>(value) = &**_position;
-			return true;
-		}else if(type == typeid(value_type*))
-		{
-			*reinterpret_cast<value_type**>(value) = &*_position;
+			*reinterpret_cast<const dyn_object**>(value) = &*_position;
 			return true;
 		}
 	}
@@ -643,11 +914,11 @@ bool linked_list_iterator_t::extract_dyn(const std::type_info &type, void *value
 
 bool linked_list_iterator_t::insert_dyn(const std::type_info &type, void *value)
 {
-	if(auto source = lock_same())
+	if(auto source = lock_same(true))
 	{
 		if(source->insert_dyn(_position, type, value, _position))
 		{
-			_current = *_position;
+			set_current(source);
 			_before = false;
 			return true;
 		}
@@ -657,11 +928,11 @@ bool linked_list_iterator_t::insert_dyn(const std::type_info &type, void *value)
 
 bool linked_list_iterator_t::insert_dyn(const std::type_info &type, const void *value)
 {
-	if(auto source = lock_same())
+	if(auto source = lock_same(true))
 	{
 		if(source->insert_dyn(_position, type, value, _position))
 		{
-			_current = *_position;
+			set_current(source);
 			_before = false;
 			return true;
 		}
@@ -683,7 +954,7 @@ bool pool_iterator_t::extract_dyn(const std::type_info &type, void *value) const
 			return true;
 		}else if(type == typeid(std::shared_ptr<const std::pair<const dyn_object, dyn_object>>))
 		{
-			if(auto source = lock_same())
+			if(auto source = lock_same(true))
 			{
 				if(_position != source->end())
 				{
@@ -696,3 +967,199 @@ bool pool_iterator_t::extract_dyn(const std::type_info &type, void *value) const
 	}
 	return false;
 }
+
+bool bitset_iterator_t::expired() const
+{
+	return _source.expired();
+}
+
+bool bitset_iterator_t::valid() const
+{
+	if(auto source = lock_source())
+	{
+		return _state == state::at_element && source->contains(_current);
+	}
+	return false;
+}
+
+bool bitset_iterator_t::empty() const
+{
+	if(auto source = lock_source())
+	{
+		return source->empty();
+	}
+	return true;
+}
+
+bool bitset_iterator_t::move_next()
+{
+	if(auto source = lock_source())
+	{
+		if(_state == state::before_element)
+		{
+			_state = state::at_element;
+			if(source->contains(_current))
+			{
+				return true;
+			}
+		}
+		if(_state == state::at_element)
+		{
+			if(source->next(_current, _current))
+			{
+				return true;
+			}
+			_state = state::outside;
+		}
+	}
+	return false;
+}
+
+bool bitset_iterator_t::move_previous()
+{
+	if(auto source = lock_source())
+	{
+		if(_state != state::outside)
+		{
+			if(source->prev(_current, _current))
+			{
+				_state = state::at_element;
+				return true;
+			}
+			_state = state::outside;
+		}
+	}
+	return false;
+}
+
+bool bitset_iterator_t::set_to_first()
+{
+	if(auto source = lock_source())
+	{
+		if(source->first(_current))
+		{
+			_state = state::at_element;
+			return true;
+		}
+		_state = state::outside;
+	}
+	return false;
+}
+
+bool bitset_iterator_t::set_to_last()
+{
+	if(auto source = lock_source())
+	{
+		if(source->last(_current))
+		{
+			_state = state::at_element;
+			return true;
+		}
+		_state = state::outside;
+	}
+	return false;
+}
+
+bool bitset_iterator_t::reset()
+{
+	if(auto source = lock_source())
+	{
+		_state = state::outside;
+		return true;
+	}
+	return false;
+}
+
+size_t bitset_iterator_t::get_hash() const
+{
+	if(auto source = lock_source())
+	{
+		if(_state == state::at_element)
+		{
+			return std::hash<cell>()(_current);
+		}
+		return std::hash<bitset_t*>()(source.get());
+	}
+	return 0;
+}
+
+bool bitset_iterator_t::erase(bool stay)
+{
+	if(auto source = lock_source())
+	{
+		if(_state == state::at_element)
+		{
+			cell value = _current;
+			if(source->next(value, _current))
+			{
+				if(stay)
+				{
+					_state = state::before_element;
+				}
+			}else{
+				_state = state::outside;
+			}
+			source->erase(value);
+		}
+		return true;
+	}
+	return false;
+}
+
+bool bitset_iterator_t::can_reset() const
+{
+	return !_source.expired();
+}
+
+bool bitset_iterator_t::can_erase() const
+{
+	return valid();
+}
+
+bool bitset_iterator_t::can_insert() const
+{
+	return false;
+}
+
+std::unique_ptr<dyn_iterator> bitset_iterator_t::clone() const
+{
+	return std::make_unique<bitset_iterator_t>(*this);
+}
+
+std::shared_ptr<dyn_iterator> bitset_iterator_t::clone_shared() const
+{
+	return std::make_shared<bitset_iterator_t>(*this);
+}
+
+bool bitset_iterator_t::operator==(const dyn_iterator &obj) const
+{
+	auto other = dynamic_cast<const bitset_iterator_t*>(&obj);
+	if(other != nullptr)
+	{
+		return !_source.owner_before(other->_source) && !other->_source.owner_before(_source) && _state == other->_state && (_state == state::outside || _current == other->_current);
+	}
+	return false;
+}
+
+bool bitset_iterator_t::extract_dyn(const std::type_info &type, void *value) const
+{
+	if(valid())
+	{
+		if(type == typeid(std::shared_ptr<const dyn_object>))
+		{
+			*reinterpret_cast<std::shared_ptr<const dyn_object>*>(value) = std::make_shared<dyn_object>(_current, tags::find_tag(tags::tag_cell));
+			return true;
+		}
+	}
+	return false;
+}
+
+bool bitset_iterator_t::insert_dyn(const std::type_info &type, void *value)
+{
+	return false;
+}
+
+bool bitset_iterator_t::insert_dyn(const std::type_info &type, const void *value)
+{
+	return false;
+}
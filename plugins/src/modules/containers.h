@@ -6,6 +6,9 @@
 #include "utils/shared_id_set_pool.h"
 #include "utils/hybrid_map.h"
 #include "utils/hybrid_pool.h"
+#include "utils/node_list.h"
+#include "utils/bit_set.h"
+#include "utils/local_ptr.h"
 #include "fixes/linux.h"
 
 #include "sdk/amx/amx.h"
@@ -25,6 +28,7 @@ class collection_base
 protected:
 	Type data;
 	int revision = 0;
+	unsigned int modification = 0;
 
 	collection_base() = default;
 
@@ -72,6 +76,7 @@ public:
 		{
 			data.clear();
 			++revision;
+			++modification;
 		}
 	}
 
@@ -79,6 +84,7 @@ public:
 	{
 		auto it = data.erase(position);
 		++revision;
+		++modification;
 		return it;
 	}
 
@@ -86,6 +92,7 @@ public:
 	{
 		auto it = data.erase(first, last);
 		++revision;
+		++modification;
 		return it;
 	}
 
@@ -94,6 +101,7 @@ public:
 	{
 		data.insert(first, last);
 		++revision;
+		++modification;
 	}
 
 	int get_revision() const
@@ -101,16 +109,31 @@ public:
 		return revision;
 	}
 
+	// counts all changes, including those that keep iterators valid
+	unsigned int get_modification() const
+	{
+		return modification;
+	}
+
+	void touch()
+	{
+		++modification;
+	}
+
 	void swap(collection_base<Type> &other)
 	{
-		std::swap(data, other.data);
+		using std::swap;
+		swap(data, other.data);
 		++revision;
+		++modification;
 		++other.revision;
+		++other.modification;
 	}
 
 	Type &get_data()
 	{
 		++revision;
+		++modification;
 		return data;
 	}
 
@@ -120,38 +143,270 @@ public:
 	}
 };
 
+enum class change_type
+{
+	set,
+	insert,
+	erase
+};
+
+// Records the positions changed by each modification of a collection, once something
+// has asked for them. Only the recent changes are kept; modifications that do not record
+// their positions (like touch or get_data) leave a gap, after which nothing is known.
+template <class Position>
+class change_log
+{
+public:
+	struct change
+	{
+		unsigned int modification;
+		change_type type;
+		Position first;
+		size_t count;
+	};
+
+private:
+	static constexpr size_t max_changes = 256;
+
+	std::vector<change> changes;
+	bool enabled = false;
+
+public:
+	change_log() = default;
+
+	// the changes describe the collection they were made to, so they are not copied
+	change_log(const change_log<Position> &other)
+	{
+
+	}
+
+	change_log<Position> &operator=(const change_log<Position> &other)
+	{
+		changes.clear();
+		return *this;
+	}
+
+	void enable()
+	{
+		enabled = true;
+	}
+
+	void record(unsigned int modification, change_type type, Position first, size_t count = 1)
+	{
+		if(enabled)
+		{
+			if(changes.size() == max_changes)
+			{
+				changes.erase(changes.begin(), changes.begin() + max_changes / 2);
+			}
+			changes.push_back(change{modification, type, first, count});
+		}
+	}
+
+	// obtains the changes made after modification up to current, if all of them are known
+	bool since(unsigned int modification, unsigned int current, const change *&begin, const change *&end) const
+	{
+		end = changes.data() + changes.size();
+		begin = end;
+		while(current != modification)
+		{
+			if(begin == changes.data() || begin[-1].modification != current)
+			{
+				return false;
+			}
+			--begin;
+			--current;
+		}
+		return true;
+	}
+};
+
+// Matches elements equal to a value. If the value is a single cell of a tag that compares
+// cells by identity, elements of the same tag are compared directly instead of through tag operations.
+class element_matcher
+{
+	const dyn_object &find;
+	bool plain;
+	cell value;
+
+public:
+	explicit element_matcher(const dyn_object &find);
+
+	bool operator()(const dyn_object &obj) const
+	{
+		if(plain && obj.is_cell() && obj.get_tag() == find.get_tag())
+		{
+			return *obj.begin() == value;
+		}
+		return obj == find;
+	}
+
+	// matches a single cell of the given tag
+	bool operator()(cell obj, tag_ptr tag) const
+	{
+		if(plain && tag == find.get_tag())
+		{
+			return obj == value;
+		}
+		return dyn_object(obj, tag) == find;
+	}
+
+	// true if cells of the tag match only when equal to key
+	bool cell_key(tag_ptr tag, cell &key) const
+	{
+		if(plain && tag == find.get_tag())
+		{
+			key = value;
+			return true;
+		}
+		return false;
+	}
+};
+
+// A list whose elements are all single cells of one tag without user-defined lifetime operations
+// stores only the cells and the tag. The elements are moved to dyn_object storage on the first insert
+// of a different value, or when they are accessed as dyn_object (via iterators, operator[] or get_data).
+// Clearing the list returns it to the typed storage.
 class list_t : public collection_base<std::vector<dyn_object>>
 {
+	std::vector<cell> cells;
+	tag_ptr cell_tag = nullptr;
+	bool typed = true;
+	change_log<size_t> changes;
+
+	bool storable(const dyn_object &value);
+	void upgrade();
+	void resized(size_t old_size);
+
+	void upgrade() const
+	{
+		const_cast<list_t*>(this)->upgrade();
+	}
+
 public:
 	typedef typename std::vector<dyn_object>::reverse_iterator reverse_iterator;
+
+	iterator begin()
+	{
+		upgrade();
+		return data.begin();
+	}
+	iterator end()
+	{
+		upgrade();
+		return data.end();
+	}
+	const_iterator cbegin() const
+	{
+		upgrade();
+		return data.cbegin();
+	}
+	const_iterator cend() const
+	{
+		upgrade();
+		return data.cend();
+	}
 	reverse_iterator rbegin()
 	{
+		upgrade();
 		return data.rbegin();
 	}
 	reverse_iterator rend()
 	{
+		upgrade();
 		return data.rend();
 	}
 	dyn_object &operator[](size_t index)
 	{
+		upgrade();
 		return data[index];
 	}
 	const dyn_object &operator[](size_t index) const
 	{
+		upgrade();
 		return data[index];
 	}
+
+	size_t size() const
+	{
+		return typed ? cells.size() : data.size();
+	}
+
+	// whether the elements are stored as cells of get_cell_tag()
+	bool is_typed() const
+	{
+		return typed;
+	}
+
+	tag_ptr get_cell_tag() const
+	{
+		return cell_tag;
+	}
+
+	const std::vector<cell> &get_cells() const
+	{
+		return cells;
+	}
+
+	std::vector<cell> &get_cells()
+	{
+		++revision;
+		++modification;
+		return cells;
+	}
+
+	std::vector<dyn_object> &get_data()
+	{
+		upgrade();
+		return collection_base<std::vector<dyn_object>>::get_data();
+	}
+
+	const std::vector<dyn_object> &get_data() const
+	{
+		upgrade();
+		return data;
+	}
+
+	change_log<size_t> &get_changes()
+	{
+		return changes;
+	}
+
+	const change_log<size_t> &get_changes() const
+	{
+		return changes;
+	}
+
+	// marks the element at index as modified in place
+	void touch_at(size_t index)
+	{
+		++modification;
+		changes.record(modification, change_type::set, index);
+	}
+
+	void clear();
+	void swap(list_t &other);
 	void push_back(dyn_object &&value);
 	void push_back(const dyn_object &value);
 	iterator insert(iterator position, dyn_object &&value);
 	iterator insert(iterator position, const dyn_object &value);
+	void insert_at(size_t index, dyn_object &&value);
+	void set(size_t index, dyn_object &&value);
+	iterator erase(iterator position);
+	iterator erase(iterator first, iterator last);
+	void erase_at(size_t first, size_t last);
 	bool insert_dyn(iterator position, const std::type_info &type, void *value, iterator &result);
 	bool insert_dyn(iterator position, const std::type_info &type, const void *value, iterator &result);
 
 	template <class InputIterator>
 	void insert(iterator position, InputIterator first, InputIterator last)
 	{
+		size_t index = position - data.begin();
+		size_t size = data.size();
 		data.insert(position, first, last);
 		++revision;
+		++modification;
+		changes.record(modification, change_type::insert, index, data.size() - size);
 	}
 
 	void resize(size_t count);
@@ -159,21 +414,29 @@ public:
 
 	void reserve(size_t count)
 	{
-		if(count > data.capacity())
+		if(count > capacity())
 		{
 			++revision;
 		}
-		data.reserve(count);
+		if(typed)
+		{
+			cells.reserve(count);
+		}else{
+			data.reserve(count);
+		}
 	}
 
 	size_t capacity() const
 	{
-		return data.capacity();
+		return typed ? cells.capacity() : data.capacity();
 	}
 };
 
 class map_t : public collection_base<aux::hybrid_map<dyn_object, dyn_object>>
 {
+	// elements are identified by their address, which does not change while they are in the map
+	change_log<const value_type*> changes;
+
 public:
 	map_t() = default;
 
@@ -191,6 +454,23 @@ public:
 	iterator find(const dyn_object &key);
 	size_t erase(const dyn_object &key);
 	iterator erase(iterator position);
+
+	change_log<const value_type*> &get_changes()
+	{
+		return changes;
+	}
+
+	const change_log<const value_type*> &get_changes() const
+	{
+		return changes;
+	}
+
+	// marks the element as modified in place
+	void touch_at(iterator position)
+	{
+		++modification;
+		changes.record(modification, change_type::set, &*position);
+	}
 	bool insert_dyn(iterator position, const std::type_info &type, void *value, iterator &result);
 	bool insert_dyn(iterator position, const std::type_info &type, const void *value, iterator &result);
 
@@ -199,6 +479,7 @@ public:
 	{
 		data.insert(first, last);
 		++revision;
+		++modification;
 	}
 
 	void set_ordered(bool ordered)
@@ -206,6 +487,7 @@ public:
 		if(data.set_ordered(ordered))
 		{
 			++revision;
+			++modification;
 		}
 	}
 
@@ -226,7 +508,7 @@ public:
 	}
 };
 
-class linked_list_t : public collection_base<std::list<std::shared_ptr<dyn_object>>>
+class linked_list_t : public collection_base<aux::node_list<dyn_object>>
 {
 public:
 	dyn_object &operator[](size_t index);
@@ -245,6 +527,8 @@ public:
 	}
 };
 
+typedef aux::bit_set<cell> bitset_t;
+
 class pool_t : public collection_base<aux::hybrid_pool<dyn_object, 4>>
 {
 public:
@@ -325,31 +609,24 @@ public:
 	}
 };
 
-namespace std
+inline void swap(list_t &a, list_t &b) noexcept
 {
-	template <>
-	inline void swap<list_t>(list_t &a, list_t &b) noexcept
-	{
-		a.swap(b);
-	}
+	a.swap(b);
+}
 
-	template <>
-	inline void swap<map_t>(map_t &a, map_t &b) noexcept
-	{
-		a.swap(b);
-	}
+inline void swap(map_t &a, map_t &b) noexcept
+{
+	a.swap(b);
+}
 
-	template <>
-	inline void swap<linked_list_t>(linked_list_t &a, linked_list_t &b) noexcept
-	{
-		a.swap(b);
-	}
+inline void swap(linked_list_t &a, linked_list_t &b) noexcept
+{
+	a.swap(b);
+}
 
-	template <>
-	inline void swap<pool_t>(pool_t &a, pool_t &b) noexcept
-	{
-		a.swap(b);
-	}
+inline void swap(pool_t &a, pool_t &b) noexcept
+{
+	a.swap(b);
 }
 
 class dyn_iterator
@@ -371,6 +648,7 @@ public:
 	virtual std::shared_ptr<dyn_iterator> clone_shared() const;
 	virtual size_t get_hash() const;
 	virtual bool operator==(const dyn_iterator &obj) const;
+	virtual void touch();
 	int &operator[](size_t index) const;
 	virtual ~dyn_iterator() = default;
 
@@ -410,14 +688,20 @@ protected:
 
 	typedef typename Base::iterator iterator;
 	typedef typename Base::value_type value_type;
-	std::weak_ptr<Base> _source;
+	aux::local_weak_ptr<Base> _source;
 	int _revision;
 	iterator _position;
 	state _state;
 
-	virtual std::shared_ptr<Base> lock_same()
+	// strong is set when user code may run while the lock is held
+	aux::local_lock<Base> lock_source(bool strong = false) const
+	{
+		return strong ? _source.lock_strong() : _source.lock_local(is_main_thread);
+	}
+
+	virtual aux::local_lock<Base> lock_same(bool strong = false)
 	{
-		if(auto source = _source.lock())
+		if(auto source = lock_source(strong))
 		{
 			if(source->get_revision() == _revision)
 			{
@@ -432,9 +716,9 @@ protected:
 		return nullptr;
 	}
 
-	virtual std::shared_ptr<Base> lock_same() const
+	virtual aux::local_lock<Base> lock_same(bool strong = false) const
 	{
-		if(auto source = _source.lock())
+		if(auto source = lock_source(strong))
 		{
 			if(source->get_revision() == _revision)
 			{
@@ -467,6 +751,14 @@ public:
 		return _source.expired();
 	}
 
+	virtual void touch() override
+	{
+		if(auto source = lock_source())
+		{
+			source->touch();
+		}
+	}
+
 	virtual bool valid() const override
 	{
 		if(auto source = lock_same())
@@ -512,7 +804,7 @@ public:
 
 	virtual bool set_to_first() override
 	{
-		if(auto source = _source.lock())
+		if(auto source = lock_source())
 		{
 			_revision = source->get_revision();
 			_position = source->begin();
@@ -534,7 +826,7 @@ public:
 
 	virtual bool reset() override
 	{
-		if(auto source = _source.lock())
+		if(auto source = lock_source())
 		{
 			_revision = source->get_revision();
 			_position = source->end();
@@ -546,7 +838,7 @@ public:
 
 	virtual size_t get_hash() const override
 	{
-		if(auto source = _source.lock())
+		if(auto source = lock_source())
 		{
 			if(source->get_revision() == _revision)
 			{
@@ -570,7 +862,7 @@ public:
 
 	virtual bool erase(bool stay) override
 	{
-		if(auto source = lock_same())
+		if(auto source = lock_same(true))
 		{
 			if(_state == state::at_element)
 			{
@@ -627,7 +919,7 @@ public:
 
 	virtual bool insert_dyn(const std::type_info &type, void *value) override
 	{
-		if(auto source = lock_same())
+		if(auto source = lock_same(true))
 		{
 			if(source->insert_dyn(_position, type, value, _position))
 			{
@@ -641,7 +933,7 @@ public:
 
 	virtual bool insert_dyn(const std::type_info &type, const void *value) override
 	{
-		if(auto source = lock_same())
+		if(auto source = lock_same(true))
 		{
 			if(source->insert_dyn(_position, type, value, _position))
 			{
@@ -710,7 +1002,7 @@ public:
 
 	virtual bool set_to_last() override
 	{
-		if(auto source = _source.lock())
+		if(auto source = lock_source())
 		{
 			_revision = source->get_revision();
 			_position = source->end();
@@ -787,7 +1079,7 @@ public:
 
 	virtual bool set_to_last() override
 	{
-		if(auto source = _source.lock())
+		if(auto source = lock_source())
 		{
 			if(!source->ordered()) return false;
 
@@ -821,13 +1113,30 @@ class linked_list_iterator_t : public dyn_iterator, public object_pool<dyn_itera
 protected:
 	typedef typename linked_list_t::iterator iterator;
 	typedef typename linked_list_t::value_type value_type;
-	std::weak_ptr<linked_list_t> _source;
+	aux::local_weak_ptr<linked_list_t> _source;
 	iterator _position;
-	std::weak_ptr<dyn_object> _current;
+	// generation of the node at _position, 0 if there is none
+	size_t _generation;
 	bool _before;
 
-	virtual std::shared_ptr<linked_list_t> lock_same();
-	virtual std::shared_ptr<linked_list_t> lock_same() const;
+	bool current_alive() const
+	{
+		return _generation != 0 && _position.generation() == _generation;
+	}
+
+	void set_current(const aux::local_lock<linked_list_t> &source)
+	{
+		_generation = _position != source->end() ? _position.generation() : 0;
+	}
+
+	// strong is set when user code may run while the lock is held
+	aux::local_lock<linked_list_t> lock_source(bool strong = false) const
+	{
+		return strong ? _source.lock_strong() : _source.lock_local(is_main_thread);
+	}
+
+	virtual aux::local_lock<linked_list_t> lock_same(bool strong = false);
+	virtual aux::local_lock<linked_list_t> lock_same(bool strong = false) const;
 
 public:
 	/*linked_list_iterator_t()
@@ -840,7 +1149,7 @@ public:
 
 	}
 
-	linked_list_iterator_t(const std::shared_ptr<linked_list_t> source, iterator position) : _source(source), _position(position), _current(position != source->end() ? *position : nullptr), _before(false)
+	linked_list_iterator_t(const std::shared_ptr<linked_list_t> source, iterator position) : _source(source), _position(position), _generation(position != source->end() ? position.generation() : 0), _before(false)
 	{
 
 	}
@@ -927,7 +1236,7 @@ public:
 
 	virtual bool set_to_last() override
 	{
-		if(auto source = _source.lock())
+		if(auto source = lock_source())
 		{
 			_revision = source->get_revision();
 			_position = source->last_iter();
@@ -955,6 +1264,66 @@ public:
 	virtual bool extract_dyn(const std::type_info &type, void *value) const override;
 };
 
+// Walks the set in ascending order by value, so it stays usable when the set is modified
+class bitset_iterator_t : public dyn_iterator, public object_pool<dyn_iterator>::ref_container_virtual
+{
+	enum class state
+	{
+		outside,
+		at_element,
+		before_element
+	};
+
+	aux::local_weak_ptr<bitset_t> _source;
+	cell _current;
+	state _state;
+
+	aux::local_lock<bitset_t> lock_source() const
+	{
+		return _source.lock_local(is_main_thread);
+	}
+
+public:
+	bitset_iterator_t(const std::shared_ptr<bitset_t> &source) : _source(source), _current(0), _state(source->first(_current) ? state::at_element : state::outside)
+	{
+
+	}
+
+	bitset_iterator_t(const bitset_iterator_t &iter) = default;
+
+	virtual bool expired() const override;
+	virtual bool valid() const override;
+	virtual bool empty() const override;
+	virtual bool move_next() override;
+	virtual bool move_previous() override;
+	virtual bool set_to_first() override;
+	virtual bool set_to_last() override;
+	virtual bool reset() override;
+	virtual size_t get_hash() const override;
+	virtual bool erase(bool stay) override;
+	virtual std::unique_ptr<dyn_iterator> clone() const override;
+	virtual std::shared_ptr<dyn_iterator> clone_shared() const override;
+	virtual bool operator==(const dyn_iterator &obj) const override;
+
+	virtual bool can_reset() const override;
+	virtual bool can_insert() const override;
+	virtual bool can_erase() const override;
+
+	virtual bool extract_dyn(const std::type_info &type, void *value) const override;
+	virtual bool insert_dyn(const std::type_info &type, void *value) override;
+	virtual bool insert_dyn(const std::type_info &type, const void *value) override;
+
+	virtual dyn_iterator *get() override
+	{
+		return this;
+	}
+
+	virtual const dyn_iterator *get() const override
+	{
+		return this;
+	}
+};
+
 class handle_t
 {
 	dyn_object object;
@@ -1053,6 +1422,7 @@ extern aux::shared_id_set_pool<list_t> list_pool;
 extern aux::shared_id_set_pool<map_t> map_pool;
 extern aux::shared_id_set_pool<linked_list_t> linked_list_pool;
 extern aux::shared_id_set_pool<pool_t> pool_pool;
+extern aux::shared_id_set_pool<bitset_t> bitset_pool;
 extern object_pool<dyn_iterator> iter_pool;
 extern object_pool<handle_t> handle_pool;
 
@@ -20,22 +20,27 @@
 #include <fcntl.h>
 #include <cstring>
 #include <memory>
+#include <algorithm>
 
-struct amx_dbg_info
+struct amx_dbg_info : public AMX_DBG
 {
-	AMX_DBG dbg;
 	int err;
+	std::unique_ptr<debug::symbol_index> symbols;
 
 	amx_dbg_info(FILE *fp)
 	{
-		err = dbg_LoadInfo(&dbg, fp);
+		err = dbg_LoadInfo(this, fp);
+		if(err == AMX_ERR_NONE)
+		{
+			symbols = std::make_unique<debug::symbol_index>(this);
+		}
 	}
 
 	~amx_dbg_info()
 	{
 		if(err == AMX_ERR_NONE)
 		{
-			dbg_FreeInfo(&dbg);
+			dbg_FreeInfo(this);
 		}
 	}
 };
@@ -173,7 +178,7 @@ public:
 		{
 			return nullptr;
 		}
-		return std::shared_ptr<AMX_DBG>(dbg, &dbg->dbg);
+		return dbg;
 	}
 
 	static void reset()
@@ -317,7 +322,7 @@ public:
 		{
 			return nullptr;
 		}
-		return std::shared_ptr<AMX_DBG>(dbg, &dbg->dbg);
+		return dbg;
 	}
 
 	static void reset()
@@ -393,3 +398,199 @@ void debug::clear_file()
 	fopen_hook::reset();
 #endif
 }
+
+const debug::symbol_index &debug::get_symbols(const AMX_DBG *dbg)
+{
+	return *static_cast<const amx_dbg_info*>(dbg)->symbols;
+}
+
+void debug::symbol_index::interval_list::build(const AMX_DBG *dbg)
+{
+	std::stable_sort(symbols.begin(), symbols.end(), [&](uint16_t a, uint16_t b)
+	{
+		return dbg->symboltbl[a]->codestart < dbg->symboltbl[b]->codestart;
+	});
+	max_end.reserve(symbols.size());
+	ucell end = 0;
+	for(uint16_t i : symbols)
+	{
+		ucell codeend = dbg->symboltbl[i]->codeend;
+		if(codeend > end)
+		{
+			end = codeend;
+		}
+		max_end.push_back(end);
+	}
+}
+
+template <class Func>
+void debug::symbol_index::interval_list::find(const AMX_DBG *dbg, ucell addr, Func func) const
+{
+	auto it = std::upper_bound(symbols.begin(), symbols.end(), addr, [&](ucell addr, uint16_t i)
+	{
+		return addr < dbg->symboltbl[i]->codestart;
+	});
+	for(size_t pos = it - symbols.begin(); pos > 0 && max_end[pos - 1] >= addr; pos--)
+	{
+		uint16_t i = symbols[pos - 1];
+		if(dbg->symboltbl[i]->codeend >= addr)
+		{
+			func(i);
+		}
+	}
+}
+
+void debug::symbol_index::find_contained(const AMX_DBG_SYMBOL *sym, std::vector<uint16_t> &contained) const
+{
+	auto it = std::lower_bound(variables_by_start.begin(), variables_by_start.end(), sym->codestart, [&](uint16_t i, ucell addr)
+	{
+		return dbg->symboltbl[i]->codestart < addr;
+	});
+	for(; it != variables_by_start.end() && dbg->symboltbl[*it]->codestart <= sym->codeend; ++it)
+	{
+		if(dbg->symboltbl[*it]->codeend <= sym->codeend)
+		{
+			contained.push_back(*it);
+		}
+	}
+	std::sort(contained.begin(), contained.end());
+}
+
+debug::symbol_index::symbol_index(const AMX_DBG *dbg) : dbg(dbg)
+{
+	auto &variables = variables_by_start;
+	for(uint16_t i = 0; i < dbg->hdr->symbols; i++)
+	{
+		auto sym = dbg->symboltbl[i];
+		names[sym->name].push_back(i);
+		if(sym->ident == iFUNCTN)
+		{
+			functions.symbols.push_back(i);
+			continue;
+		}
+		variables.push_back(i);
+		if(sym->vclass == 1)
+		{
+			locals.symbols.push_back(i);
+		}else if(sym->ident == iVARIABLE || sym->ident == iARRAY)
+		{
+			globals.emplace(static_cast<ucell>(sym->address), i);
+		}
+	}
+	functions.build(dbg);
+	locals.build(dbg);
+
+	// functions do not overlap, so every variable is visited only by the function it starts in
+	std::stable_sort(variables.begin(), variables.end(), [&](uint16_t a, uint16_t b)
+	{
+		return dbg->symboltbl[a]->codestart < dbg->symboltbl[b]->codestart;
+	});
+	for(uint16_t f : functions.symbols)
+	{
+		auto func = dbg->symboltbl[f];
+		std::vector<uint16_t> contained, params;
+		find_contained(func, contained);
+		for(uint16_t i : contained)
+		{
+			auto sym = dbg->symboltbl[i];
+			if(sym->vclass == 1 && static_cast<cell>(sym->address) > static_cast<cell>(2 * sizeof(cell)))
+			{
+				params.push_back(i);
+			}
+		}
+		scope_variables[func] = std::move(contained);
+		if(!params.empty())
+		{
+			function_parameters[func] = std::move(params);
+		}
+	}
+}
+
+cell debug::symbol_index::find_symbol(const char *name, ucell cip, cell kind, cell cls) const
+{
+	auto it = names.find(name);
+	if(it == names.end())
+	{
+		return -1;
+	}
+	cell minindex = -1;
+	ucell mindist;
+	for(uint16_t i : it->second)
+	{
+		auto sym = dbg->symboltbl[i];
+		if((sym->ident == iFUNCTN || (sym->codestart <= cip && sym->codeend > cip)) && ((1 << (sym->ident - 1)) & kind) && ((1 << sym->vclass) & cls))
+		{
+			if(minindex == -1 || sym->codeend - sym->codestart < mindist)
+			{
+				minindex = i;
+				mindist = sym->codeend - sym->codestart;
+			}
+		}
+	}
+	return minindex;
+}
+
+cell debug::symbol_index::find_function(ucell codestart, ucell codeend) const
+{
+	cell minindex = -1;
+	ucell mindist;
+	functions.find(dbg, codestart, [&](uint16_t i)
+	{
+		auto sym = dbg->symboltbl[i];
+		if(sym->codestart <= codestart && sym->codeend >= codeend)
+		{
+			ucell dist = sym->codeend - sym->codestart;
+			if(minindex == -1 || dist < mindist || (dist == mindist && i < minindex))
+			{
+				minindex = i;
+				mindist = dist;
+			}
+		}
+	});
+	return minindex;
+}
+
+cell debug::symbol_index::find_global(ucell addr) const
+{
+	auto it = globals.find(addr);
+	if(it == globals.end())
+	{
+		return -1;
+	}
+	return it->second;
+}
+
+cell debug::symbol_index::find_local(cell offset, ucell cip) const
+{
+	cell minindex = -1;
+	locals.find(dbg, cip, [&](uint16_t i)
+	{
+		auto sym = dbg->symboltbl[i];
+		if((sym->ident == iVARIABLE || sym->ident == iARRAY) && sym->address == offset && sym->codestart <= cip && cip < sym->codeend)
+		{
+			if(minindex == -1 || i < minindex)
+			{
+				minindex = i;
+			}
+		}
+	});
+	return minindex;
+}
+
+const std::vector<uint16_t> &debug::symbol_index::variables(const AMX_DBG_SYMBOL *sym) const
+{
+	auto it = scope_variables.find(sym);
+	if(it == scope_variables.end())
+	{
+		it = scope_variables.emplace(sym, std::vector<uint16_t>()).first;
+		find_contained(sym, it->second);
+	}
+	return it->second;
+}
+
+const std::vector<uint16_t> &debug::symbol_index::parameters(const AMX_DBG_SYMBOL *func) const
+{
+	static const std::vector<uint16_t> empty;
+	auto it = function_parameters.find(func);
+	return it != function_parameters.end() ? it->second : empty;
+}
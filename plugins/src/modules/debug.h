@@ -3,12 +3,63 @@
 
 #include "amxinfo.h"
 #include "sdk/amx/amxdbg.h"
+#include <string>
+#include <vector>
+#include <unordered_map>
 
 namespace debug
 {
+	// Lookup tables over the symbols of a debug info, built once when it is loaded.
+	// All functions return the index of the symbol, or -1 if there is none.
+	class symbol_index
+	{
+		// symbols sorted by codestart, with the largest codeend up to each position,
+		// to find all symbols whose code range contains a particular address
+		struct interval_list
+		{
+			std::vector<uint16_t> symbols;
+			std::vector<ucell> max_end;
+
+			void build(const AMX_DBG *dbg);
+			template <class Func>
+			void find(const AMX_DBG *dbg, ucell addr, Func func) const;
+		};
+
+		const AMX_DBG *dbg;
+		std::unordered_map<std::string, std::vector<uint16_t>> names;
+		interval_list functions;
+		interval_list locals;
+		std::unordered_map<ucell, uint16_t> globals;
+		// non-function symbols sorted by codestart
+		std::vector<uint16_t> variables_by_start;
+		// filled for functions when built, and for other symbols on first use
+		mutable std::unordered_map<const AMX_DBG_SYMBOL*, std::vector<uint16_t>> scope_variables;
+		std::unordered_map<const AMX_DBG_SYMBOL*, std::vector<uint16_t>> function_parameters;
+
+		void find_contained(const AMX_DBG_SYMBOL *sym, std::vector<uint16_t> &contained) const;
+
+	public:
+		explicit symbol_index(const AMX_DBG *dbg);
+
+		// the symbol of the name with the smallest scope that contains the code address
+		cell find_symbol(const char *name, ucell cip, cell kind = -1, cell cls = -1) const;
+		// the innermost function that contains the whole code range
+		cell find_function(ucell codestart, ucell codeend) const;
+		// a global or static variable at the address in the data section
+		cell find_global(ucell addr) const;
+		// a local variable at the offset from the frame, in scope at the code address
+		cell find_local(cell offset, ucell cip) const;
+		// all non-function symbols whose code range is within that of the symbol, in the order of the symbol table
+		const std::vector<uint16_t> &variables(const AMX_DBG_SYMBOL *sym) const;
+		// the local symbols of the function that are its parameters
+		const std::vector<uint16_t> &parameters(const AMX_DBG_SYMBOL *func) const;
+	};
+
 	void init();
 	void clear_file();
 	std::shared_ptr<AMX_DBG> create_last(std::unique_ptr<char[]> &name);
+	// the debug info must be obtained from create_last
+	const symbol_index &get_symbols(const AMX_DBG *dbg);
 }
 
 #endif
@@ -3,6 +3,7 @@
 #include "hooks.h"
 #include "main.h"
 #include "errors.h"
+#include "tracing.h"
 #include "objects/stored_param.h"
 #include "utils/optional.h"
 
@@ -13,15 +14,19 @@
 
 class event_info
 {
+	friend class event_list;
+
 	cell flags;
 	std::vector<stored_param> arg_values;
 	std::string handler;
 	aux::optional<int> index;
+	size_t slot = 0;
 	bool handler_index(AMX *amx, int &index);
 
 public:
 	event_info(cell flags, AMX *amx, const char *function, const char *format, const cell *args, size_t numargs);
 	bool invoke(AMX *amx, cell *retval, cell id);
+	const std::string &get_handler() const { return handler; }
 };
 
 class callback_info
@@ -39,36 +44,79 @@ public:
 	void invoke(AMX *amx, cell *retval);
 };
 
+// Removed handlers are only marked as null (tombstones), since they may be
+// removed while the list is being invoked. The list is compacted when there
+// are more tombstones than live handlers and no invocation is in progress.
 class event_list
 {
+	static constexpr size_t min_tombstones = 16;
+
 	int nested_level = 0;
+	size_t tombstones = 0;
 	std::vector<std::unique_ptr<event_info>> handlers;
 
+	void compact()
+	{
+		size_t pos = 0;
+		for(size_t i = 0; i < handlers.size(); i++)
+		{
+			if(handlers[i])
+			{
+				if(pos != i)
+				{
+					handlers[pos] = std::move(handlers[i]);
+				}
+				handlers[pos]->slot = pos;
+				pos++;
+			}
+		}
+		handlers.resize(pos);
+		tombstones = 0;
+	}
+
+	void compact_if_needed()
+	{
+		if(nested_level == 0 && tombstones > 0)
+		{
+			if(tombstones == handlers.size())
+			{
+				handlers.clear();
+				tombstones = 0;
+			}else if(tombstones >= min_tombstones && tombstones >= handlers.size() - tombstones)
+			{
+				compact();
+			}
+		}
+	}
 
 public:
 	event_list() noexcept = default;
 
-	event_list(event_list &&obj) noexcept : nested_level(obj.nested_level), handlers(std::move(obj.handlers))
+	event_list(event_list &&obj) noexcept : nested_level(obj.nested_level), tombstones(obj.tombstones), handlers(std::move(obj.handlers))
 	{
-
+		obj.tombstones = 0;
 	}
 
 	event_list &operator=(event_list &&obj) noexcept
 	{
 		nested_level = obj.nested_level;
+		tombstones = obj.tombstones;
 		handlers = std::move(obj.handlers);
+		obj.tombstones = 0;
 		return *this;
 	}
 
-	std::vector<std::unique_ptr<event_info>>::iterator erase(std::vector<std::unique_ptr<event_info>>::iterator it)
+	bool remove(event_info *handler)
 	{
-		if(nested_level == 0)
+		size_t slot = handler->slot;
+		if(slot >= handlers.size() || handlers[slot].get() != handler)
 		{
-			return handlers.erase(it);
-		}else{
-			*it = nullptr;
-			return ++it;
+			return false;
 		}
+		handlers[slot] = nullptr;
+		tombstones++;
+		compact_if_needed();
+		return true;
 	}
 
 	std::unique_ptr<event_info> &operator[](size_t index)
@@ -81,18 +129,14 @@ public:
 		return handlers.size();
 	}
 
-	std::vector<std::unique_ptr<event_info>>::iterator begin()
-	{
-		return handlers.begin();
-	}
-
-	std::vector<std::unique_ptr<event_info>>::iterator end()
+	bool empty() const
 	{
-		return handlers.end();
+		return handlers.size() == tombstones;
 	}
 
 	void push_back(std::unique_ptr<event_info> &&obj)
 	{
+		obj->slot = handlers.size();
 		handlers.push_back(std::move(obj));
 	}
 
@@ -112,13 +156,8 @@ public:
 
 		~level_guard()
 		{
-			if(--list.nested_level == 0)
-			{
-				list.handlers.erase(std::remove_if(std::make_move_iterator(list.handlers.begin()), std::make_move_iterator(list.handlers.end()), [](const std::unique_ptr<event_info> &ptr)
-				{
-					return ptr == nullptr;
-				}).base(), list.handlers.end());
-			}
+			--list.nested_level;
+			list.compact_if_needed();
 		}
 	};
 };
@@ -130,6 +169,9 @@ public:
 	std::unordered_map<int, event_list> callback_handlers_negative;
 	std::unordered_map<cell, int> handler_ids;
 
+	// bit is set if the public at the index has any registered handlers
+	std::vector<bool> active_callbacks;
+
 	std::vector<callback_info> custom_callbacks;
 	std::unordered_map<std::string, int> custom_callbacks_map;
 	int name_length = 0;
@@ -138,6 +180,32 @@ public:
 	{
 
 	}
+
+	virtual ~amx_info()
+	{
+		for(const auto &pair : handler_ids)
+		{
+			tracing::remove(pair.first);
+		}
+	}
+
+	void set_active(int index, bool active)
+	{
+		if(index >= 0)
+		{
+			if(static_cast<size_t>(index) >= active_callbacks.size())
+			{
+				if(!active) return;
+				active_callbacks.resize(index + 1);
+			}
+			active_callbacks[index] = active;
+		}
+	}
+
+	bool is_active(int index) const
+	{
+		return index >= 0 && static_cast<size_t>(index) < active_callbacks.size() && active_callbacks[index];
+	}
 };
 
 amx_info &get_info(AMX *amx, amx::object &obj)
@@ -174,6 +242,7 @@ namespace events
 		cell id = reinterpret_cast<cell>(ptr.get());
 		list->push_back(std::move(ptr));
 		info.handler_ids[id] = index;
+		info.set_active(index, true);
 		return id;
 	}
 
@@ -182,11 +251,12 @@ namespace events
 		amx::object obj;
 		auto &info = get_info(amx, obj);
 		auto &handler_ids = info.handler_ids;
-		auto ptr = reinterpret_cast<event_info*>(id);
 		auto hit = handler_ids.find(id);
 		if(hit != handler_ids.end())
 		{
 			int index = hit->second;
+			handler_ids.erase(hit);
+			tracing::remove(id);
 			event_list *list;
 			if(index >= 0)
 			{
@@ -194,16 +264,14 @@ namespace events
 			}else{
 				list = &info.callback_handlers_negative[index];
 			}
-			for(auto it = list->begin(); it != list->end(); it++)
+			if(list->remove(reinterpret_cast<event_info*>(id)))
 			{
-				if(it->get() == ptr)
+				if(list->empty())
 				{
-					list->erase(it);
-					handler_ids.erase(hit);
-					return true;
+					info.set_active(index, false);
 				}
+				return true;
 			}
-			handler_ids.erase(hit);
 		}
 		return false;
 	}
@@ -215,10 +283,12 @@ namespace events
 		event_list *list = nullptr;
 		if(index >= 0)
 		{
-			auto &callback_handlers = info.callback_handlers;
-			if(static_cast<size_t>(index) < callback_handlers.size())
+			if(info.is_active(index))
+			{
+				list = &info.callback_handlers[index];
+			}else if(info.custom_callbacks.empty())
 			{
-				list = &callback_handlers[index];
+				return false;
 			}
 		}else{
 			auto &callback_handlers_negative = info.callback_handlers_negative;
@@ -237,7 +307,24 @@ namespace events
 				auto &handler = (*list)[i];
 				if(handler)
 				{
-					if(handler->invoke(amx, retval, reinterpret_cast<cell>(handler.get())))
+					cell id = reinterpret_cast<cell>(handler.get());
+					tracing::scope trace;
+					if(tracing::active())
+					{
+						auto &stats = tracing::get(id);
+						if(!stats.kind)
+						{
+							stats.kind = "callback";
+							stats.handler = handler->get_handler();
+							char *name = amx_NameBuffer(amx);
+							if(amx_GetPublic(amx, index, name) == AMX_ERR_NONE)
+							{
+								stats.target = name;
+							}
+						}
+						trace.begin(id, stats);
+					}
+					if(handler->invoke(amx, retval, id))
 					{
 						return true;
 					}
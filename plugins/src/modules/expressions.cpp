@@ -3,6 +3,7 @@
 #include "errors.h"
 #include "modules/variants.h"
 #include "modules/parser.h"
+#include "modules/debug.h"
 #include "utils/systools.h"
 
 #include <string>
@@ -2225,60 +2226,57 @@ dyn_object symbol_expression::call(const args_type &args, const exec_info &info,
 
 		cell argslen = call_args.size() * sizeof(cell);
 		cell argsneeded = 0;
-		for(uint16_t i = 0; i < debug->hdr->symbols; i++)
+		for(uint16_t i : ::debug::get_symbols(debug).parameters(symbol))
 		{
 			auto vsym = debug->symboltbl[i];
-			if(vsym->ident != iFUNCTN && vsym->vclass == 1 && vsym->codestart >= symbol->codestart && vsym->codeend <= symbol->codeend)
+			cell addr = vsym->address - 2 * sizeof(cell);
+			if(addr > argslen)
 			{
-				cell addr = vsym->address - 2 * sizeof(cell);
-				if(addr > argslen)
+				if(addr > argsneeded)
 				{
-					if(addr > argsneeded)
-					{
-						argsneeded = addr;
-					}
-				}else if(addr >= 0 && !argsneeded)
-				{
-					const auto &arg = call_args[addr / sizeof(cell) - 1];
-					cell tag = vsym->tag;
-					tag_ptr test_tag = nullptr;
+					argsneeded = addr;
+				}
+			}else if(addr >= 0 && !argsneeded)
+			{
+				const auto &arg = call_args[addr / sizeof(cell) - 1];
+				cell tag = vsym->tag;
+				tag_ptr test_tag = nullptr;
 
-					if(tag == 0)
-					{
-						test_tag = tags::find_tag(tags::tag_cell);
-					}else{
-						const char *tagname;
-						if(dbg_GetTagName(debug, tag, &tagname) == AMX_ERR_NONE)
-						{
-							test_tag = tags::find_existing_tag(tagname);
-						}
-					}
-					bool isaddress = arg.tag_assignable(tags::find_tag(tags::tag_address));
-					if(isaddress && vsym->ident != iREFERENCE && vsym->ident != iARRAY && vsym->ident != iREFARRAY)
-					{
-						amx_ExpressionError("address argument not expected");
-					}
-					if(isaddress)
+				if(tag == 0)
+				{
+					test_tag = tags::find_tag(tags::tag_cell);
+				}else{
+					const char *tagname;
+					if(dbg_GetTagName(debug, tag, &tagname) == AMX_ERR_NONE)
 					{
-						if(test_tag)
-						{
-							test_tag = tags::find_tag((tags::find_tag(tags::tag_address)->name + "@" + test_tag->name).c_str());
-						}
-					}else{
-						if(vsym->dim != arg.get_rank())
-						{
-							amx_ExpressionError("incorrect rank of argument (%d needed, %d given)", vsym->dim, arg.get_rank());
-						}
+						test_tag = tags::find_existing_tag(tagname);
 					}
-					if(test_tag && !arg.tag_assignable(test_tag))
+				}
+				bool isaddress = arg.tag_assignable(tags::find_tag(tags::tag_address));
+				if(isaddress && vsym->ident != iREFERENCE && vsym->ident != iARRAY && vsym->ident != iREFARRAY)
+				{
+					amx_ExpressionError("address argument not expected");
+				}
+				if(isaddress)
+				{
+					if(test_tag)
 					{
-						amx_ExpressionError("argument tag mismatch (%s: required, %s: provided)", test_tag->format_name(), arg.get_tag()->format_name());
+						test_tag = tags::find_tag((tags::find_tag(tags::tag_address)->name + "@" + test_tag->name).c_str());
 					}
-					if(!isaddress && (vsym->ident == iREFERENCE || vsym->ident == iARRAY || vsym->ident == iREFARRAY) && arg.get_rank() <= 0)
+				}else{
+					if(vsym->dim != arg.get_rank())
 					{
-						amx_ExpressionError("a reference argument must be provided with an array value or an address");
+						amx_ExpressionError("incorrect rank of argument (%d needed, %d given)", vsym->dim, arg.get_rank());
 					}
 				}
+				if(test_tag && !arg.tag_assignable(test_tag))
+				{
+					amx_ExpressionError("argument tag mismatch (%s: required, %s: provided)", test_tag->format_name(), arg.get_tag()->format_name());
+				}
+				if(!isaddress && (vsym->ident == iREFERENCE || vsym->ident == iARRAY || vsym->ident == iREFARRAY) && arg.get_rank() <= 0)
+				{
+					amx_ExpressionError("a reference argument must be provided with an array value or an address");
+				}
 			}
 		}
 		if(argsneeded)
@@ -0,0 +1,521 @@
+#include "indexes.h"
+#include "main.h"
+#include "modules/tags.h"
+
+#include <algorithm>
+#include <iterator>
+
+aux::shared_id_set_pool<index_t> index_pool;
+
+index_t::index_t(const std::shared_ptr<list_t> &list, cell offset) : _list(list), _is_list(true), _offset(offset)
+{
+	list->get_changes().enable();
+}
+
+index_t::index_t(const std::shared_ptr<list_t> &list, expression_ptr &&expr) : _list(list), _is_list(true), _offset(-1), _expr(std::move(expr))
+{
+	list->get_changes().enable();
+}
+
+index_t::index_t(const std::shared_ptr<map_t> &map, cell offset) : _map(map), _is_list(false), _offset(offset)
+{
+	map->get_changes().enable();
+}
+
+index_t::index_t(const std::shared_ptr<map_t> &map, expression_ptr &&expr) : _map(map), _is_list(false), _offset(-1), _expr(std::move(expr))
+{
+	map->get_changes().enable();
+}
+
+bool index_t::expired() const
+{
+	return _is_list ? _list.expired() : _map.expired();
+}
+
+bool index_t::is_current() const
+{
+	if(!_built) return false;
+	if(auto list = _list.lock_local(is_main_thread))
+	{
+		return list->get_modification() == _modification;
+	}else if(auto map = _map.lock_local(is_main_thread))
+	{
+		return map->get_modification() == _modification;
+	}
+	return false;
+}
+
+bool index_t::make_key(const dyn_object &value, const dyn_object &element_key, dyn_object &key, expression::args_type &args, const expression::exec_info &info) const
+{
+	if(_expr)
+	{
+		args.clear();
+		args.push_back(std::cref(value));
+		args.push_back(std::cref(element_key));
+		key = _expr->execute(args, info);
+		return true;
+	}
+	if(_offset == -1)
+	{
+		key = value;
+		return true;
+	}
+	cell offset = _offset;
+	const cell *addr = value.get_cell_addr(&offset, 1);
+	if(!addr)
+	{
+		return false;
+	}
+	key = dyn_object(*addr, value.get_tag());
+	return true;
+}
+
+static bool entry_less(const index_t::entry &a, const index_t::entry &b)
+{
+	if(a.key < b.key) return true;
+	if(b.key < a.key) return false;
+	return a.position < b.position;
+}
+
+void index_t::collect(AMX *amx, std::vector<entry> &entries)
+{
+	_map_elements.clear();
+	_map_slots.clear();
+	_map_holes = 0;
+
+	expression::args_type args;
+	expression::exec_info info(amx);
+	dyn_object key;
+	// keys are made by expressions and compared by tag operations, which may run user code
+	if(auto list = _list.lock_strong())
+	{
+		_modification = list->get_modification();
+		entries.reserve(list->size());
+		for(size_t i = 0; i < list->size(); i++)
+		{
+			if(make_key((*list)[i], dyn_object(static_cast<cell>(i), tags::find_tag(tags::tag_cell)), key, args, info))
+			{
+				entries.push_back(entry{std::move(key), i});
+			}
+		}
+		_source_size = list->size();
+	}else if(auto map = _map.lock_strong())
+	{
+		_modification = map->get_modification();
+		entries.reserve(map->size());
+		_map_elements.reserve(map->size());
+		for(auto it = map->begin(); it != map->end(); ++it)
+		{
+			if(make_key(it->second, it->first, key, args, info))
+			{
+				entries.push_back(entry{std::move(key), _map_elements.size()});
+			}
+			_map_slots.emplace(&*it, _map_elements.size());
+			_map_elements.push_back(&*it);
+		}
+		_source_size = _map_elements.size();
+	}else{
+		_source_size = 0;
+	}
+}
+
+bool index_t::apply_changes(const list_t &list, std::vector<bool> &dirty)
+{
+	const change_log<size_t>::change *begin, *end;
+	if(!list.get_changes().since(_modification, list.get_modification(), begin, end))
+	{
+		return false;
+	}
+	const size_t none = static_cast<size_t>(-1);
+	dirty.assign(_source_size, false);
+	for(auto change = begin; change != end; ++change)
+	{
+		size_t first = change->first, last = change->first + change->count;
+		switch(change->type)
+		{
+			case change_type::set:
+			{
+				if(last > dirty.size()) return false;
+				std::fill(dirty.begin() + first, dirty.begin() + last, true);
+				continue;
+			}
+			case change_type::insert:
+			{
+				if(first > dirty.size()) return false;
+				if(first < dirty.size())
+				{
+					for(auto &e : _entries)
+					{
+						if(e.position != none && e.position >= first)
+						{
+							e.position += change->count;
+						}
+					}
+				}
+				dirty.insert(dirty.begin() + first, change->count, true);
+				break;
+			}
+			case change_type::erase:
+			{
+				if(last > dirty.size()) return false;
+				for(auto &e : _entries)
+				{
+					if(e.position == none || e.position < first)
+					{
+						continue;
+					}
+					if(e.position < last)
+					{
+						e.position = none;
+					}else{
+						e.position -= change->count;
+					}
+				}
+				dirty.erase(dirty.begin() + first, dirty.begin() + last);
+				break;
+			}
+		}
+		if(_expr && change->count > 0)
+		{
+			// expressions are given the index of the element, which has moved
+			std::fill(dirty.begin() + first, dirty.end(), true);
+		}
+	}
+	return dirty.size() == list.size();
+}
+
+bool index_t::apply_changes(const map_t &map, std::vector<bool> &dirty)
+{
+	const change_log<const map_t::value_type*>::change *begin, *end;
+	if(!map.get_changes().since(_modification, map.get_modification(), begin, end))
+	{
+		return false;
+	}
+	dirty.assign(_map_elements.size(), false);
+	for(auto change = begin; change != end; ++change)
+	{
+		auto slot = _map_slots.find(change->first);
+		switch(change->type)
+		{
+			case change_type::set:
+			{
+				if(slot == _map_slots.end()) return false;
+				dirty[slot->second] = true;
+				break;
+			}
+			case change_type::insert:
+			{
+				if(slot != _map_slots.end()) return false;
+				_map_slots.emplace(change->first, _map_elements.size());
+				_map_elements.push_back(change->first);
+				dirty.push_back(true);
+				break;
+			}
+			case change_type::erase:
+			{
+				if(slot == _map_slots.end()) return false;
+				_map_elements[slot->second] = nullptr;
+				dirty[slot->second] = false;
+				_map_slots.erase(slot);
+				++_map_holes;
+				break;
+			}
+		}
+	}
+	// compacts the positions when too many are empty
+	return _map_holes <= _map_elements.size() / 2;
+}
+
+void index_t::merge_changed(AMX *amx, const std::vector<bool> &dirty)
+{
+	const size_t none = static_cast<size_t>(-1);
+	std::vector<entry> changed;
+	expression::args_type args;
+	expression::exec_info info(amx);
+	dyn_object key;
+	if(auto list = _list.lock_strong())
+	{
+		_modification = list->get_modification();
+		for(size_t i = 0; i < dirty.size() && i < list->size(); i++)
+		{
+			if(dirty[i] && make_key((*list)[i], dyn_object(static_cast<cell>(i), tags::find_tag(tags::tag_cell)), key, args, info))
+			{
+				changed.push_back(entry{std::move(key), i});
+			}
+		}
+		_source_size = dirty.size();
+	}else if(auto map = _map.lock_strong())
+	{
+		_modification = map->get_modification();
+		for(size_t i = 0; i < dirty.size(); i++)
+		{
+			const auto *element = _map_elements[i];
+			if(dirty[i] && element && make_key(element->second, element->first, key, args, info))
+			{
+				changed.push_back(entry{std::move(key), i});
+			}
+		}
+		_source_size = _map_elements.size();
+	}
+	std::sort(changed.begin(), changed.end(), entry_less);
+
+	// the other entries are still sorted relative to each other
+	std::vector<entry> entries;
+	entries.reserve(_entries.size() + changed.size());
+	auto it = changed.begin();
+	for(auto &e : _entries)
+	{
+		if(e.position == none || dirty[e.position] || (!_is_list && !_map_elements[e.position])) continue;
+		while(it != changed.end() && entry_less(*it, e))
+		{
+			entries.push_back(std::move(*it));
+			++it;
+		}
+		entries.push_back(std::move(e));
+	}
+	entries.insert(entries.end(), std::make_move_iterator(it), std::make_move_iterator(changed.end()));
+	_entries = std::move(entries);
+}
+
+void index_t::update(AMX *amx)
+{
+	if(is_current())
+	{
+		return;
+	}
+	std::vector<bool> dirty;
+	bool applied = false;
+	if(_built)
+	{
+		if(auto list = _list.lock_local(is_main_thread))
+		{
+			applied = apply_changes(*list, dirty);
+		}else if(auto map = _map.lock_local(is_main_thread))
+		{
+			applied = apply_changes(*map, dirty);
+		}
+	}
+	if(!applied)
+	{
+		rebuild(amx);
+		return;
+	}
+	merge_changed(amx, dirty);
+	++_generation;
+}
+
+void index_t::rebuild(AMX *amx)
+{
+	std::vector<entry> entries;
+	collect(amx, entries);
+	std::sort(entries.begin(), entries.end(), entry_less);
+	_entries = std::move(entries);
+	_built = true;
+	++_generation;
+}
+
+size_t index_t::lower_bound(const dyn_object &key) const
+{
+	return std::lower_bound(_entries.begin(), _entries.end(), key, [](const entry &a, const dyn_object &b)
+	{
+		return a.key < b;
+	}) - _entries.begin();
+}
+
+size_t index_t::upper_bound(const dyn_object &key) const
+{
+	return std::upper_bound(_entries.begin(), _entries.end(), key, [](const dyn_object &a, const entry &b)
+	{
+		return a < b.key;
+	}) - _entries.begin();
+}
+
+dyn_object *index_t::get_value(size_t index) const
+{
+	if(auto list = _list.lock_local(is_main_thread))
+	{
+		return &(*list)[_entries[index].position];
+	}
+	return nullptr;
+}
+
+std::pair<const dyn_object, dyn_object> *index_t::get_pair(size_t index) const
+{
+	if(!_is_list && !_map.expired())
+	{
+		// the elements are owned by the map, which is not const
+		return const_cast<std::pair<const dyn_object, dyn_object>*>(_map_elements[_entries[index].position]);
+	}
+	return nullptr;
+}
+
+
+
+index_iterator_t::index_iterator_t(const std::shared_ptr<index_t> &source, size_t begin, size_t end) : _source(source), _generation(source->get_generation()), _begin(begin), _end(end), _position(begin)
+{
+
+}
+
+aux::local_lock<index_t> index_iterator_t::lock_same() const
+{
+	if(auto source = _source.lock_local(is_main_thread))
+	{
+		if(source->get_generation() == _generation && source->is_current())
+		{
+			return source;
+		}
+	}
+	return nullptr;
+}
+
+bool index_iterator_t::expired() const
+{
+	return _source.expired();
+}
+
+bool index_iterator_t::valid() const
+{
+	if(lock_same())
+	{
+		return _position < _end;
+	}
+	return false;
+}
+
+bool index_iterator_t::move_next()
+{
+	if(lock_same())
+	{
+		if(_position < _end)
+		{
+			++_position;
+			return _position < _end;
+		}
+	}
+	return false;
+}
+
+bool index_iterator_t::move_previous()
+{
+	if(lock_same())
+	{
+		if(_position == _begin)
+		{
+			_position = _end;
+		}else if(_position < _end)
+		{
+			--_position;
+			return true;
+		}
+	}
+	return false;
+}
+
+bool index_iterator_t::set_to_first()
+{
+	if(lock_same())
+	{
+		_position = _begin;
+		return _position < _end;
+	}
+	return false;
+}
+
+bool index_iterator_t::set_to_last()
+{
+	if(lock_same())
+	{
+		if(_begin < _end)
+		{
+			_position = _end - 1;
+			return true;
+		}
+		_position = _end;
+	}
+	return false;
+}
+
+bool index_iterator_t::reset()
+{
+	if(!_source.expired())
+	{
+		_position = _end;
+		return true;
+	}
+	return false;
+}
+
+bool index_iterator_t::can_reset() const
+{
+	return !_source.expired();
+}
+
+std::unique_ptr<dyn_iterator> index_iterator_t::clone() const
+{
+	return std::make_unique<index_iterator_t>(*this);
+}
+
+std::shared_ptr<dyn_iterator> index_iterator_t::clone_shared() const
+{
+	return std::make_shared<index_iterator_t>(*this);
+}
+
+size_t index_iterator_t::get_hash() const
+{
+	if(auto source = lock_same())
+	{
+		if(_position < _end)
+		{
+			if(source->is_list())
+			{
+				return std::hash<const dyn_object*>()(source->get_value(_position));
+			}
+			return std::hash<const void*>()(source->get_pair(_position));
+		}
+		return std::hash<const index_t*>()(source.get());
+	}
+	return 0;
+}
+
+bool index_iterator_t::operator==(const dyn_iterator &obj) const
+{
+	auto other = dynamic_cast<const index_iterator_t*>(&obj);
+	if(other != nullptr)
+	{
+		return !_source.owner_before(other->_source) && !other->_source.owner_before(_source) && _generation == other->_generation && _begin == other->_begin && _end == other->_end && _position == other->_position;
+	}
+	return false;
+}
+
+bool index_iterator_t::extract_dyn(const std::type_info &type, void *value) const
+{
+	if(auto source = lock_same())
+	{
+		if(_position >= _end)
+		{
+			return false;
+		}
+		if(source->is_list())
+		{
+			const dyn_object *obj = source->get_value(_position);
+			if(type == typeid(const dyn_object*))
+			{
+				*reinterpret_cast<const dyn_object**>(value) = obj;
+				return true;
+			}else if(type == typeid(std::shared_ptr<const std::pair<const dyn_object, dyn_object>>))
+			{
+				auto fake_pair = std::make_shared<std::pair<const dyn_object, dyn_object>>(std::pair<const dyn_object, dyn_object>(dyn_object(static_cast<cell>((*source)[_position].position), tags::find_tag(tags::tag_cell)), *obj));
+				*reinterpret_cast<std::shared_ptr<const std::pair<const dyn_object, dyn_object>>*>(value) = std::move(fake_pair);
+				return true;
+			}
+		}else{
+			const auto *pair = source->get_pair(_position);
+			if(type == typeid(const std::pair<const dyn_object, dyn_object>*))
+			{
+				*reinterpret_cast<const std::pair<const dyn_object, dyn_object>**>(value) = pair;
+				return true;
+			}
+		}
+	}
+	return false;
+}
@@ -0,0 +1,140 @@
+#ifndef INDEXES_H_INCLUDED
+#define INDEXES_H_INCLUDED
+
+#include "modules/containers.h"
+#include "modules/expressions.h"
+#include "objects/dyn_object.h"
+#include "utils/shared_id_set_pool.h"
+#include "utils/local_ptr.h"
+#include "sdk/amx/amx.h"
+
+#include <vector>
+#include <unordered_map>
+#include <memory>
+#include <utility>
+
+// Sorted view of the elements of a list or a map, ordered by a key taken from
+// each element. It is updated lazily when the source has been modified since.
+// The source records the positions it changes, so only the keys of changed
+// elements are made and sorted again; when the changes are not known (after
+// touch, sorting, swapping or too many changes), all keys are made again.
+class index_t
+{
+public:
+	struct entry
+	{
+		dyn_object key;
+		size_t position;
+	};
+
+private:
+	aux::local_weak_ptr<list_t> _list;
+	aux::local_weak_ptr<map_t> _map;
+	bool _is_list;
+	cell _offset;
+	expression_ptr _expr;
+
+	// sorted by key, and by position for equal keys
+	std::vector<entry> _entries;
+	// the elements of a map at each position, or null if removed since
+	std::vector<const map_t::value_type*> _map_elements;
+	std::unordered_map<const map_t::value_type*, size_t> _map_slots;
+	size_t _map_holes = 0;
+	size_t _source_size = 0;
+	unsigned int _modification = 0;
+	unsigned int _generation = 0;
+	bool _built = false;
+
+	bool make_key(const dyn_object &value, const dyn_object &element_key, dyn_object &key, expression::args_type &args, const expression::exec_info &info) const;
+	// produces the entries in the order of the source
+	void collect(AMX *amx, std::vector<entry> &entries);
+	// applies the recorded changes of the source, marking the positions to make keys for
+	bool apply_changes(const list_t &list, std::vector<bool> &dirty);
+	bool apply_changes(const map_t &map, std::vector<bool> &dirty);
+	// replaces the entries at the dirty positions, keeping the order
+	void merge_changed(AMX *amx, const std::vector<bool> &dirty);
+
+public:
+	index_t(const std::shared_ptr<list_t> &list, cell offset);
+	index_t(const std::shared_ptr<list_t> &list, expression_ptr &&expr);
+	index_t(const std::shared_ptr<map_t> &map, cell offset);
+	index_t(const std::shared_ptr<map_t> &map, expression_ptr &&expr);
+
+	bool expired() const;
+	// true if the entries reflect the current state of the source
+	bool is_current() const;
+	// brings the entries up to date, sorting only the changed ones
+	void update(AMX *amx);
+	// sorts all entries again
+	void rebuild(AMX *amx);
+
+	bool is_list() const
+	{
+		return _is_list;
+	}
+
+	size_t size() const
+	{
+		return _entries.size();
+	}
+
+	unsigned int get_generation() const
+	{
+		return _generation;
+	}
+
+	size_t lower_bound(const dyn_object &key) const;
+	size_t upper_bound(const dyn_object &key) const;
+
+	const entry &operator[](size_t index) const
+	{
+		return _entries[index];
+	}
+
+	dyn_object *get_value(size_t index) const;
+	std::pair<const dyn_object, dyn_object> *get_pair(size_t index) const;
+};
+
+// Read-only, since writing through it could change the order of the index
+class index_iterator_t : public dyn_iterator, public object_pool<dyn_iterator>::ref_container_virtual
+{
+	aux::local_weak_ptr<index_t> _source;
+	unsigned int _generation;
+	size_t _begin;
+	size_t _end;
+	size_t _position;
+
+	aux::local_lock<index_t> lock_same() const;
+
+public:
+	index_iterator_t(const std::shared_ptr<index_t> &source, size_t begin, size_t end);
+	index_iterator_t(const index_iterator_t &iter) = default;
+
+	virtual bool expired() const override;
+	virtual bool valid() const override;
+	virtual bool move_next() override;
+	virtual bool move_previous() override;
+	virtual bool set_to_first() override;
+	virtual bool set_to_last() override;
+	virtual bool reset() override;
+	virtual bool can_reset() const override;
+	virtual std::unique_ptr<dyn_iterator> clone() const override;
+	virtual std::shared_ptr<dyn_iterator> clone_shared() const override;
+	virtual size_t get_hash() const override;
+	virtual bool operator==(const dyn_iterator &obj) const override;
+	virtual bool extract_dyn(const std::type_info &type, void *value) const override;
+
+	virtual dyn_iterator *get() override
+	{
+		return this;
+	}
+
+	virtual const dyn_iterator *get() const override
+	{
+		return this;
+	}
+};
+
+extern aux::shared_id_set_pool<index_t> index_pool;
+
+#endif
@@ -315,7 +315,7 @@ std::shared_ptr<dyn_iterator> variant_iterator::clone_shared() const
 
 size_t variant_iterator::get_hash() const
 {
-	return std::hash<dyn_object*>()(&*var.lock());
+	return std::hash<dyn_object*>()(var.lock_local(is_main_thread).get());
 }
 
 bool variant_iterator::operator==(const repeat_base_iterator &obj) const
@@ -335,7 +335,9 @@ bool variant_iterator::extract_dyn(const std::type_info &type, void *value) cons
 {
 	if(index != -1)
 	{
-		if(auto obj = var.lock())
+		// copying the value may run user code, so the pair is made under a strong lock
+		bool copies = type == typeid(std::shared_ptr<const std::pair<const dyn_object, dyn_object>>);
+		if(auto obj = copies ? var.lock_strong() : var.lock_local(is_main_thread))
 		{
 			if(type == typeid(const dyn_object*))
 			{
@@ -343,7 +345,7 @@ bool variant_iterator::extract_dyn(const std::type_info &type, void *value) cons
 				return true;
 			}else if(type == typeid(std::shared_ptr<const dyn_object>))
 			{
-				*reinterpret_cast<std::shared_ptr<const dyn_object>*>(value) = obj;
+				*reinterpret_cast<std::shared_ptr<const dyn_object>*>(value) = var.lock();
 				return true;
 			}else if(type == typeid(dyn_modifiable_const_ptr<dyn_object>))
 			{
@@ -362,7 +364,7 @@ bool variant_iterator::extract_dyn(const std::type_info &type, void *value) cons
 
 bool handle_iterator::expired() const
 {
-	if(auto obj = handle.lock())
+	if(auto obj = handle.lock_local(is_main_thread))
 	{
 		return !obj->alive();
 	}
@@ -381,7 +383,7 @@ std::shared_ptr<dyn_iterator> handle_iterator::clone_shared() const
 
 size_t handle_iterator::get_hash() const
 {
-	return std::hash<handle_t*>()(&*handle.lock());
+	return std::hash<handle_t*>()(handle.lock_local(is_main_thread).get());
 }
 
 bool handle_iterator::operator==(const repeat_base_iterator &obj) const
@@ -401,7 +403,9 @@ bool handle_iterator::extract_dyn(const std::type_info &type, void *value) const
 {
 	if(index != -1)
 	{
-		if(auto obj = handle.lock())
+		// copying the value may run user code, so copies are made under a strong lock
+		bool copies = type != typeid(const dyn_object*);
+		if(auto obj = copies ? handle.lock_strong() : handle.lock_local(is_main_thread))
 		{
 			if(obj->alive())
 			{
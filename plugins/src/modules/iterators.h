@@ -91,7 +91,7 @@ public:
 
 class variant_iterator : public repeat_base_iterator
 {
-	std::weak_ptr<dyn_object> var;
+	aux::local_weak_ptr<dyn_object> var;
 
 public:
 	variant_iterator(const std::shared_ptr<dyn_object> &var, cell count) : repeat_base_iterator(count), var(var)
@@ -109,7 +109,7 @@ public:
 
 class handle_iterator : public repeat_base_iterator
 {
-	std::weak_ptr<handle_t> handle;
+	aux::local_weak_ptr<handle_t> handle;
 
 public:
 	handle_iterator(const std::shared_ptr<handle_t> &handle, cell count) : repeat_base_iterator(count), handle(handle)
@@ -155,6 +155,7 @@ public:
 template <class Func>
 auto value_write(dyn_iterator *iter, Func f) -> typename std::result_of<Func(dyn_object&)>::type
 {
+	iter->touch();
 	dyn_object *obj;
 	if(iter->extract(obj))
 	{
@@ -183,6 +184,7 @@ auto value_write(dyn_iterator *iter, Func f) -> typename std::result_of<Func(dyn
 template <class Func>
 auto value_modify(dyn_iterator *iter, Func f) -> typename std::result_of<Func(dyn_object&)>::type
 {
+	iter->touch();
 	dyn_object *obj;
 	if(iter->extract(obj))
 	{
@@ -0,0 +1,193 @@
+#include "leaks.h"
+#include "amxinfo.h"
+#include "modules/debug.h"
+#include "modules/strings.h"
+#include "modules/variants.h"
+#include "modules/containers.h"
+#include "modules/expressions.h"
+#include "modules/indexes.h"
+
+#include <unordered_map>
+#include <algorithm>
+#include <sstream>
+
+// the object table is cleared of destroyed objects when it grows over this
+static constexpr size_t min_prune_limit = 4096;
+
+bool leaks::tracking = false;
+AMX *leaks::current_amx = nullptr;
+
+struct leaks_extra : public amx::extra
+{
+	// the sites of the code addresses in the script
+	std::unordered_map<cell, uint32_t> sites;
+
+	leaks_extra(AMX *amx) : amx::extra(amx)
+	{
+
+	}
+};
+
+// the first site stands for all unknown ones
+static std::vector<leaks::site> sites{leaks::site{{}, {}, {}, 0, -1}};
+static std::unordered_map<cell, uint32_t> objects;
+static size_t prune_limit = min_prune_limit;
+
+static uint32_t intern_site(AMX *amx)
+{
+	// amx->cip points after the instruction calling the native
+	cell cip = amx->cip - 2 * sizeof(cell);
+	const auto &obj = amx::load_lock(amx);
+	auto &extra = obj->get_extra<leaks_extra>();
+	auto it = extra.sites.find(cip);
+	if(it != extra.sites.end())
+	{
+		return it->second;
+	}
+
+	leaks::site site{obj->name, {}, {}, cip, -1};
+	AMX_DBG *dbg = obj->dbg.get();
+	if(dbg)
+	{
+		const char *filename;
+		if(dbg_LookupFile(dbg, cip, &filename) == AMX_ERR_NONE)
+		{
+			site.file = filename;
+		}
+		long line;
+		if(dbg_LookupLine(dbg, cip, &line) == AMX_ERR_NONE)
+		{
+			site.line = line;
+		}
+		cell index = debug::get_symbols(dbg).find_function(cip, cip + 1);
+		if(index != -1)
+		{
+			site.function = dbg->symboltbl[index]->name;
+		}
+	}
+	auto id = static_cast<uint32_t>(sites.size());
+	sites.push_back(std::move(site));
+	extra.sites.emplace(cip, id);
+	return id;
+}
+
+template <class Func>
+static void for_each_pool(Func func)
+{
+	for(cell i = 0; i < static_cast<cell>(memory::pool_type::tasks); i++)
+	{
+		func(static_cast<memory::pool_type>(i));
+	}
+}
+
+static void prune()
+{
+	std::unordered_map<cell, uint32_t> live;
+	for_each_pool([&](memory::pool_type type)
+	{
+		memory::for_each_object(type, false, [&](cell id, size_t bytes)
+		{
+			auto it = objects.find(id);
+			if(it != objects.end())
+			{
+				live.emplace(id, it->second);
+			}
+		});
+	});
+	objects.swap(live);
+	prune_limit = std::max(objects.size() * 2, min_prune_limit);
+}
+
+namespace leaks
+{
+	void record(const void *obj)
+	{
+		if(objects.size() >= prune_limit)
+		{
+			prune();
+		}
+		objects[reinterpret_cast<cell>(obj)] = current_amx ? intern_site(current_amx) : 0;
+	}
+
+	void enable(bool enable)
+	{
+		tracking = enable;
+		memory::update_observers();
+	}
+
+	void reset()
+	{
+		objects.clear();
+		prune_limit = min_prune_limit;
+	}
+
+	const site &get_site(size_t id)
+	{
+		if(id >= sites.size())
+		{
+			return sites[0];
+		}
+		return sites[id];
+	}
+
+	std::vector<group> collect()
+	{
+		std::vector<group> groups;
+		std::unordered_map<uint32_t, size_t> indices;
+		for_each_pool([&](memory::pool_type type)
+		{
+			indices.clear();
+			memory::for_each_object(type, true, [&](cell id, size_t bytes)
+			{
+				auto it = objects.find(id);
+				uint32_t site = it != objects.end() ? it->second : 0;
+				auto result = indices.emplace(site, groups.size());
+				if(result.second)
+				{
+					groups.emplace_back(site, type);
+				}
+				auto &group = groups[result.first->second];
+				group.objects++;
+				group.bytes += bytes;
+			});
+		});
+		std::sort(groups.begin(), groups.end(), [](const group &a, const group &b)
+		{
+			return a.bytes > b.bytes;
+		});
+		return groups;
+	}
+
+	std::string describe(size_t id)
+	{
+		if(id == 0 || id >= sites.size())
+		{
+			return "unknown site";
+		}
+		const auto &site = sites[id];
+		std::ostringstream stream;
+		if(!site.file.empty())
+		{
+			stream << site.file << ":" << site.line;
+		}else{
+			stream << "0x" << std::hex << site.cip << std::dec;
+		}
+		if(!site.function.empty())
+		{
+			stream << " in " << site.function;
+		}
+		if(!site.script.empty())
+		{
+			stream << " (" << site.script << ")";
+		}
+		return stream.str();
+	}
+
+	void write_report(std::ostream &stream)
+	{
+		for(const auto &group : collect())
+		{
+			stream << group.bytes << " bytes in " << group.objects << " " << memory::pool_name(group.pool) << " from " << describe(group.site) << std::endl;
+		}
+	}
+}
@@ -0,0 +1,85 @@
+#ifndef LEAKS_H_INCLUDED
+#define LEAKS_H_INCLUDED
+
+#include "main.h"
+#include "modules/memory.h"
+#include "sdk/amx/amx.h"
+#include <string>
+#include <vector>
+#include <ostream>
+
+namespace leaks
+{
+	// Records the site where every pooled object was created, to find the
+	// origin of objects that are never freed. Sites are interned per script
+	// and code address, so a tracked object costs only one table entry.
+	struct site
+	{
+		std::string script;
+		std::string file;
+		std::string function;
+		cell cip;
+		long line;
+	};
+
+	struct group
+	{
+		// 0 for objects created outside a native call or before tracking was enabled
+		size_t site;
+		memory::pool_type pool;
+		size_t objects = 0;
+		size_t bytes = 0;
+
+		group(size_t site, memory::pool_type pool) : site(site), pool(pool)
+		{
+
+		}
+	};
+
+	// changed only through enable
+	extern bool tracking;
+	extern AMX *current_amx;
+
+	void enable(bool enable);
+	// called by the memory module with every object created on the main thread
+	void record(const void *obj);
+	// forgets the sites of all objects created so far
+	void reset();
+	const site &get_site(size_t id);
+	// the file, line, function and script of the site
+	std::string describe(size_t id);
+	// groups the acquired objects and all containers by their site, sorted by size
+	std::vector<group> collect();
+	void write_report(std::ostream &stream);
+
+	// makes the script the source of the objects created until the end of the scope,
+	// for leak tracking and for the memory usage of scripts
+	class scope
+	{
+		AMX *previous;
+		bool active;
+
+	public:
+		scope(AMX *amx) : active((tracking || memory::tracking) && is_main_thread)
+		{
+			if(active)
+			{
+				previous = current_amx;
+				current_amx = amx;
+			}
+		}
+
+		scope(const scope&) = delete;
+		scope &operator=(const scope&) = delete;
+
+		~scope()
+		{
+			if(active)
+			{
+				current_amx = previous;
+			}
+		}
+	};
+}
+
+#endif
@@ -0,0 +1,459 @@
+#include "memory.h"
+#include "modules/containers.h"
+#include "modules/strings.h"
+#include "modules/variants.h"
+#include "modules/expressions.h"
+#include "modules/indexes.h"
+#include "modules/tasks.h"
+#include "modules/regex.h"
+#include "modules/leaks.h"
+
+#include <array>
+#include <unordered_map>
+#include <unordered_set>
+
+// estimated bookkeeping of a node in a linked list, a tree or a hash table
+static constexpr size_t node_overhead = 4 * sizeof(void*);
+
+bool memory::tracking = false;
+
+typedef std::array<memory::usage, static_cast<size_t>(memory::pool_type::count)> usage_table;
+
+struct tracked_object
+{
+	memory::pool_type type;
+	AMX *owner;
+	// the estimate made when the object was last measured
+	size_t bytes;
+	size_t(*measure)(const void *obj);
+};
+
+static usage_table pool_usage;
+static std::unordered_map<AMX*, usage_table> script_usage;
+static std::unordered_map<const void*, tracked_object> objects;
+// objects obtained by their ID since they were last measured
+static std::unordered_set<const void*> accessed_objects;
+
+static size_t object_bytes(const dyn_object &obj)
+{
+	return sizeof(dyn_object) + obj.heap_size();
+}
+
+static size_t string_bytes(const strings::cell_string &str)
+{
+	return sizeof(str) + (str.capacity() + 1) * sizeof(cell);
+}
+
+static size_t list_bytes(const list_t &list)
+{
+	if(list.is_typed())
+	{
+		return sizeof(list_t) + list.capacity() * sizeof(cell);
+	}
+	size_t bytes = sizeof(list_t) + list.capacity() * sizeof(dyn_object);
+	for(auto it = list.cbegin(); it != list.cend(); ++it)
+	{
+		bytes += it->heap_size();
+	}
+	return bytes;
+}
+
+static size_t linked_list_bytes(const linked_list_t &list)
+{
+	size_t bytes = sizeof(linked_list_t);
+	for(auto it = list.cbegin(); it != list.cend(); ++it)
+	{
+		bytes += node_overhead + object_bytes(*it);
+	}
+	return bytes;
+}
+
+static size_t map_bytes(const map_t &map)
+{
+	size_t bytes = sizeof(map_t);
+	for(auto it = map.cbegin(); it != map.cend(); ++it)
+	{
+		bytes += node_overhead + object_bytes(it->first) + object_bytes(it->second);
+	}
+	return bytes;
+}
+
+static size_t pool_bytes(pool_t &pool)
+{
+	// size is the number of slots, including the free ones
+	size_t bytes = sizeof(pool_t) + pool.size() * sizeof(dyn_object);
+	for(auto it = pool.begin(); it != pool.end(); ++it)
+	{
+		bytes += it->heap_size();
+	}
+	return bytes;
+}
+
+static size_t bitset_bytes(const bitset_t &set)
+{
+	return sizeof(bitset_t) + set.allocated();
+}
+
+static size_t index_bytes(const index_t &index)
+{
+	size_t bytes = sizeof(index_t);
+	for(size_t i = 0; i < index.size(); i++)
+	{
+		bytes += sizeof(index_t::entry) + index[i].key.heap_size();
+	}
+	return bytes;
+}
+
+// only the base objects, since the actual types are not known
+static size_t iterator_bytes(const dyn_iterator&)
+{
+	return sizeof(dyn_iterator);
+}
+
+static size_t handle_bytes(const handle_t&)
+{
+	return sizeof(handle_t);
+}
+
+static size_t expression_bytes(const expression&)
+{
+	return sizeof(expression);
+}
+
+// calls visitor(id, bytes) for every object in the pool
+template <class Pool, class Func, class Visitor>
+static void visit_pool(Pool &pool, Func func, bool global_only, Visitor visitor)
+{
+	for(const auto &pair : pool)
+	{
+		visitor(pool.get_id(pair.second), func(*pair.second));
+	}
+}
+
+template <class ObjType, class Func, class Visitor>
+static void visit_pool(object_pool<ObjType> &pool, Func func, bool global_only, Visitor visitor)
+{
+	pool.for_each([&](const typename object_pool<ObjType>::ref_container &obj)
+	{
+		visitor(pool.get_id(obj), func(*obj));
+	}, global_only);
+}
+
+template <class Visitor>
+static void visit_objects(memory::pool_type type, bool global_only, Visitor visitor)
+{
+	switch(type)
+	{
+		case memory::pool_type::strings:
+			visit_pool(strings::pool, string_bytes, global_only, visitor);
+			break;
+		case memory::pool_type::variants:
+			visit_pool(variants::pool, object_bytes, global_only, visitor);
+			break;
+		case memory::pool_type::lists:
+			visit_pool(list_pool, list_bytes, global_only, visitor);
+			break;
+		case memory::pool_type::linked_lists:
+			visit_pool(linked_list_pool, linked_list_bytes, global_only, visitor);
+			break;
+		case memory::pool_type::maps:
+			visit_pool(map_pool, map_bytes, global_only, visitor);
+			break;
+		case memory::pool_type::pools:
+			visit_pool(pool_pool, pool_bytes, global_only, visitor);
+			break;
+		case memory::pool_type::bitsets:
+			visit_pool(bitset_pool, bitset_bytes, global_only, visitor);
+			break;
+		case memory::pool_type::indexes:
+			visit_pool(index_pool, index_bytes, global_only, visitor);
+			break;
+		case memory::pool_type::iterators:
+			visit_pool(iter_pool, iterator_bytes, global_only, visitor);
+			break;
+		case memory::pool_type::handles:
+			visit_pool(handle_pool, handle_bytes, global_only, visitor);
+			break;
+		case memory::pool_type::expressions:
+			visit_pool(expression_pool, expression_bytes, global_only, visitor);
+			break;
+		default:
+			break;
+	}
+}
+
+static memory::usage &get_usage(memory::pool_type type)
+{
+	return pool_usage[static_cast<size_t>(type)];
+}
+
+static void add_object(memory::usage &usage, size_t bytes)
+{
+	usage.objects++;
+	usage.bytes += bytes;
+	if(usage.bytes > usage.peak)
+	{
+		usage.peak = usage.bytes;
+	}
+}
+
+static void remove_object(memory::usage &usage, size_t bytes)
+{
+	usage.objects--;
+	usage.bytes -= bytes;
+}
+
+static void resize_object(memory::usage &usage, size_t old_bytes, size_t new_bytes)
+{
+	usage.bytes = usage.bytes - old_bytes + new_bytes;
+	if(usage.bytes > usage.peak)
+	{
+		usage.peak = usage.bytes;
+	}
+}
+
+// measures again the objects that could have been modified since the last call
+static void measure_accessed()
+{
+	for(const void *obj : accessed_objects)
+	{
+		auto it = objects.find(obj);
+		if(it == objects.end())
+		{
+			continue;
+		}
+		auto &info = it->second;
+		size_t bytes = info.measure(obj);
+		if(bytes != info.bytes)
+		{
+			resize_object(get_usage(info.type), info.bytes, bytes);
+			resize_object(script_usage[info.owner][static_cast<size_t>(info.type)], info.bytes, bytes);
+			info.bytes = bytes;
+		}
+	}
+	accessed_objects.clear();
+}
+
+static void object_accessed(const void *obj)
+{
+	if(is_main_thread)
+	{
+		accessed_objects.insert(obj);
+	}
+}
+
+static void object_created(memory::pool_type type, const void *obj, size_t(*measure)(const void *obj))
+{
+	if(!is_main_thread)
+	{
+		return;
+	}
+	if(leaks::tracking)
+	{
+		leaks::record(obj);
+	}
+	if(memory::tracking)
+	{
+		AMX *owner = leaks::current_amx;
+		size_t bytes = measure(obj);
+		auto result = objects.emplace(obj, tracked_object{type, owner, bytes, measure});
+		if(!result.second)
+		{
+			// the address was reused by an object whose removal was not seen
+			auto &old = result.first->second;
+			remove_object(get_usage(old.type), old.bytes);
+			remove_object(script_usage[old.owner][static_cast<size_t>(old.type)], old.bytes);
+			old = tracked_object{type, owner, bytes, measure};
+		}
+		add_object(get_usage(type), bytes);
+		add_object(script_usage[owner][static_cast<size_t>(type)], bytes);
+	}
+}
+
+static void object_destroyed(const void *obj)
+{
+	if(!is_main_thread)
+	{
+		return;
+	}
+	auto it = objects.find(obj);
+	if(it != objects.end())
+	{
+		const auto &info = it->second;
+		remove_object(get_usage(info.type), info.bytes);
+		remove_object(script_usage[info.owner][static_cast<size_t>(info.type)], info.bytes);
+		objects.erase(it);
+		accessed_objects.erase(obj);
+	}
+}
+
+template <memory::pool_type Type, class Arg, size_t(*Bytes)(Arg&), class Obj>
+static void observe(aux::shared_id_set_pool<Obj> &pool, bool enable)
+{
+	pool.set_observer(enable ? +[](const void *obj)
+	{
+		object_created(Type, obj, [](const void *obj)
+		{
+			return Bytes(*static_cast<Obj*>(const_cast<void*>(obj)));
+		});
+	} : nullptr);
+	pool.set_remove_observer(enable && memory::tracking ? &object_destroyed : nullptr);
+	pool.set_access_observer(enable && memory::tracking ? &object_accessed : nullptr);
+}
+
+template <memory::pool_type Type, class Arg, size_t(*Bytes)(Arg&), class Obj>
+static void observe(object_pool<Obj> &pool, bool enable)
+{
+	pool.set_observer(enable ? +[](const void *obj)
+	{
+		object_created(Type, obj, [](const void *obj)
+		{
+			return Bytes(**static_cast<const typename object_pool<Obj>::ref_container*>(obj));
+		});
+	} : nullptr);
+	pool.set_remove_observer(enable && memory::tracking ? &object_destroyed : nullptr);
+	pool.set_access_observer(enable && memory::tracking ? &object_accessed : nullptr);
+}
+
+namespace memory
+{
+	const char *pool_name(pool_type type)
+	{
+		static const char *names[] = {
+			"strings",
+			"variants",
+			"lists",
+			"linked_lists",
+			"maps",
+			"pools",
+			"bitsets",
+			"indexes",
+			"iterators",
+			"handles",
+			"expressions",
+			"tasks",
+			"regex_cache"
+		};
+		if(static_cast<size_t>(type) >= sizeof(names) / sizeof(*names))
+		{
+			return nullptr;
+		}
+		return names[static_cast<size_t>(type)];
+	}
+
+	void enable(bool enable)
+	{
+		tracking = enable;
+		objects.clear();
+		accessed_objects.clear();
+		script_usage.clear();
+		for(cell i = 0; i < static_cast<cell>(pool_type::tasks); i++)
+		{
+			get_usage(static_cast<pool_type>(i)) = usage();
+		}
+		update_observers();
+	}
+
+	void update_observers()
+	{
+		bool enable = tracking || leaks::tracking;
+		observe<pool_type::strings, const strings::cell_string, string_bytes>(strings::pool, enable);
+		observe<pool_type::variants, const dyn_object, object_bytes>(variants::pool, enable);
+		observe<pool_type::lists, const list_t, list_bytes>(list_pool, enable);
+		observe<pool_type::linked_lists, const linked_list_t, linked_list_bytes>(linked_list_pool, enable);
+		observe<pool_type::maps, const map_t, map_bytes>(map_pool, enable);
+		observe<pool_type::pools, pool_t, pool_bytes>(pool_pool, enable);
+		observe<pool_type::bitsets, const bitset_t, bitset_bytes>(bitset_pool, enable);
+		observe<pool_type::indexes, const index_t, index_bytes>(index_pool, enable);
+		observe<pool_type::iterators, const dyn_iterator, iterator_bytes>(iter_pool, enable);
+		observe<pool_type::handles, const handle_t, handle_bytes>(handle_pool, enable);
+		observe<pool_type::expressions, const expression, expression_bytes>(expression_pool, enable);
+	}
+
+	void update()
+	{
+		measure_accessed();
+	}
+
+	void unload(AMX *amx)
+	{
+		if(amx == nullptr || script_usage.find(amx) == script_usage.end())
+		{
+			return;
+		}
+		auto &unowned = script_usage[nullptr];
+		const auto &owned = script_usage[amx];
+		for(size_t i = 0; i < unowned.size(); i++)
+		{
+			auto &usage = unowned[i];
+			usage.objects += owned[i].objects;
+			usage.bytes += owned[i].bytes;
+			if(usage.bytes > usage.peak)
+			{
+				usage.peak = usage.bytes;
+			}
+		}
+		script_usage.erase(amx);
+		for(auto &pair : objects)
+		{
+			if(pair.second.owner == amx)
+			{
+				pair.second.owner = nullptr;
+			}
+		}
+	}
+
+	void for_each_object(pool_type type, bool global_only, const std::function<void(cell id, size_t bytes)> &func)
+	{
+		visit_objects(type, global_only, func);
+	}
+
+	const usage &get(pool_type type)
+	{
+		measure_accessed();
+		auto &usage = get_usage(type);
+		if(type == pool_type::tasks)
+		{
+			usage.objects = tasks::size();
+			usage.bytes = tasks::memory_usage();
+		}else if(type == pool_type::regex_cache)
+		{
+			usage.objects = strings::regex_cache_size(usage.bytes);
+		}else{
+			return usage;
+		}
+		if(usage.bytes > usage.peak)
+		{
+			usage.peak = usage.bytes;
+		}
+		return usage;
+	}
+
+	const usage &get(AMX *amx, pool_type type)
+	{
+		static const usage empty;
+		measure_accessed();
+		auto it = script_usage.find(amx);
+		if(it == script_usage.end() || type >= pool_type::tasks)
+		{
+			return empty;
+		}
+		return it->second[static_cast<size_t>(type)];
+	}
+
+	void reset_peaks()
+	{
+		measure_accessed();
+		for(auto &usage : pool_usage)
+		{
+			usage.peak = usage.bytes;
+		}
+		for(auto &pair : script_usage)
+		{
+			for(auto &usage : pair.second)
+			{
+				usage.peak = usage.bytes;
+			}
+		}
+	}
+}
@@ -0,0 +1,64 @@
+#ifndef MEMORY_H_INCLUDED
+#define MEMORY_H_INCLUDED
+
+#include "sdk/amx/amx.h"
+#include <stddef.h>
+#include <functional>
+
+namespace memory
+{
+	// Estimates of the memory used by the objects in the pools. While tracking is
+	// enabled, objects are counted when they are created and destroyed, and are
+	// attributed to the script whose native call created them. The size of an
+	// object is estimated when it is created, and again on the next update or
+	// query after it was obtained by its ID, so the growth of containers and
+	// strings is followed. Objects left by an unloaded script are attributed to
+	// no script.
+	enum class pool_type : cell
+	{
+		strings,
+		variants,
+		lists,
+		linked_lists,
+		maps,
+		pools,
+		bitsets,
+		indexes,
+		iterators,
+		handles,
+		expressions,
+		tasks,
+		regex_cache,
+		count
+	};
+
+	struct usage
+	{
+		size_t objects = 0;
+		size_t bytes = 0;
+		size_t peak = 0;
+	};
+
+	// changed only through enable
+	extern bool tracking;
+
+	const char *pool_name(pool_type type);
+	// starts counting anew, or stops counting and forgets all objects
+	void enable(bool enable);
+	// installs the pool observers needed by memory and leak tracking
+	void update_observers();
+	// measures again the objects obtained by their ID since the last update
+	void update();
+	// moves the usage of the script to no script, before the script is unloaded
+	void unload(AMX *amx);
+	// calls func with the ID and size of every object in the pool, or only of the
+	// acquired ones if global_only; tasks and the regex cache are not visited
+	void for_each_object(pool_type type, bool global_only, const std::function<void(cell id, size_t bytes)> &func);
+	// the objects in the pool; tasks and the regex cache are measured on every call
+	const usage &get(pool_type type);
+	// the objects in the pool created by the script
+	const usage &get(AMX *amx, pool_type type);
+	void reset_peaks();
+}
+
+#endif
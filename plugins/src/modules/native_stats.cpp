@@ -0,0 +1,73 @@
+#include "native_stats.h"
+#include "utils/bit_set.h"
+
+#include <unordered_map>
+#include <algorithm>
+
+bool native_stats::enabled = false;
+
+static std::vector<native_stats::entry> &entries()
+{
+	static std::vector<native_stats::entry> list;
+	return list;
+}
+
+size_t native_stats::add(const char *name)
+{
+	auto &list = entries();
+	list.emplace_back(name, false);
+	return list.size() - 1;
+}
+
+size_t native_stats::add_hooked(const std::string &name)
+{
+	// a native can be hooked and unhooked many times
+	static std::unordered_map<std::string, size_t> hooked;
+	auto it = hooked.find(name);
+	if(it != hooked.end())
+	{
+		return it->second;
+	}
+	auto &list = entries();
+	list.emplace_back(name, true);
+	size_t index = list.size() - 1;
+	hooked.emplace(name, index);
+	return index;
+}
+
+static size_t bucket(long long duration)
+{
+	if(duration <= 0)
+	{
+		return 0;
+	}
+	return std::min(aux::highest_bit(static_cast<std::uint64_t>(duration)), native_stats::histogram_size - 1);
+}
+
+void native_stats::record(size_t index, long long duration)
+{
+	auto &stats = entries()[index];
+	stats.calls++;
+	stats.total += duration;
+	if(duration > stats.max)
+	{
+		stats.max = duration;
+	}
+	stats.histogram[bucket(duration)]++;
+}
+
+void native_stats::reset()
+{
+	for(auto &stats : entries())
+	{
+		stats.calls = 0;
+		stats.total = 0;
+		stats.max = 0;
+		stats.histogram.fill(0);
+	}
+}
+
+const std::vector<native_stats::entry> &native_stats::get()
+{
+	return entries();
+}
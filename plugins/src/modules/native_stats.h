@@ -0,0 +1,72 @@
+#ifndef NATIVE_STATS_H_INCLUDED
+#define NATIVE_STATS_H_INCLUDED
+
+#include "main.h"
+#include <string>
+#include <vector>
+#include <array>
+#include <chrono>
+
+namespace native_stats
+{
+	// calls are sorted into buckets by the binary logarithm of their duration in nanoseconds
+	constexpr size_t histogram_size = 32;
+
+	struct entry
+	{
+		std::string name;
+		// the native is hooked from a script, not provided by the plugin
+		bool hooked;
+		long long calls = 0;
+		// durations in nanoseconds
+		long long total = 0;
+		long long max = 0;
+		std::array<long long, histogram_size> histogram{};
+
+		entry(std::string name, bool hooked) : name(std::move(name)), hooked(hooked)
+		{
+
+		}
+	};
+
+	typedef std::chrono::steady_clock clock;
+
+	extern bool enabled;
+
+	// returns the index of the entry for the native
+	size_t add(const char *name);
+	size_t add_hooked(const std::string &name);
+	void record(size_t index, long long duration);
+	void reset();
+	const std::vector<entry> &get();
+
+	// measures the time until the end of the scope, only on the main thread
+	class scope
+	{
+		size_t index;
+		bool active;
+		clock::time_point start;
+
+	public:
+		scope(size_t index) : index(index), active(enabled && is_main_thread)
+		{
+			if(active)
+			{
+				start = clock::now();
+			}
+		}
+
+		scope(const scope&) = delete;
+		scope &operator=(const scope&) = delete;
+
+		~scope()
+		{
+			if(active)
+			{
+				record(index, std::chrono::duration_cast<std::chrono::nanoseconds>(clock::now() - start).count());
+			}
+		}
+	};
+}
+
+#endif
@@ -4,6 +4,7 @@
 #include "errors.h"
 #include "modules/expressions.h"
 #include "amxinfo.h"
+#include "modules/debug.h"
 #include "sdk/amx/amx.h"
 #include "sdk/amx/amxdbg.h"
 #include <string>
@@ -638,24 +639,16 @@ private:
 							if(options & parser_options::allow_debug_symbols)
 							{
 								AMX_DBG_SYMBOL *minsym = nullptr;
-								auto obj = amx::load_lock(amx);
+								const auto &obj = amx::load_lock(amx);
 								auto dbg = obj->dbg.get();
 								if(dbg)
 								{
-									ucell cip = amx->cip - 2 * sizeof(cell);;
+									ucell cip = amx->cip - 2 * sizeof(cell);
 
-									ucell mindist;
-									for(uint16_t i = 0; i < dbg->hdr->symbols; i++)
+									cell index = debug::get_symbols(dbg).find_symbol(symbol.c_str(), cip);
+									if(index != -1)
 									{
-										auto sym = dbg->symboltbl[i];
-										if((sym->ident == iFUNCTN || (sym->codestart <= cip && sym->codeend > cip)) && !std::strcmp(sym->name, symbol.c_str()))
-										{
-											if(minsym == nullptr || sym->codeend - sym->codestart < mindist)
-											{
-												minsym = sym;
-												mindist = sym->codeend - sym->codestart;
-											}
-										}
+										minsym = dbg->symboltbl[index];
 									}
 								}
 								if(minsym)
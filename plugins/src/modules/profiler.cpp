@@ -0,0 +1,221 @@
+#include "profiler.h"
+#include "amxinfo.h"
+#include "exec.h"
+#include "modules/debug.h"
+
+#include <algorithm>
+#include <unordered_set>
+
+static constexpr size_t max_stack_depth = 128;
+
+static int AMXAPI amx_on_profile(AMX *amx);
+
+struct profiler_extra : public amx::extra
+{
+	// the hook that was installed before the profiler
+	AMX_DEBUG next = nullptr;
+	// the hook is in the chain of amx_get_debug_hook
+	bool installed = false;
+	bool running = false;
+	cell interval = 1;
+	cell countdown = 1;
+	size_t samples = 0;
+	profiler::stack_map stacks;
+	std::vector<cell> stack;
+
+	profiler_extra(AMX *amx) : amx::extra(amx)
+	{
+
+	}
+
+	virtual std::unique_ptr<extra> clone() override
+	{
+		// the hook is copied to the new AMX, so it must still find the next one
+		auto copy = new profiler_extra(_amx);
+		copy->next = next;
+		copy->installed = installed;
+		return std::unique_ptr<extra>(copy);
+	}
+
+	void sample(AMX *amx, const AMX_DBG *dbg)
+	{
+		const auto &symbols = debug::get_symbols(dbg);
+		auto data = amx_GetData(amx);
+
+		stack.clear();
+		ucell cip = amx->cip;
+		ucell frm = amx->frm;
+		while(true)
+		{
+			stack.push_back(symbols.find_function(cip, cip + 1));
+			if(frm == 0 || frm >= static_cast<ucell>(amx->stp) || stack.size() >= max_stack_depth)
+			{
+				break;
+			}
+			auto frame = reinterpret_cast<cell*>(data + frm);
+			cip = frame[1];
+			frm = frame[0];
+			if(cip == 0)
+			{
+				break;
+			}
+		}
+		std::reverse(stack.begin(), stack.end());
+		stacks[stack]++;
+		samples++;
+	}
+};
+
+static int AMXAPI amx_on_profile(AMX *amx)
+{
+	const auto &obj = amx::load_lock(amx);
+	auto &extra = obj->get_extra<profiler_extra>();
+	if(extra.running && --extra.countdown <= 0)
+	{
+		extra.countdown = extra.interval;
+		if(obj->dbg)
+		{
+			extra.sample(amx, obj->dbg.get());
+		}
+	}
+	if(extra.next)
+	{
+		return extra.next(amx);
+	}
+	return AMX_ERR_NONE;
+}
+
+namespace profiler
+{
+	bool start(AMX *amx, cell interval)
+	{
+		const auto &obj = amx::load_lock(amx);
+		if(!obj->dbg)
+		{
+			return false;
+		}
+		auto &extra = obj->get_extra<profiler_extra>();
+		if(!extra.installed)
+		{
+			// in a parallel section, the hook is placed under the one of the section, which restores it afterwards
+			extra.next = amx_get_debug_hook(amx);
+			extra.installed = true;
+			amx_set_debug_hook(amx, amx_on_profile);
+		}
+		extra.interval = extra.countdown = std::max(interval, static_cast<cell>(1));
+		extra.running = true;
+		return true;
+	}
+
+	bool stop(AMX *amx)
+	{
+		const auto &obj = amx::load_lock(amx);
+		if(!obj->has_extra<profiler_extra>())
+		{
+			return false;
+		}
+		auto &extra = obj->get_extra<profiler_extra>();
+		if(!extra.running)
+		{
+			return false;
+		}
+		extra.running = false;
+		if(amx_get_debug_hook(amx) == amx_on_profile)
+		{
+			amx_set_debug_hook(amx, extra.next);
+			extra.next = nullptr;
+			extra.installed = false;
+		}
+		// otherwise another hook was installed over this one and still calls it
+		return true;
+	}
+
+	bool running(AMX *amx)
+	{
+		const auto &obj = amx::load_lock(amx);
+		return obj->has_extra<profiler_extra>() && obj->get_extra<profiler_extra>().running;
+	}
+
+	void reset(AMX *amx)
+	{
+		const auto &obj = amx::load_lock(amx);
+		if(obj->has_extra<profiler_extra>())
+		{
+			auto &extra = obj->get_extra<profiler_extra>();
+			extra.stacks.clear();
+			extra.samples = 0;
+		}
+	}
+
+	size_t num_samples(AMX *amx)
+	{
+		const auto &obj = amx::load_lock(amx);
+		return obj->get_extra<profiler_extra>().samples;
+	}
+
+	const stack_map &get_stacks(AMX *amx)
+	{
+		const auto &obj = amx::load_lock(amx);
+		return obj->get_extra<profiler_extra>().stacks;
+	}
+
+	static const char *function_name(const AMX_DBG *dbg, cell index)
+	{
+		if(!dbg || index < 0)
+		{
+			return "?";
+		}
+		return dbg->symboltbl[index]->name;
+	}
+
+	std::map<std::string, function_stats> get_functions(AMX *amx)
+	{
+		const auto &obj = amx::load_lock(amx);
+		const AMX_DBG *dbg = obj->dbg.get();
+
+		std::map<std::string, function_stats> result;
+		std::unordered_set<std::string> seen;
+		for(const auto &pair : obj->get_extra<profiler_extra>().stacks)
+		{
+			const auto &stack = pair.first;
+			if(stack.empty())
+			{
+				continue;
+			}
+			result[function_name(dbg, stack.back())].self += pair.second;
+
+			// recursive calls are counted only once in the total
+			seen.clear();
+			for(cell index : stack)
+			{
+				const char *name = function_name(dbg, index);
+				if(seen.insert(name).second)
+				{
+					result[name].total += pair.second;
+				}
+			}
+		}
+		return result;
+	}
+
+	void write_collapsed(AMX *amx, std::ostream &stream)
+	{
+		const auto &obj = amx::load_lock(amx);
+		const AMX_DBG *dbg = obj->dbg.get();
+
+		for(const auto &pair : obj->get_extra<profiler_extra>().stacks)
+		{
+			bool first = true;
+			for(cell index : pair.first)
+			{
+				if(!first)
+				{
+					stream << ';';
+				}
+				first = false;
+				stream << function_name(dbg, index);
+			}
+			stream << ' ' << pair.second << '\n';
+		}
+	}
+}
@@ -0,0 +1,38 @@
+#ifndef PROFILER_H_INCLUDED
+#define PROFILER_H_INCLUDED
+
+#include "sdk/amx/amx.h"
+#include <map>
+#include <vector>
+#include <string>
+#include <ostream>
+
+namespace profiler
+{
+	// Samples the call stack of the running code from the debug hook of the script.
+	// A stack is stored as a sequence of function symbol indices starting from the
+	// outermost function, with -1 for code outside of any known function.
+	typedef std::map<std::vector<cell>, size_t> stack_map;
+
+	struct function_stats
+	{
+		// samples taken directly in the function
+		size_t self = 0;
+		// samples taken in the function or any function it called
+		size_t total = 0;
+	};
+
+	// takes a sample every interval calls of the debug hook; the script must have debug info
+	bool start(AMX *amx, cell interval);
+	bool stop(AMX *amx);
+	bool running(AMX *amx);
+	void reset(AMX *amx);
+	size_t num_samples(AMX *amx);
+	const stack_map &get_stacks(AMX *amx);
+	// functions with the same name are merged
+	std::map<std::string, function_stats> get_functions(AMX *amx);
+	// writes every stack as a line of function names separated by ';' and the number of its samples
+	void write_collapsed(AMX *amx, std::ostream &stream);
+}
+
+#endif
@@ -346,6 +346,16 @@ static const cell_regex &get_cached(const cell_string &pattern, cell options, st
 	return regex_cache.emplace(std::piecewise_construct, std::forward_as_tuple(pattern, options), std::forward_as_tuple(pattern, syntax_options)).first->second;
 }
 
+size_t strings::regex_cache_size(size_t &bytes)
+{
+	bytes = 0;
+	for(const auto &pair : regex_cache)
+	{
+		bytes += sizeof(pair) + pair.first.first.capacity() * sizeof(cell);
+	}
+	return regex_cache.size();
+}
+
 template <class Iter>
 static const cell_regex &get_cached(Iter pattern_begin, Iter pattern_end, const cell_string *pattern, cell options, std::regex_constants::syntax_option_type syntax_options)
 {
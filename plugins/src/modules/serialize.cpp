@@ -4,6 +4,18 @@
 #include "modules/variants.h"
 #include "modules/strings.h"
 
+#include <cstdio>
+#include <cstring>
+#include <string>
+#include <unordered_map>
+#include <algorithm>
+
+#ifdef _WIN32
+#define WIN32_LEAN_AND_MEAN
+#define NOMINMAX
+#include <windows.h>
+#endif
+
 bool serialize_value(cell value, tag_ptr tag, void(*binary_writer)(void*, const char*, cell), void *binary_writer_cookie, void(*object_writer)(void*, const void*), void *object_writer_cookie)
 {
 	switch(tag->find_top_base()->uid)
@@ -151,3 +163,882 @@ bool deserialize_value(cell &value, tag_ptr tag, cell(*binary_reader)(void*, cha
 	}
 	return false;
 }
+
+namespace serialize
+{
+	static const char format_magic[4] = {'P', 'P', 'B', 'F'};
+	static constexpr unsigned char format_version = 1;
+	// the files are written and read in chunks of this size, one system call each
+	static constexpr size_t chunk_size = 65536;
+	// the deepest nesting of objects that can be stored
+	static constexpr size_t max_depth = 256;
+
+	enum class value_kind : unsigned char
+	{
+		null,
+		cell,
+		array
+	};
+
+	enum class object_kind : unsigned char
+	{
+		// an invalid handle stored as its value
+		none,
+		// an object stored earlier
+		reference,
+		string,
+		variant,
+		list,
+		map,
+		linked_list,
+		pool
+	};
+
+	bool is_handle(tag_ptr tag)
+	{
+		switch(tag->find_top_base()->uid)
+		{
+			case tags::tag_string:
+			case tags::tag_variant:
+			case tags::tag_list:
+			case tags::tag_map:
+			case tags::tag_iter:
+			case tags::tag_task:
+			case tags::tag_linked_list:
+			case tags::tag_handle:
+			case tags::tag_pool:
+			case tags::tag_expression:
+			case tags::tag_index:
+			case tags::tag_bitset:
+				return true;
+		}
+		return false;
+	}
+
+	bool valid_layout(const cell *data, size_t size, size_t rank, size_t start)
+	{
+		for(size_t i = 0; i < start; i++)
+		{
+			if(data[i] <= 0 || data[i] % sizeof(cell) != 0 || static_cast<size_t>(data[i]) / sizeof(cell) > size - i)
+			{
+				return false;
+			}
+		}
+		size_t pos = 0;
+		for(size_t i = 1; i < rank; i++)
+		{
+			if(pos >= start)
+			{
+				return false;
+			}
+			pos += data[pos] / sizeof(cell);
+		}
+		return pos == start;
+	}
+
+	class output
+	{
+		std::vector<char> &data;
+		std::FILE *file;
+		bool failed = false;
+
+	public:
+		// the data is flushed to the file when it reaches the size of a chunk
+		output(std::vector<char> &data, std::FILE *file) : data(data), file(file)
+		{
+
+		}
+
+		void write(const void *src, size_t size)
+		{
+			auto bytes = static_cast<const char*>(src);
+			data.insert(data.end(), bytes, bytes + size);
+			if(file && data.size() >= chunk_size)
+			{
+				flush();
+			}
+		}
+
+		void write_byte(unsigned char value)
+		{
+			write(&value, 1);
+		}
+
+		void write_size(size_t value)
+		{
+			unsigned char bytes[10];
+			size_t count = 0;
+			do{
+				bytes[count] = value & 0x7F;
+				value >>= 7;
+				if(value)
+				{
+					bytes[count] |= 0x80;
+				}
+				count++;
+			}while(value);
+			write(bytes, count);
+		}
+
+		void write_cell(cell value)
+		{
+			write(&value, sizeof(cell));
+		}
+
+		bool flush()
+		{
+			if(file && !data.empty())
+			{
+				if(std::fwrite(data.data(), 1, data.size(), file) != data.size())
+				{
+					failed = true;
+				}
+				data.clear();
+			}
+			return !failed;
+		}
+	};
+
+	class input
+	{
+		const char *pos;
+		const char *end;
+		std::FILE *file;
+		size_t file_remaining;
+		std::vector<char> chunk;
+
+		bool fill()
+		{
+			if(!file || file_remaining == 0)
+			{
+				return false;
+			}
+			chunk.resize(std::min(chunk_size, file_remaining));
+			size_t count = std::fread(chunk.data(), 1, chunk.size(), file);
+			if(count == 0)
+			{
+				return false;
+			}
+			file_remaining -= count;
+			pos = chunk.data();
+			end = pos + count;
+			return true;
+		}
+
+	public:
+		input(const char *data, size_t size) : pos(data), end(data + size), file(nullptr), file_remaining(0)
+		{
+
+		}
+
+		input(std::FILE *file, size_t size) : pos(nullptr), end(nullptr), file(file), file_remaining(size)
+		{
+
+		}
+
+		size_t remaining() const
+		{
+			return (end - pos) + file_remaining;
+		}
+
+		bool read(void *dst, size_t size)
+		{
+			auto bytes = static_cast<char*>(dst);
+			while(size > 0)
+			{
+				if(pos == end && !fill())
+				{
+					return false;
+				}
+				size_t count = std::min(size, static_cast<size_t>(end - pos));
+				std::memcpy(bytes, pos, count);
+				pos += count;
+				bytes += count;
+				size -= count;
+			}
+			return true;
+		}
+
+		bool read_byte(unsigned char &value)
+		{
+			return read(&value, 1);
+		}
+
+		bool read_size(size_t &value)
+		{
+			value = 0;
+			for(size_t shift = 0; shift < sizeof(size_t) * 8; shift += 7)
+			{
+				unsigned char byte;
+				if(!read_byte(byte))
+				{
+					return false;
+				}
+				value |= static_cast<size_t>(byte & 0x7F) << shift;
+				if(!(byte & 0x80))
+				{
+					return true;
+				}
+			}
+			return false;
+		}
+
+		bool read_cell(cell &value)
+		{
+			return read(&value, sizeof(cell));
+		}
+	};
+
+	class writer
+	{
+		output &out;
+		std::unordered_map<tag_ptr, size_t> tags;
+		std::unordered_map<cell, size_t> objects;
+		size_t depth = 0;
+
+		void write_tag(tag_ptr tag)
+		{
+			auto it = tags.find(tag);
+			if(it != tags.end())
+			{
+				out.write_size(it->second);
+				return;
+			}
+			size_t index = tags.size();
+			tags.emplace(tag, index);
+			out.write_size(index);
+			out.write_size(tag->name.size());
+			out.write(tag->name.data(), tag->name.size());
+			// the loading side might not know the tag derives from a handle
+			out.write_byte(is_handle(tag));
+		}
+
+		void add_object(cell id)
+		{
+			size_t index = objects.size();
+			objects.emplace(id, index);
+		}
+
+		template <class Collection>
+		bool write_values(Collection &collection)
+		{
+			out.write_size(collection.size());
+			for(auto it = collection.begin(); it != collection.end(); ++it)
+			{
+				if(!write_value(*it))
+				{
+					return false;
+				}
+			}
+			return true;
+		}
+
+		bool write_object(tag_ptr tag, cell id)
+		{
+			auto it = objects.find(id);
+			if(it != objects.end())
+			{
+				out.write_byte(static_cast<unsigned char>(object_kind::reference));
+				out.write_size(it->second);
+				return true;
+			}
+			if(depth >= max_depth)
+			{
+				return false;
+			}
+			depth++;
+			bool ok = true;
+			switch(tag->find_top_base()->uid)
+			{
+				case tags::tag_string:
+				{
+					strings::cell_string *ptr;
+					if(!strings::pool.get_by_id(id, ptr))
+					{
+						goto invalid;
+					}
+					add_object(id);
+					out.write_byte(static_cast<unsigned char>(object_kind::string));
+					out.write_size(ptr->size());
+					out.write(ptr->data(), ptr->size() * sizeof(cell));
+				}
+				break;
+				case tags::tag_variant:
+				{
+					dyn_object *ptr;
+					if(!variants::pool.get_by_id(id, ptr))
+					{
+						goto invalid;
+					}
+					add_object(id);
+					out.write_byte(static_cast<unsigned char>(object_kind::variant));
+					ok = write_value(*ptr);
+				}
+				break;
+				case tags::tag_list:
+				{
+					list_t *ptr;
+					if(!list_pool.get_by_id(id, ptr))
+					{
+						goto invalid;
+					}
+					add_object(id);
+					out.write_byte(static_cast<unsigned char>(object_kind::list));
+					ok = write_values(*ptr);
+				}
+				break;
+				case tags::tag_map:
+				{
+					map_t *ptr;
+					if(!map_pool.get_by_id(id, ptr))
+					{
+						goto invalid;
+					}
+					add_object(id);
+					out.write_byte(static_cast<unsigned char>(object_kind::map));
+					out.write_byte(ptr->ordered());
+					out.write_size(ptr->size());
+					for(auto it = ptr->begin(); ok && it != ptr->end(); ++it)
+					{
+						ok = write_value(it->first) && write_value(it->second);
+					}
+				}
+				break;
+				case tags::tag_linked_list:
+				{
+					linked_list_t *ptr;
+					if(!linked_list_pool.get_by_id(id, ptr))
+					{
+						goto invalid;
+					}
+					add_object(id);
+					out.write_byte(static_cast<unsigned char>(object_kind::linked_list));
+					ok = write_values(*ptr);
+				}
+				break;
+				case tags::tag_pool:
+				{
+					pool_t *ptr;
+					if(!pool_pool.get_by_id(id, ptr))
+					{
+						goto invalid;
+					}
+					add_object(id);
+					out.write_byte(static_cast<unsigned char>(object_kind::pool));
+					out.write_byte(ptr->ordered());
+					out.write_size(ptr->size());
+					size_t count = 0;
+					for(auto it = ptr->begin(); it != ptr->end(); ++it)
+					{
+						count++;
+					}
+					out.write_size(count);
+					for(auto it = ptr->begin(); ok && it != ptr->end(); ++it)
+					{
+						out.write_size(ptr->index_of(it));
+						ok = write_value(*it);
+					}
+				}
+				break;
+				invalid:
+				out.write_byte(static_cast<unsigned char>(object_kind::none));
+				out.write_cell(id);
+				break;
+				default:
+				// iterators, tasks, handles and the other objects are bound to the running process
+				ok = false;
+				break;
+			}
+			depth--;
+			return ok;
+		}
+
+		bool write_element(tag_ptr tag, cell value)
+		{
+			if(is_handle(tag))
+			{
+				return write_object(tag, value);
+			}
+			out.write_cell(value);
+			return true;
+		}
+
+	public:
+		writer(output &out) : out(out)
+		{
+
+		}
+
+		bool write_value(const dyn_object &obj)
+		{
+			tag_ptr tag = obj.get_tag();
+			if(obj.is_null())
+			{
+				out.write_byte(static_cast<unsigned char>(value_kind::null));
+				write_tag(tag);
+				return true;
+			}
+			if(obj.is_cell())
+			{
+				out.write_byte(static_cast<unsigned char>(value_kind::cell));
+				write_tag(tag);
+				return write_element(tag, *obj.begin());
+			}
+			out.write_byte(static_cast<unsigned char>(value_kind::array));
+			write_tag(tag);
+			const cell *data = obj.data_begin();
+			cell size = obj.end() - data;
+			cell start = obj.begin() - data;
+			out.write_size(obj.get_rank());
+			out.write_size(size);
+			out.write_size(start);
+			// the indirection vectors are relative, so they are stored as they are
+			out.write(data, start * sizeof(cell));
+			if(is_handle(tag))
+			{
+				for(cell i = start; i < size; i++)
+				{
+					if(!write_object(tag, data[i]))
+					{
+						return false;
+					}
+				}
+			}else{
+				out.write(data + start, (size - start) * sizeof(cell));
+			}
+			return true;
+		}
+	};
+
+	class reader
+	{
+		struct tag_entry
+		{
+			tag_ptr tag;
+			bool handle;
+		};
+
+		input &in;
+		std::vector<tag_entry> tags;
+		// all loaded objects in the order they were stored
+		std::vector<std::pair<object_kind, cell>> objects;
+		size_t depth = 0;
+
+		bool read_tag(tag_entry &entry)
+		{
+			size_t index;
+			if(!in.read_size(index))
+			{
+				return false;
+			}
+			if(index < tags.size())
+			{
+				entry = tags[index];
+				return true;
+			}
+			size_t length;
+			unsigned char handle;
+			if(index != tags.size() || !in.read_size(length) || length == 0 || length > in.remaining())
+			{
+				return false;
+			}
+			std::string name(length, '\0');
+			if(!in.read(&name[0], length) || !in.read_byte(handle))
+			{
+				return false;
+			}
+			entry.tag = tags::find_tag(name.c_str(), name.size());
+			entry.handle = handle != 0;
+			tags.push_back(entry);
+			return true;
+		}
+
+		template <class Collection>
+		bool read_values(Collection &collection)
+		{
+			size_t size;
+			if(!in.read_size(size) || size > in.remaining())
+			{
+				return false;
+			}
+			for(size_t i = 0; i < size; i++)
+			{
+				dyn_object value;
+				if(!read_value(value))
+				{
+					return false;
+				}
+				collection.push_back(std::move(value));
+			}
+			return true;
+		}
+
+		// strings and variants stored in other objects are owned by them, only the loaded value itself is local
+		void acquire(object_kind kind, cell id)
+		{
+			switch(kind)
+			{
+				case object_kind::string:
+				{
+					decltype(strings::pool)::ref_container *str;
+					if(strings::pool.get_by_id(id, str))
+					{
+						strings::pool.acquire_ref(*str);
+					}
+				}
+				break;
+				case object_kind::variant:
+				{
+					decltype(variants::pool)::ref_container *var;
+					if(variants::pool.get_by_id(id, var))
+					{
+						variants::pool.acquire_ref(*var);
+					}
+				}
+				break;
+				default:
+					break;
+			}
+		}
+
+		bool read_object(cell &id)
+		{
+			unsigned char kind;
+			if(!in.read_byte(kind))
+			{
+				return false;
+			}
+			bool nested = depth > 0;
+			switch(static_cast<object_kind>(kind))
+			{
+				case object_kind::none:
+					return in.read_cell(id);
+				case object_kind::reference:
+				{
+					size_t index;
+					if(!in.read_size(index) || index >= objects.size())
+					{
+						return false;
+					}
+					id = objects[index].second;
+					if(nested)
+					{
+						acquire(objects[index].first, id);
+					}
+					return true;
+				}
+				case object_kind::string:
+				{
+					size_t size;
+					if(!in.read_size(size) || size > in.remaining() / sizeof(cell))
+					{
+						return false;
+					}
+					auto &ptr = strings::pool.add();
+					id = strings::pool.get_id(ptr);
+					objects.emplace_back(object_kind::string, id);
+					if(nested)
+					{
+						strings::pool.acquire_ref(ptr);
+					}
+					ptr->resize(size);
+					return in.read(&(*ptr)[0], size * sizeof(cell));
+				}
+				default:
+					break;
+			}
+			if(depth >= max_depth)
+			{
+				return false;
+			}
+			depth++;
+			bool ok = false;
+			switch(static_cast<object_kind>(kind))
+			{
+				case object_kind::variant:
+				{
+					// created before its value, which may refer to it
+					auto &ptr = variants::pool.add(dyn_object());
+					id = variants::pool.get_id(ptr);
+					objects.emplace_back(object_kind::variant, id);
+					if(nested)
+					{
+						variants::pool.acquire_ref(ptr);
+					}
+					ok = read_value(*ptr);
+				}
+				break;
+				case object_kind::list:
+				{
+					auto &ptr = list_pool.add();
+					id = list_pool.get_id(ptr);
+					objects.emplace_back(object_kind::list, id);
+					ok = read_values(*ptr);
+				}
+				break;
+				case object_kind::map:
+				{
+					unsigned char ordered;
+					size_t size;
+					if(!in.read_byte(ordered) || !in.read_size(size) || size > in.remaining())
+					{
+						break;
+					}
+					auto &ptr = map_pool.add();
+					id = map_pool.get_id(ptr);
+					objects.emplace_back(object_kind::map, id);
+					ptr->set_ordered(ordered != 0);
+					ok = true;
+					for(size_t i = 0; ok && i < size; i++)
+					{
+						dyn_object key, value;
+						ok = read_value(key) && read_value(value);
+						if(ok)
+						{
+							ptr->insert(std::move(key), std::move(value));
+						}
+					}
+				}
+				break;
+				case object_kind::linked_list:
+				{
+					auto &ptr = linked_list_pool.add();
+					id = linked_list_pool.get_id(ptr);
+					objects.emplace_back(object_kind::linked_list, id);
+					ok = read_values(*ptr);
+				}
+				break;
+				case object_kind::pool:
+				{
+					unsigned char ordered;
+					size_t size, count;
+					if(!in.read_byte(ordered) || !in.read_size(size) || !in.read_size(count) || count > size || count > in.remaining())
+					{
+						break;
+					}
+					auto &ptr = pool_pool.emplace(ordered != 0);
+					id = pool_pool.get_id(ptr);
+					objects.emplace_back(object_kind::pool, id);
+					ptr->resize(size);
+					ok = true;
+					for(size_t i = 0; ok && i < count; i++)
+					{
+						size_t index;
+						dyn_object value;
+						ok = in.read_size(index) && index < size && read_value(value);
+						if(ok)
+						{
+							ptr->insert_or_set(index, std::move(value));
+						}
+					}
+				}
+				break;
+				default:
+					break;
+			}
+			depth--;
+			return ok;
+		}
+
+		bool read_element(const tag_entry &entry, cell &value)
+		{
+			if(entry.handle)
+			{
+				return read_object(value);
+			}
+			return in.read_cell(value);
+		}
+
+	public:
+		reader(input &in) : in(in)
+		{
+
+		}
+
+		bool read_value(dyn_object &obj)
+		{
+			unsigned char kind;
+			tag_entry entry;
+			if(!in.read_byte(kind) || !read_tag(entry))
+			{
+				return false;
+			}
+			switch(static_cast<value_kind>(kind))
+			{
+				case value_kind::null:
+				{
+					obj = dyn_object(dyn_object(), entry.tag);
+					return true;
+				}
+				case value_kind::cell:
+				{
+					cell value;
+					if(!read_element(entry, value))
+					{
+						return false;
+					}
+					obj = dyn_object(value, entry.tag);
+					return true;
+				}
+				case value_kind::array:
+				{
+					size_t rank, size, start;
+					if(!in.read_size(rank) || !in.read_size(size) || !in.read_size(start) || rank < 1 || rank > 3 || start > size || size > in.remaining())
+					{
+						return false;
+					}
+					std::vector<cell> data(size);
+					if(!in.read(data.data(), start * sizeof(cell)) || !valid_layout(data.data(), data.size(), rank, start))
+					{
+						return false;
+					}
+					if(entry.handle)
+					{
+						for(size_t i = start; i < size; i++)
+						{
+							if(!read_element(entry, data[i]))
+							{
+								return false;
+							}
+						}
+					}else if(!in.read(data.data() + start, (size - start) * sizeof(cell)))
+					{
+						return false;
+					}
+					obj = dyn_object(static_cast<cell>(rank), data.data(), static_cast<cell>(size), entry.tag);
+					return true;
+				}
+			}
+			return false;
+		}
+
+		// deletes the objects created by a load that failed
+		void discard()
+		{
+			for(const auto &pair : objects)
+			{
+				switch(pair.first)
+				{
+					case object_kind::string:
+						strings::pool.remove_by_id(pair.second);
+						break;
+					case object_kind::variant:
+						variants::pool.remove_by_id(pair.second);
+						break;
+					case object_kind::list:
+						list_pool.remove(reinterpret_cast<list_t*>(pair.second));
+						break;
+					case object_kind::map:
+						map_pool.remove(reinterpret_cast<map_t*>(pair.second));
+						break;
+					case object_kind::linked_list:
+						linked_list_pool.remove(reinterpret_cast<linked_list_t*>(pair.second));
+						break;
+					case object_kind::pool:
+						pool_pool.remove(reinterpret_cast<pool_t*>(pair.second));
+						break;
+					default:
+						break;
+				}
+			}
+			objects.clear();
+		}
+	};
+
+	static bool save(const dyn_object &value, output &out)
+	{
+		out.write(format_magic, sizeof(format_magic));
+		out.write_byte(format_version);
+		return writer(out).write_value(value);
+	}
+
+	static bool load(input &in, dyn_object &value, tag_ptr tag)
+	{
+		char magic[sizeof(format_magic)];
+		unsigned char version;
+		if(!in.read(magic, sizeof(magic)) || std::memcmp(magic, format_magic, sizeof(magic)) != 0 || !in.read_byte(version) || version != format_version)
+		{
+			return false;
+		}
+		reader r(in);
+		if(!r.read_value(value) || (tag && (!value.is_cell() || !value.tag_assignable(tag))))
+		{
+			value = dyn_object();
+			r.discard();
+			return false;
+		}
+		return true;
+	}
+
+	bool replace_file(const std::string &temp, const char *path, bool ok)
+	{
+		if(ok)
+		{
+#ifdef _WIN32
+			ok = MoveFileExA(temp.c_str(), path, MOVEFILE_REPLACE_EXISTING) != 0;
+#else
+			ok = std::rename(temp.c_str(), path) == 0;
+#endif
+		}
+		if(!ok)
+		{
+			std::remove(temp.c_str());
+		}
+		return ok;
+	}
+
+	bool save_file(const dyn_object &value, const char *path)
+	{
+		// the previous file is kept if the value cannot be stored
+		std::string temp = std::string(path) + ".tmp";
+		std::FILE *file = std::fopen(temp.c_str(), "wb");
+		if(!file)
+		{
+			return false;
+		}
+		// the chunks are already buffered
+		std::setvbuf(file, nullptr, _IONBF, 0);
+		std::vector<char> data;
+		data.reserve(chunk_size);
+		output out(data, file);
+		bool ok = save(value, out) && out.flush();
+		ok = std::fclose(file) == 0 && ok;
+		return replace_file(temp, path, ok);
+	}
+
+	bool save_buffer(const dyn_object &value, std::vector<char> &buffer)
+	{
+		output out(buffer, nullptr);
+		return save(value, out);
+	}
+
+	bool load_file(const char *path, dyn_object &value, tag_ptr tag)
+	{
+		std::FILE *file = std::fopen(path, "rb");
+		if(!file)
+		{
+			return false;
+		}
+		std::setvbuf(file, nullptr, _IONBF, 0);
+		long size = -1;
+		if(std::fseek(file, 0, SEEK_END) == 0)
+		{
+			size = std::ftell(file);
+			std::fseek(file, 0, SEEK_SET);
+		}
+		bool ok = false;
+		if(size >= 0)
+		{
+			input in(file, static_cast<size_t>(size));
+			ok = load(in, value, tag);
+		}
+		std::fclose(file);
+		return ok;
+	}
+
+	bool load_buffer(const char *data, size_t size, dyn_object &value, tag_ptr tag)
+	{
+		input in(data, size);
+		return load(in, value, tag);
+	}
+}
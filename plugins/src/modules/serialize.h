@@ -3,8 +3,35 @@
 
 #include "sdk/amx/amx.h"
 #include "modules/tags.h"
+#include "objects/dyn_object.h"
+#include <vector>
+#include <string>
 
 bool serialize_value(cell value, tag_ptr tag, void(*binary_writer)(void*, const char*, cell), void *binary_writer_cookie, void(*object_writer)(void*, const void*), void *object_writer_cookie);
 bool deserialize_value(cell &value, tag_ptr tag, cell(*binary_reader)(void*, char*, cell), void *binary_reader_cookie, void*(*object_reader)(void*), void *object_reader_cookie);
 
+namespace serialize
+{
+	// Versioned binary format for values and the graphs of strings, variants and
+	// containers they reference. Tags are stored by name, objects referenced more
+	// than once are stored only once, and cells are in the byte order of the machine.
+
+	// returns false if a handle could not be stored or the file could not be written;
+	// iterators, tasks, handles and the other objects bound to the process are not supported
+	bool save_file(const dyn_object &value, const char *path);
+	bool save_buffer(const dyn_object &value, std::vector<char> &buffer);
+	// returns false if the data is not valid, or if the tag is specified and the value
+	// is not a single cell of the tag; no objects are left over from failed loads, and
+	// the strings and variants stored in the loaded objects are acquired by them
+	bool load_file(const char *path, dyn_object &value, tag_ptr tag = nullptr);
+	bool load_buffer(const char *data, size_t size, dyn_object &value, tag_ptr tag = nullptr);
+
+	// moves the temporary file over the file at path if ok, otherwise or if that fails deletes it
+	bool replace_file(const std::string &temp, const char *path, bool ok);
+	// whether the values of the tag are handles to objects, which cannot be stored as cells
+	bool is_handle(tag_ptr tag);
+	// whether the offsets at the start of the data of an array lead to its elements in rank - 1 steps
+	bool valid_layout(const cell *data, size_t size, size_t rank, size_t start);
+}
+
 #endif
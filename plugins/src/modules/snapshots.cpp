@@ -0,0 +1,704 @@
+#include "snapshots.h"
+#include "modules/tags.h"
+#include "modules/tag_ops.h"
+#include "modules/serialize.h"
+
+#include <cstdio>
+#include <cstring>
+#include <string>
+#include <unordered_map>
+#include <algorithm>
+
+#ifdef _WIN32
+#define WIN32_LEAN_AND_MEAN
+#include <windows.h>
+#else
+#include <fcntl.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <unistd.h>
+#endif
+
+aux::shared_id_set_pool<snapshot_t> snapshot_pool;
+
+static constexpr char snapshot_magic[4] = {'P', 'P', 'S', 'N'};
+static constexpr std::uint32_t snapshot_version = 2;
+
+// All fields are in the byte order of the machine, and all sections start
+// at multiples of 4 bytes, so the records can be read directly from the file.
+struct snapshot_t::header
+{
+	char magic[4];
+	std::uint32_t version;
+	std::uint32_t type;
+	std::uint32_t count;
+	// a power of two for maps, 0 for lists
+	std::uint32_t buckets;
+	std::uint32_t tags;
+	std::uint32_t tags_offset;
+	std::uint32_t entries_offset;
+	std::uint32_t buckets_offset;
+	std::uint32_t data_offset;
+	// in cells
+	std::uint32_t data_size;
+};
+
+struct snapshot_t::record
+{
+	std::uint32_t tag;
+	// -1 for null, 0 for a single cell
+	std::int32_t rank;
+	std::uint32_t size;
+	// the position of the elements after the indirection vectors
+	std::uint32_t start;
+	// the cell itself, or the offset of the array in the data section
+	cell value;
+};
+
+struct map_entry
+{
+	std::uint32_t hash;
+	snapshot_t::record key;
+	snapshot_t::record value;
+};
+
+// whether the tag or one of its bases compares its values by user-defined operations
+static bool custom_equality(tag_ptr tag)
+{
+	for(; tag; tag = tag->base)
+	{
+		if(auto ctl = tag->get_control())
+		{
+			if(ctl->has_op(op_type::eq) || ctl->has_op(op_type::hash))
+			{
+				return true;
+			}
+		}
+	}
+	return false;
+}
+
+// The hash is a part of the format: FNV-1a over the base tag name, the rank and the
+// elements, with the elements that compare equal (zeros of Float) stored the same way.
+static std::uint32_t hash_key(const dyn_object &key)
+{
+	std::uint32_t hash = 2166136261u;
+	auto combine = [&](const void *bytes, size_t size)
+	{
+		auto ptr = static_cast<const unsigned char*>(bytes);
+		for(size_t i = 0; i < size; i++)
+		{
+			hash = (hash ^ ptr[i]) * 16777619u;
+		}
+	};
+	const auto &name = key.get_tag()->find_top_base()->name;
+	combine(name.data(), name.size());
+	cell rank = key.get_rank();
+	combine(&rank, sizeof(rank));
+	if(!key.is_null())
+	{
+		bool is_float = key.get_tag()->find_top_base()->uid == tags::tag_float;
+		for(auto it = key.begin(); it != key.end(); ++it)
+		{
+			cell value = *it;
+			if(is_float && amx_ctof(value) == 0.0f)
+			{
+				value = 0;
+			}
+			combine(&value, sizeof(value));
+		}
+	}
+	return hash;
+}
+
+static size_t align(size_t offset)
+{
+	return (offset + 3) & ~static_cast<size_t>(3);
+}
+
+class snapshot_builder
+{
+	std::unordered_map<tag_ptr, std::uint32_t> tag_indices;
+	std::vector<tag_ptr> tags;
+	std::vector<cell> data;
+
+	bool write_file(std::FILE *file, snapshot_t::kind type, size_t count, const void *entries, size_t entries_size, const std::vector<std::uint32_t> &buckets)
+	{
+		snapshot_t::header head;
+		std::memcpy(head.magic, snapshot_magic, sizeof(head.magic));
+		head.version = snapshot_version;
+		head.type = static_cast<std::uint32_t>(type);
+		head.count = static_cast<std::uint32_t>(count);
+		head.buckets = buckets.empty() ? 0 : static_cast<std::uint32_t>(buckets.size() - 1);
+		head.tags = static_cast<std::uint32_t>(tags.size());
+
+		size_t offset = sizeof(head);
+		head.tags_offset = static_cast<std::uint32_t>(offset);
+		for(const auto &tag : tags)
+		{
+			offset += sizeof(std::uint32_t) + align(tag->name.size());
+		}
+		head.entries_offset = static_cast<std::uint32_t>(offset);
+		offset += entries_size;
+		head.buckets_offset = static_cast<std::uint32_t>(offset);
+		offset += buckets.size() * sizeof(std::uint32_t);
+		head.data_offset = static_cast<std::uint32_t>(offset);
+		head.data_size = static_cast<std::uint32_t>(data.size());
+		if(offset + data.size() * sizeof(cell) > UINT32_MAX)
+		{
+			return false;
+		}
+
+		static const char padding[4] = {};
+		bool ok = std::fwrite(&head, sizeof(head), 1, file) == 1;
+		for(const auto &tag : tags)
+		{
+			if(!ok) break;
+			auto length = static_cast<std::uint32_t>(tag->name.size());
+			ok = std::fwrite(&length, sizeof(length), 1, file) == 1 && std::fwrite(tag->name.data(), 1, length, file) == length && std::fwrite(padding, 1, align(length) - length, file) == align(length) - length;
+		}
+		ok = ok && std::fwrite(entries, 1, entries_size, file) == entries_size;
+		ok = ok && std::fwrite(buckets.data(), sizeof(std::uint32_t), buckets.size(), file) == buckets.size();
+		ok = ok && std::fwrite(data.data(), sizeof(cell), data.size(), file) == data.size();
+		return ok;
+	}
+
+public:
+	bool add(const dyn_object &obj, snapshot_t::record &rec)
+	{
+		tag_ptr tag = obj.get_tag();
+		if(serialize::is_handle(tag))
+		{
+			return false;
+		}
+		auto result = tag_indices.emplace(tag, static_cast<std::uint32_t>(tags.size()));
+		if(result.second)
+		{
+			tags.push_back(tag);
+		}
+		rec.tag = result.first->second;
+		rec.size = 0;
+		rec.start = 0;
+		rec.value = 0;
+		if(obj.is_null())
+		{
+			rec.rank = -1;
+		}else if(obj.is_cell())
+		{
+			rec.rank = 0;
+			rec.value = *obj.begin();
+		}else{
+			const cell *raw = obj.data_begin();
+			rec.rank = obj.get_rank();
+			rec.size = static_cast<std::uint32_t>(obj.end() - raw);
+			rec.start = static_cast<std::uint32_t>(obj.begin() - raw);
+			if(data.size() + rec.size > static_cast<size_t>(INT32_MAX) / sizeof(cell))
+			{
+				return false;
+			}
+			rec.value = static_cast<cell>(data.size());
+			data.insert(data.end(), raw, raw + rec.size);
+		}
+		return true;
+	}
+
+	bool save(const char *path, snapshot_t::kind type, size_t count, const void *entries, size_t entries_size, const std::vector<std::uint32_t> &buckets)
+	{
+		// the old file may still be mapped by an open snapshot, so it is replaced instead of overwritten
+		std::string temp = std::string(path) + ".tmp";
+		std::FILE *file = std::fopen(temp.c_str(), "wb");
+		if(!file)
+		{
+			return false;
+		}
+		bool ok = write_file(file, type, count, entries, entries_size, buckets);
+		ok = std::fclose(file) == 0 && ok;
+		// open snapshots share the deletion of the file, so it can be replaced
+		return serialize::replace_file(temp, path, ok);
+	}
+};
+
+bool snapshot_t::build(const list_t &list, const char *path)
+{
+	snapshot_builder builder;
+	std::vector<record> entries(list.size());
+	size_t index = 0;
+	for(const auto &obj : list)
+	{
+		if(!builder.add(obj, entries[index++]))
+		{
+			return false;
+		}
+	}
+	return builder.save(path, kind::list, entries.size(), entries.data(), entries.size() * sizeof(record), {});
+}
+
+bool snapshot_t::build(const map_t &map, const char *path)
+{
+	snapshot_builder builder;
+	std::vector<map_entry> entries(map.size());
+	size_t index = 0;
+	for(const auto &pair : map)
+	{
+		auto &entry = entries[index++];
+		// the keys could not be found by the stored hashes
+		if(custom_equality(pair.first.get_tag()) || !builder.add(pair.first, entry.key) || !builder.add(pair.second, entry.value))
+		{
+			return false;
+		}
+		entry.hash = hash_key(pair.first);
+	}
+
+	std::uint32_t buckets = 1;
+	while(buckets < entries.size())
+	{
+		buckets <<= 1;
+	}
+	std::uint32_t mask = buckets - 1;
+	std::stable_sort(entries.begin(), entries.end(), [=](const map_entry &a, const map_entry &b)
+	{
+		return (a.hash & mask) < (b.hash & mask);
+	});
+	// the entries of bucket i are between starts[i] and starts[i + 1]
+	std::vector<std::uint32_t> starts(buckets + 1);
+	for(const auto &entry : entries)
+	{
+		starts[(entry.hash & mask) + 1]++;
+	}
+	for(std::uint32_t i = 0; i < buckets; i++)
+	{
+		starts[i + 1] += starts[i];
+	}
+	return builder.save(path, kind::map, entries.size(), entries.data(), entries.size() * sizeof(map_entry), starts);
+}
+
+bool snapshot_t::map_file(const char *path)
+{
+#ifdef _WIN32
+	HANDLE f = CreateFileA(path, GENERIC_READ, FILE_SHARE_READ | FILE_SHARE_DELETE, nullptr, OPEN_EXISTING, FILE_ATTRIBUTE_NORMAL, nullptr);
+	if(f == INVALID_HANDLE_VALUE)
+	{
+		return false;
+	}
+	file = f;
+	LARGE_INTEGER size;
+	if(!GetFileSizeEx(f, &size) || size.QuadPart <= 0 || static_cast<unsigned long long>(size.QuadPart) > SIZE_MAX)
+	{
+		return false;
+	}
+	HANDLE m = CreateFileMappingA(f, nullptr, PAGE_READONLY, 0, 0, nullptr);
+	if(!m)
+	{
+		return false;
+	}
+	mapping = m;
+	view = static_cast<const char*>(MapViewOfFile(m, FILE_MAP_READ, 0, 0, 0));
+	if(!view)
+	{
+		return false;
+	}
+	length = static_cast<size_t>(size.QuadPart);
+#else
+	int fd = ::open(path, O_RDONLY);
+	if(fd == -1)
+	{
+		return false;
+	}
+	struct stat st;
+	if(fstat(fd, &st) != 0 || st.st_size <= 0 || static_cast<unsigned long long>(st.st_size) > SIZE_MAX)
+	{
+		close(fd);
+		return false;
+	}
+	void *addr = mmap(nullptr, static_cast<size_t>(st.st_size), PROT_READ, MAP_PRIVATE, fd, 0);
+	close(fd);
+	if(addr == MAP_FAILED)
+	{
+		return false;
+	}
+	view = static_cast<const char*>(addr);
+	length = static_cast<size_t>(st.st_size);
+#endif
+	return true;
+}
+
+snapshot_t::~snapshot_t()
+{
+#ifdef _WIN32
+	if(view)
+	{
+		UnmapViewOfFile(view);
+	}
+	if(mapping)
+	{
+		CloseHandle(mapping);
+	}
+	if(file)
+	{
+		CloseHandle(file);
+	}
+#else
+	if(view)
+	{
+		munmap(const_cast<char*>(view), length);
+	}
+#endif
+}
+
+bool snapshot_t::valid_record(const record &rec) const
+{
+	if(rec.tag >= tags.size() || rec.rank < -1 || rec.rank > 3)
+	{
+		return false;
+	}
+	if(rec.rank < 1)
+	{
+		return true;
+	}
+	if(rec.value < 0 || static_cast<size_t>(rec.value) > data_size || rec.start > rec.size || rec.size > data_size - static_cast<size_t>(rec.value))
+	{
+		return false;
+	}
+	return serialize::valid_layout(data + rec.value, rec.size, rec.rank, rec.start);
+}
+
+bool snapshot_t::validate()
+{
+	if(length < sizeof(header))
+	{
+		return false;
+	}
+	const auto &head = *reinterpret_cast<const header*>(view);
+	if(std::memcmp(head.magic, snapshot_magic, sizeof(head.magic)) != 0 || head.version != snapshot_version || head.type > static_cast<std::uint32_t>(kind::map))
+	{
+		return false;
+	}
+	if(head.tags_offset % 4 != 0 || head.entries_offset % 4 != 0 || head.buckets_offset % 4 != 0 || head.data_offset % 4 != 0)
+	{
+		return false;
+	}
+	type = static_cast<kind>(head.type);
+	count = head.count;
+	buckets = head.buckets;
+
+	size_t offset = head.tags_offset;
+	for(std::uint32_t i = 0; i < head.tags; i++)
+	{
+		if(offset > length || length - offset < sizeof(std::uint32_t))
+		{
+			return false;
+		}
+		auto size = *reinterpret_cast<const std::uint32_t*>(view + offset);
+		offset += sizeof(std::uint32_t);
+		if(size == 0 || size > length - offset)
+		{
+			return false;
+		}
+		tags.push_back(tags::find_tag(view + offset, size));
+		offset += align(size);
+	}
+
+	auto fits = [&](std::uint64_t start, std::uint64_t size)
+	{
+		return start <= length && size <= length - start;
+	};
+	size_t entry_size = is_map() ? sizeof(map_entry) : sizeof(record);
+	if(!fits(head.entries_offset, static_cast<std::uint64_t>(count) * entry_size) || !fits(head.data_offset, static_cast<std::uint64_t>(head.data_size) * sizeof(cell)))
+	{
+		return false;
+	}
+	entries = view + head.entries_offset;
+	data = reinterpret_cast<const cell*>(view + head.data_offset);
+	data_size = head.data_size;
+
+	if(is_map())
+	{
+		if(buckets == 0 || (buckets & (buckets - 1)) != 0 || !fits(head.buckets_offset, (static_cast<std::uint64_t>(buckets) + 1) * sizeof(std::uint32_t)))
+		{
+			return false;
+		}
+		bucket_starts = reinterpret_cast<const std::uint32_t*>(view + head.buckets_offset);
+		if(bucket_starts[0] != 0 || bucket_starts[buckets] != count)
+		{
+			return false;
+		}
+		for(size_t i = 0; i < buckets; i++)
+		{
+			if(bucket_starts[i] > bucket_starts[i + 1])
+			{
+				return false;
+			}
+		}
+	}else{
+		buckets = 0;
+		bucket_starts = nullptr;
+	}
+
+	for(size_t i = 0; i < count; i++)
+	{
+		if(!valid_record(value_record(i)) || (is_map() && !valid_record(key_record(i))))
+		{
+			return false;
+		}
+	}
+	return true;
+}
+
+std::shared_ptr<snapshot_t> snapshot_t::open(const char *path)
+{
+	auto snapshot = std::make_shared<snapshot_t>();
+	if(!snapshot->map_file(path) || !snapshot->validate())
+	{
+		return nullptr;
+	}
+	return snapshot;
+}
+
+const snapshot_t::record &snapshot_t::value_record(size_t index) const
+{
+	if(is_map())
+	{
+		return reinterpret_cast<const map_entry*>(entries)[index].value;
+	}
+	return reinterpret_cast<const record*>(entries)[index];
+}
+
+const snapshot_t::record &snapshot_t::key_record(size_t index) const
+{
+	return reinterpret_cast<const map_entry*>(entries)[index].key;
+}
+
+dyn_object snapshot_t::materialize(const record &rec) const
+{
+	tag_ptr tag = tags[rec.tag];
+	switch(rec.rank)
+	{
+		case -1:
+			return dyn_object(dyn_object(), tag);
+		case 0:
+			return dyn_object(rec.value, tag);
+		default:
+			return dyn_object(rec.rank, data + rec.value, static_cast<cell>(rec.size), tag);
+	}
+}
+
+dyn_object snapshot_t::value_at(size_t index) const
+{
+	return materialize(value_record(index));
+}
+
+dyn_object snapshot_t::key_at(size_t index) const
+{
+	if(!is_map())
+	{
+		return dyn_object(static_cast<cell>(index), tags::find_tag(tags::tag_cell));
+	}
+	return materialize(key_record(index));
+}
+
+cell snapshot_t::tag_at(AMX *amx, size_t index) const
+{
+	return tags[value_record(index).tag]->get_id(amx);
+}
+
+bool snapshot_t::find(const dyn_object &key, size_t &index) const
+{
+	if(!is_map())
+	{
+		return false;
+	}
+	auto map_entries = reinterpret_cast<const map_entry*>(entries);
+	if(custom_equality(key.get_tag()))
+	{
+		// the operations of the tag may consider keys with other hashes equal
+		for(size_t i = 0; i < count; i++)
+		{
+			if(materialize(map_entries[i].key) == key)
+			{
+				index = i;
+				return true;
+			}
+		}
+		return false;
+	}
+	std::uint32_t hash = hash_key(key);
+	size_t bucket = hash & (buckets - 1);
+	for(size_t i = bucket_starts[bucket]; i < bucket_starts[bucket + 1]; i++)
+	{
+		if(map_entries[i].hash == hash && materialize(map_entries[i].key) == key)
+		{
+			index = i;
+			return true;
+		}
+	}
+	return false;
+}
+
+bool snapshot_iterator_t::expired() const
+{
+	return _source.expired();
+}
+
+bool snapshot_iterator_t::valid() const
+{
+	if(auto source = lock_source())
+	{
+		return _position < source->size();
+	}
+	return false;
+}
+
+bool snapshot_iterator_t::empty() const
+{
+	if(auto source = lock_source())
+	{
+		return source->size() == 0;
+	}
+	return true;
+}
+
+bool snapshot_iterator_t::move_next()
+{
+	if(auto source = lock_source())
+	{
+		if(_position < source->size())
+		{
+			return ++_position < source->size();
+		}
+	}
+	return false;
+}
+
+bool snapshot_iterator_t::move_previous()
+{
+	if(auto source = lock_source())
+	{
+		if(_position < source->size())
+		{
+			if(_position > 0)
+			{
+				_position--;
+				return true;
+			}
+			_position = source->size();
+		}
+	}
+	return false;
+}
+
+bool snapshot_iterator_t::set_to_first()
+{
+	if(auto source = lock_source())
+	{
+		_position = 0;
+		return source->size() > 0;
+	}
+	return false;
+}
+
+bool snapshot_iterator_t::set_to_last()
+{
+	if(auto source = lock_source())
+	{
+		if(source->size() > 0)
+		{
+			_position = source->size() - 1;
+			return true;
+		}
+		_position = 0;
+	}
+	return false;
+}
+
+bool snapshot_iterator_t::reset()
+{
+	if(auto source = lock_source())
+	{
+		_position = source->size();
+		return true;
+	}
+	return false;
+}
+
+size_t snapshot_iterator_t::get_hash() const
+{
+	if(auto source = lock_source())
+	{
+		if(_position < source->size())
+		{
+			return std::hash<size_t>()(_position);
+		}
+		return std::hash<snapshot_t*>()(source.get());
+	}
+	return 0;
+}
+
+bool snapshot_iterator_t::erase(bool stay)
+{
+	return false;
+}
+
+bool snapshot_iterator_t::can_reset() const
+{
+	return !_source.expired();
+}
+
+bool snapshot_iterator_t::can_erase() const
+{
+	return false;
+}
+
+bool snapshot_iterator_t::can_insert() const
+{
+	return false;
+}
+
+std::unique_ptr<dyn_iterator> snapshot_iterator_t::clone() const
+{
+	return std::make_unique<snapshot_iterator_t>(*this);
+}
+
+std::shared_ptr<dyn_iterator> snapshot_iterator_t::clone_shared() const
+{
+	return std::make_shared<snapshot_iterator_t>(*this);
+}
+
+bool snapshot_iterator_t::operator==(const dyn_iterator &obj) const
+{
+	auto other = dynamic_cast<const snapshot_iterator_t*>(&obj);
+	if(other != nullptr)
+	{
+		return !_source.owner_before(other->_source) && !other->_source.owner_before(_source) && _position == other->_position;
+	}
+	return false;
+}
+
+bool snapshot_iterator_t::extract_dyn(const std::type_info &type, void *value) const
+{
+	if(auto source = lock_source())
+	{
+		if(_position < source->size())
+		{
+			if(!source->is_map() && type == typeid(std::shared_ptr<const dyn_object>))
+			{
+				*reinterpret_cast<std::shared_ptr<const dyn_object>*>(value) = std::make_shared<dyn_object>(source->value_at(_position));
+				return true;
+			}else if(type == typeid(std::shared_ptr<const std::pair<const dyn_object, dyn_object>>))
+			{
+				*reinterpret_cast<std::shared_ptr<const std::pair<const dyn_object, dyn_object>>*>(value) = std::make_shared<std::pair<const dyn_object, dyn_object>>(source->key_at(_position), source->value_at(_position));
+				return true;
+			}
+		}
+	}
+	return false;
+}
+
+bool snapshot_iterator_t::insert_dyn(const std::type_info &type, void *value)
+{
+	return false;
+}
+
+bool snapshot_iterator_t::insert_dyn(const std::type_info &type, const void *value)
+{
+	return false;
+}
@@ -0,0 +1,149 @@
+#ifndef SNAPSHOTS_H_INCLUDED
+#define SNAPSHOTS_H_INCLUDED
+
+#include "modules/containers.h"
+#include "objects/dyn_object.h"
+#include "utils/shared_id_set_pool.h"
+#include "utils/local_ptr.h"
+
+#include <cstdint>
+#include <vector>
+#include <memory>
+
+// Read-only list or map stored in a file that is mapped into memory. Lookups
+// and iteration read the file in place, and only the elements that are
+// accessed are copied into objects. The records are checked once when the
+// file is opened, so the accessors below never fail on a damaged file.
+class snapshot_t
+{
+public:
+	enum class kind : std::uint32_t
+	{
+		list,
+		map
+	};
+
+	struct header;
+	struct record;
+
+private:
+	const char *view = nullptr;
+	size_t length = 0;
+#ifdef _WIN32
+	void *file = nullptr;
+	void *mapping = nullptr;
+#endif
+
+	kind type;
+	size_t count;
+	size_t buckets;
+	const char *entries;
+	const std::uint32_t *bucket_starts;
+	const cell *data;
+	size_t data_size;
+	std::vector<tag_ptr> tags;
+
+	bool map_file(const char *path);
+	bool validate();
+	bool valid_record(const record &rec) const;
+	const record &value_record(size_t index) const;
+	const record &key_record(size_t index) const;
+	dyn_object materialize(const record &rec) const;
+
+public:
+	snapshot_t() = default;
+	snapshot_t(const snapshot_t&) = delete;
+	snapshot_t &operator=(const snapshot_t&) = delete;
+	~snapshot_t();
+
+	// returns nullptr if the file could not be mapped or is not a valid snapshot
+	static std::shared_ptr<snapshot_t> open(const char *path);
+
+	// returns false if an element could not be stored, e.g. a handle to another object,
+	// or if a key of the map has a tag with user-defined equality or hash operations
+	static bool build(const list_t &list, const char *path);
+	static bool build(const map_t &map, const char *path);
+
+	bool is_map() const
+	{
+		return type == kind::map;
+	}
+
+	size_t size() const
+	{
+		return count;
+	}
+
+	// the size of the mapped file
+	size_t mapped_size() const
+	{
+		return length;
+	}
+
+	// for maps, indices are in the order of the stored buckets
+	dyn_object value_at(size_t index) const;
+	dyn_object key_at(size_t index) const;
+	cell tag_at(AMX *amx, size_t index) const;
+	bool find(const dyn_object &key, size_t &index) const;
+};
+
+class snapshot_iterator_t : public dyn_iterator, public object_pool<dyn_iterator>::ref_container_virtual
+{
+	aux::local_weak_ptr<snapshot_t> _source;
+	// equal to the size of the source when outside
+	size_t _position;
+
+	aux::local_lock<snapshot_t> lock_source() const
+	{
+		return _source.lock_local(is_main_thread);
+	}
+
+public:
+	snapshot_iterator_t(const std::shared_ptr<snapshot_t> &source) : _source(source), _position(0)
+	{
+
+	}
+
+	snapshot_iterator_t(const std::shared_ptr<snapshot_t> &source, size_t position) : _source(source), _position(position)
+	{
+
+	}
+
+	snapshot_iterator_t(const snapshot_iterator_t &iter) = default;
+
+	virtual bool expired() const override;
+	virtual bool valid() const override;
+	virtual bool empty() const override;
+	virtual bool move_next() override;
+	virtual bool move_previous() override;
+	virtual bool set_to_first() override;
+	virtual bool set_to_last() override;
+	virtual bool reset() override;
+	virtual size_t get_hash() const override;
+	virtual bool erase(bool stay) override;
+	virtual std::unique_ptr<dyn_iterator> clone() const override;
+	virtual std::shared_ptr<dyn_iterator> clone_shared() const override;
+	virtual bool operator==(const dyn_iterator &obj) const override;
+
+	virtual bool can_reset() const override;
+	virtual bool can_insert() const override;
+	virtual bool can_erase() const override;
+
+	virtual bool extract_dyn(const std::type_info &type, void *value) const override;
+	virtual bool insert_dyn(const std::type_info &type, void *value) override;
+	virtual bool insert_dyn(const std::type_info &type, const void *value) override;
+
+	virtual dyn_iterator *get() override
+	{
+		return this;
+	}
+
+	virtual const dyn_iterator *get() const override
+	{
+		return this;
+	}
+};
+
+extern aux::shared_id_set_pool<snapshot_t> snapshot_pool;
+
+#endif
@@ -9,9 +9,11 @@
 #include "modules/events.h"
 #include "modules/amxhook.h"
 #include "modules/expressions.h"
+#include "modules/indexes.h"
 #include "objects/stored_param.h"
 #include "fixes/linux.h"
 #include "utils/optional.h"
+#include "utils/cell_search.h"
 #include <vector>
 #include <algorithm>
 #include <cmath>
@@ -832,13 +834,7 @@ struct char_operations : public cell_operations<char_operations>
 
 	virtual cell_string to_string(tag_ptr tag, const cell *arg, cell size) const override
 	{
-		cell_string str(arg, size);
-		size_t null = str.find(0);
-		if(null != cell_string::npos)
-		{
-			str.resize(null, 0);
-		}
-		return str;
+		return cell_string(arg, aux::find_cell(arg, arg + size, 0));
 	}
 
 	virtual char format_spec(tag_ptr tag, bool arr) const override
@@ -1668,7 +1664,7 @@ struct list_operations : public generic_operations<list_operations, tags::tag_li
 		if(list_pool.get_by_id(arg, l))
 		{
 			list_t old;
-			std::swap(*l, old);
+			l->swap(old);
 			list_pool.remove(l);
 			for(auto &obj : old)
 			{
@@ -1697,13 +1693,13 @@ struct list_operations : public generic_operations<list_operations, tags::tag_li
 		if(list_pool.get_by_id(arg, l))
 		{
 			list_t tmp;
-			std::swap(*l, tmp);
+			l->swap(tmp);
 			list_t *l2 = list_pool.add().get();
 			for(auto &obj : tmp)
 			{
 				l2->push_back(obj.clone());
 			}
-			std::swap(*l, tmp);
+			l->swap(tmp);
 			return list_pool.get_id(l2);
 		}
 		return 0;
@@ -1764,11 +1760,11 @@ struct linked_list_operations : public generic_operations<linked_list_operations
 		if(linked_list_pool.get_by_id(arg, l))
 		{
 			linked_list_t old;
-			std::swap(*l, old);
+			l->swap(old);
 			linked_list_pool.remove(l);
 			for(auto &obj : old)
 			{
-				obj->release();
+				obj.release();
 			}
 			return true;
 		}
@@ -1793,13 +1789,13 @@ struct linked_list_operations : public generic_operations<linked_list_operations
 		if(linked_list_pool.get_by_id(arg, l))
 		{
 			linked_list_t tmp;
-			std::swap(*l, tmp);
+			l->swap(tmp);
 			linked_list_t *l2 = linked_list_pool.add().get();
 			for(auto &obj : tmp)
 			{
-				l2->push_back(obj->clone());
+				l2->push_back(obj.clone());
 			}
-			std::swap(*l, tmp);
+			l->swap(tmp);
 			return linked_list_pool.get_id(l2);
 		}
 		return 0;
@@ -1860,7 +1856,7 @@ struct map_operations : public generic_operations<map_operations, tags::tag_map>
 		if(map_pool.get_by_id(arg, m))
 		{
 			map_t old(m->ordered());
-			std::swap(*m, old);
+			m->swap(old);
 			map_pool.remove(m);
 			for(auto &pair : old)
 			{
@@ -1890,14 +1886,14 @@ struct map_operations : public generic_operations<map_operations, tags::tag_map>
 		if(map_pool.get_by_id(arg, m))
 		{
 			map_t tmp;
-			std::swap(*m, tmp);
+			m->swap(tmp);
 			map_t *m2 = map_pool.add().get();
 			m2->set_ordered(m->ordered());
 			for(auto &pair : tmp)
 			{
 				m2->insert(pair.first.clone(), pair.second.clone());
 			}
-			std::swap(*m, tmp);
+			m->swap(tmp);
 			return map_pool.get_id(m2);
 		}
 		return 0;
@@ -2278,7 +2274,7 @@ struct pool_operations : public generic_operations<pool_operations, tags::tag_po
 		if(pool_pool.get_by_id(arg, p))
 		{
 			pool_t old(p->ordered());
-			std::swap(*p, old);
+			p->swap(old);
 			pool_pool.remove(p);
 			for(auto &obj : old)
 			{
@@ -2307,14 +2303,14 @@ struct pool_operations : public generic_operations<pool_operations, tags::tag_po
 		if(pool_pool.get_by_id(arg, p))
 		{
 			pool_t tmp;
-			std::swap(*p, tmp);
+			p->swap(tmp);
 			pool_t *p2 = pool_pool.add().get();
 			p2->set_ordered(p->ordered());
 			for(auto it = p->begin(); it != p->end(); ++it)
 			{
 				p2->insert_or_set(p->index_of(it), it->clone());
 			}
-			std::swap(*p, tmp);
+			p->swap(tmp);
 			return pool_pool.get_id(p2);
 		}
 		return 0;
@@ -2387,6 +2383,133 @@ struct expression_operations : public null_operations<expression_operations>
 	}
 };
 
+struct index_operations : public null_operations<index_operations>
+{
+	index_operations() : null_operations<index_operations>(tags::tag_index)
+	{
+
+	}
+
+	virtual bool eq(tag_ptr tag, cell a, cell b) const override
+	{
+		return a == b;
+	}
+
+	virtual bool not(tag_ptr tag, cell a) const override
+	{
+		index_t *ptr;
+		return !index_pool.get_by_id(a, ptr);
+	}
+
+	virtual bool del(tag_ptr tag, cell arg) const override
+	{
+		index_t *ptr;
+		if(index_pool.get_by_id(arg, ptr))
+		{
+			return index_pool.remove(ptr);
+		}
+		return false;
+	}
+
+	virtual bool release(tag_ptr tag, cell arg) const override
+	{
+		return del(tag, arg);
+	}
+
+	virtual std::weak_ptr<const void> handle(tag_ptr tag, cell arg) const override
+	{
+		std::shared_ptr<index_t> ptr;
+		if(index_pool.get_by_id(arg, ptr))
+		{
+			return ptr;
+		}
+		return {};
+	}
+};
+
+struct bitset_operations : public null_operations<bitset_operations>
+{
+	bitset_operations() : null_operations<bitset_operations>(tags::tag_bitset)
+	{
+
+	}
+
+	virtual bool eq(tag_ptr tag, cell a, cell b) const override
+	{
+		return a == b;
+	}
+
+	virtual bool not(tag_ptr tag, cell a) const override
+	{
+		bitset_t *ptr;
+		return !bitset_pool.get_by_id(a, ptr);
+	}
+
+	virtual bool del(tag_ptr tag, cell arg) const override
+	{
+		bitset_t *ptr;
+		if(bitset_pool.get_by_id(arg, ptr))
+		{
+			return bitset_pool.remove(ptr);
+		}
+		return false;
+	}
+
+	virtual bool release(tag_ptr tag, cell arg) const override
+	{
+		return del(tag, arg);
+	}
+
+	virtual std::weak_ptr<const void> handle(tag_ptr tag, cell arg) const override
+	{
+		std::shared_ptr<bitset_t> ptr;
+		if(bitset_pool.get_by_id(arg, ptr))
+		{
+			return ptr;
+		}
+		return {};
+	}
+
+	virtual cell copy(tag_ptr tag, cell arg) const override
+	{
+		bitset_t *ptr;
+		if(bitset_pool.get_by_id(arg, ptr))
+		{
+			return bitset_pool.get_id(bitset_pool.add(bitset_t(*ptr)));
+		}
+		return 0;
+	}
+
+	virtual cell clone(tag_ptr tag, cell arg) const override
+	{
+		return copy(tag, arg);
+	}
+
+	virtual bool append_string(tag_ptr tag, cell arg, cell_string &str) const override
+	{
+		bitset_t *ptr;
+		if(bitset_pool.get_by_id(arg, ptr))
+		{
+			str.push_back('{');
+			bool first = true;
+			ptr->for_each([&](cell value)
+			{
+				if(first)
+				{
+					first = false;
+				}else{
+					str.push_back(',');
+					str.push_back(' ');
+				}
+				str.append(strings::convert(std::to_string(value)));
+			});
+			str.push_back('}');
+			return true;
+		}
+		return null_operations::append_string(tag, arg, str);
+	}
+};
+
 static const null_operations<signed_operations> unknown_ops(tags::tag_unknown);
 
 std::vector<std::unique_ptr<tag_info>> tag_list([]()
@@ -2424,6 +2547,8 @@ std::vector<std::unique_ptr<tag_info>> tag_list([]()
 	v.push_back(std::move(string_const));
 	v.push_back(std::move(variant_const));
 	v.push_back(std::make_unique<tag_info>(27, "char@", v[3].get(), std::make_unique<char_operations>()));
+	v.push_back(std::make_unique<tag_info>(28, "Index", unknown_tag, std::make_unique<index_operations>()));
+	v.push_back(std::make_unique<tag_info>(29, "BitSet", unknown_tag, std::make_unique<bitset_operations>()));
 
 	unknown_ops.register_specifier('v');
 
@@ -2850,6 +2975,12 @@ public:
 		return true;
 	}
 
+	virtual bool has_op(op_type type) const override
+	{
+		auto it = dyn_ops.find(type);
+		return it != dyn_ops.end() && it->second;
+	}
+
 	virtual bool lock() override
 	{
 		if(_locked) return false;
@@ -88,6 +88,8 @@ public:
 	virtual bool set_op(op_type type, cell(*handler)(void *cookie, const void *tag, cell *args, cell numargs), void *cookie) = 0;
 	virtual bool set_op(op_type type, std::shared_ptr<const class expression> handler) = 0;
 	virtual bool lock() = 0;
+	// whether a handler was set for the operation
+	virtual bool has_op(op_type type) const = 0;
 	virtual ~tag_control() = default;
 };
 
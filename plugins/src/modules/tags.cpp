@@ -88,7 +88,7 @@ tag_ptr tags::find_tag(AMX *amx, cell tag_id)
 	tag_id &= 0x7FFFFFFF;
 	if(tag_id == 0) return ::tag_list[tag_cell].get();
 
-	auto obj = amx::load_lock(amx);
+	const auto &obj = amx::load_lock(amx);
 	auto &map = obj->get_extra<tag_map_info>().tag_map;
 	auto it = map.find(tag_id);
 	if(it != map.end())
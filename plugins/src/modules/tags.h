@@ -105,6 +105,8 @@ namespace tags
 	constexpr const cell tag_expression = 22;
 	constexpr const cell tag_address = 23;
 	constexpr const cell tag_amx_guard = 24;
+	constexpr const cell tag_index = 28;
+	constexpr const cell tag_bitset = 29;
 
 	tag_ptr find_tag(const char *name, size_t sublen=-1);
 	tag_ptr find_tag(AMX *amx, cell tag_id);
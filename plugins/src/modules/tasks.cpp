@@ -2,6 +2,8 @@
 #include "exec.h"
 
 #include "utils/shared_id_set_pool.h"
+#include "utils/free_list.h"
+#include "utils/mpsc_queue.h"
 #include "sdk/amx/amx.h"
 #include <utility>
 #include <chrono>
@@ -24,6 +26,9 @@ namespace tasks
 
 		virtual cell set_completed(task &t) override;
 		virtual cell set_faulted(task &t) override;
+
+		static void *operator new(size_t size);
+		static void operator delete(void *ptr, size_t size);
 	};
 
 	class task_handler : public handler
@@ -39,6 +44,9 @@ namespace tasks
 
 		virtual cell set_completed(task &t) override;
 		virtual cell set_faulted(task &t) override;
+
+		static void *operator new(size_t size);
+		static void operator delete(void *ptr, size_t size);
 	};
 
 	class task_result_handler : public task_handler
@@ -63,6 +71,9 @@ namespace tasks
 		virtual cell set_completed(task &t) override;
 		virtual cell set_faulted(task &t) override;
 
+		static void *operator new(size_t size);
+		static void operator delete(void *ptr, size_t size);
+
 		virtual ~task_result_handler()
 		{
 			if(!iserror)
@@ -73,6 +84,64 @@ namespace tasks
 		}
 	};
 
+	// declared before anything that may own a handler, so they outlive it
+	aux::free_list<reset_handler> reset_handler_pool;
+	aux::free_list<task_handler> task_handler_pool;
+	aux::free_list<task_result_handler> task_result_handler_pool;
+
+	// the lists are not thread-safe, so other threads use the global allocator;
+	// the blocks have the same size, so either side may free them
+	template <class Handler>
+	void *allocate_handler(aux::free_list<Handler> &list, size_t size)
+	{
+		if(size != sizeof(Handler) || !is_main_thread)
+		{
+			return ::operator new(size);
+		}
+		return list.allocate();
+	}
+
+	template <class Handler>
+	void deallocate_handler(aux::free_list<Handler> &list, void *ptr, size_t size)
+	{
+		if(size != sizeof(Handler) || !is_main_thread)
+		{
+			::operator delete(ptr);
+		}else{
+			list.deallocate(ptr);
+		}
+	}
+
+	void *reset_handler::operator new(size_t size)
+	{
+		return allocate_handler(reset_handler_pool, size);
+	}
+
+	void reset_handler::operator delete(void *ptr, size_t size)
+	{
+		deallocate_handler(reset_handler_pool, ptr, size);
+	}
+
+	void *task_handler::operator new(size_t size)
+	{
+		return allocate_handler(task_handler_pool, size);
+	}
+
+	void task_handler::operator delete(void *ptr, size_t size)
+	{
+		deallocate_handler(task_handler_pool, ptr, size);
+	}
+
+	void *task_result_handler::operator new(size_t size)
+	{
+		return allocate_handler(task_result_handler_pool, size);
+	}
+
+	void task_result_handler::operator delete(void *ptr, size_t size)
+	{
+		deallocate_handler(task_result_handler_pool, ptr, size);
+	}
+
 	aux::shared_id_set_pool<task> pool;
 
 	ucell tick_count = 0;
@@ -81,6 +150,22 @@ namespace tasks
 
 	std::queue<std::unique_ptr<handler>> pending_handlers;
 
+	// a result of a task received from another thread
+	struct posted_result
+	{
+		cell id;
+		cell error;
+		tag_ptr tag;
+		cell value;
+		std::vector<cell> arr;
+		bool is_array;
+	};
+
+	aux::mpsc_queue<posted_result> posted_results;
+
+	// limits the number of posted results processed at once, so that a busy producer cannot stall the server
+	constexpr size_t posted_batch_size = 1024;
+
 	static task &auto_result()
 	{
 		static task result(dyn_object(1, tags::find_tag(tags::tag_cell)));
@@ -317,6 +402,44 @@ namespace tasks
 			pending_handlers.pop();
 			handler->set_completed(auto_result());
 		}
+		run_posted();
+	}
+
+	void post_completed(cell id, cell value, tag_ptr tag)
+	{
+		posted_results.push(posted_result{id, AMX_ERR_NONE, tag, value, {}, false});
+	}
+
+	void post_completed(cell id, const cell *arr, cell size, tag_ptr tag)
+	{
+		posted_results.push(posted_result{id, AMX_ERR_NONE, tag, 0, std::vector<cell>(arr, arr + size), true});
+	}
+
+	void post_faulted(cell id, cell error)
+	{
+		posted_results.push(posted_result{id, error, nullptr, 0, {}, false});
+	}
+
+	void run_posted()
+	{
+		posted_result posted;
+		for(size_t i = 0; i < posted_batch_size && posted_results.pop(posted); i++)
+		{
+			task *ptr;
+			if(!get_by_id(posted.id, ptr))
+			{
+				continue;
+			}
+			if(posted.error != AMX_ERR_NONE)
+			{
+				ptr->set_faulted(posted.error);
+			}else if(posted.is_array)
+			{
+				ptr->set_completed(dyn_object(posted.arr.data(), static_cast<cell>(posted.arr.size()), posted.tag));
+			}else{
+				ptr->set_completed(dyn_object(posted.value, posted.tag));
+			}
+		}
 	}
 
 	std::shared_ptr<task> get(task *ptr)
@@ -383,8 +506,25 @@ namespace tasks
 		return pool.size();
 	}
 
+	size_t memory_usage()
+	{
+		size_t bytes = 0;
+		for(const auto &pair : pool)
+		{
+			bytes += sizeof(task) + pair.second->heap_size();
+		}
+		return bytes;
+	}
+
+	size_t handler_allocs()
+	{
+		return reset_handler_pool.num_allocated() + task_handler_pool.num_allocated() + task_result_handler_pool.num_allocated();
+	}
+
 	void tick()
 	{
+		run_posted();
+
 		tick_count++;
 		{
 			auto it = tick_handlers.begin();
@@ -434,6 +574,7 @@ namespace tasks
 		{
 			std::queue<std::unique_ptr<handler>>().swap(pending_handlers);
 		}
+		posted_results.clear();
 		pool.clear();
 	}
 
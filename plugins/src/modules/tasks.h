@@ -7,6 +7,7 @@
 #include <list>
 #include <memory>
 #include <functional>
+#include <vector>
 
 namespace tasks
 {
@@ -105,6 +106,11 @@ namespace tasks
 		{
 			return _state;
 		}
+		// the number of bytes allocated for the result and the handlers, excluding the handlers themselves
+		size_t heap_size() const
+		{
+			return (completed() ? _value.heap_size() : 0) + handlers.size() * (sizeof(std::unique_ptr<handler>) + 2 * sizeof(void*));
+		}
 		bool check_error(AMX *amx) const
 		{
 			if(completed())
@@ -226,10 +232,18 @@ namespace tasks
 	void clear();
 	void run_pending();
 
+	// may be called from any thread; the task is completed later on the main thread
+	void post_completed(cell id, cell value, tag_ptr tag);
+	void post_completed(cell id, const cell *arr, cell size, tag_ptr tag);
+	void post_faulted(cell id, cell error);
+	void run_posted();
+
 	std::shared_ptr<task> find(task *ptr);
 
 	void tick();
 	size_t size();
+	size_t memory_usage();
+	size_t handler_allocs();
 
 	extra &get_extra(AMX *amx, amx::object &owner);
 }
@@ -0,0 +1,184 @@
+#include "tracing.h"
+
+#include <vector>
+
+// events over the limit are only counted in the statistics
+static constexpr size_t max_events = 1 << 20;
+
+struct trace_event
+{
+	const tracing::handler_stats *stats;
+	cell id;
+	// in nanoseconds since the trace was started
+	long long start;
+	long long duration;
+};
+
+bool tracing::enabled = false;
+
+static std::unordered_map<cell, std::unique_ptr<tracing::handler_stats>> handlers;
+// statistics of removed handlers, kept while events or running invocations refer to them
+static std::unordered_map<const tracing::handler_stats*, std::unique_ptr<tracing::handler_stats>> retired;
+static std::vector<trace_event> events;
+static size_t dropped = 0;
+static tracing::clock::time_point origin = tracing::clock::now();
+
+static long long to_ns(tracing::clock::duration duration)
+{
+	return std::chrono::duration_cast<std::chrono::nanoseconds>(duration).count();
+}
+
+tracing::handler_stats &tracing::get(cell id)
+{
+	auto &stats = handlers[id];
+	if(!stats)
+	{
+		stats = std::make_unique<handler_stats>();
+	}
+	return *stats;
+}
+
+void tracing::remove(cell id)
+{
+	auto it = handlers.find(id);
+	if(it != handlers.end())
+	{
+		auto &stats = it->second;
+		if(stats->events > 0 || stats->running > 0)
+		{
+			stats->retired = true;
+			const handler_stats *ptr = stats.get();
+			retired.emplace(ptr, std::move(stats));
+		}
+		handlers.erase(it);
+	}
+}
+
+void tracing::record(cell id, handler_stats &stats, clock::time_point start, clock::time_point end)
+{
+	if(start < origin)
+	{
+		// the trace was reset while the handler was running, so only the rest is measured
+		start = origin;
+	}
+	long long duration = to_ns(end - start);
+	stats.count++;
+	stats.total += duration;
+	if(events.size() < max_events)
+	{
+		events.push_back({&stats, id, to_ns(start - origin), duration});
+		stats.events++;
+	}else{
+		dropped++;
+	}
+}
+
+void tracing::finish(handler_stats &stats)
+{
+	stats.running--;
+	if(stats.retired && stats.running == 0 && stats.events == 0)
+	{
+		retired.erase(&stats);
+	}
+}
+
+void tracing::reset()
+{
+	// the statistics may be in use by a running handler, so they are kept
+	for(auto &pair : handlers)
+	{
+		pair.second->count = 0;
+		pair.second->total = 0;
+		pair.second->events = 0;
+	}
+	for(auto it = retired.begin(); it != retired.end();)
+	{
+		if(it->second->running == 0)
+		{
+			it = retired.erase(it);
+		}else{
+			it->second->count = 0;
+			it->second->total = 0;
+			it->second->events = 0;
+			++it;
+		}
+	}
+	std::vector<trace_event>().swap(events);
+	dropped = 0;
+	origin = clock::now();
+}
+
+const std::unordered_map<cell, std::unique_ptr<tracing::handler_stats>> &tracing::get_all()
+{
+	return handlers;
+}
+
+size_t tracing::num_events()
+{
+	return events.size();
+}
+
+size_t tracing::num_dropped()
+{
+	return dropped;
+}
+
+static void write_json_string(std::ostream &stream, const std::string &str)
+{
+	stream << '"';
+	for(char c : str)
+	{
+		switch(c)
+		{
+			case '"':
+				stream << "\\\"";
+				break;
+			case '\\':
+				stream << "\\\\";
+				break;
+			default:
+				if(static_cast<unsigned char>(c) < 0x20)
+				{
+					stream << ' ';
+				}else{
+					stream << c;
+				}
+				break;
+		}
+	}
+	stream << '"';
+}
+
+static void write_us(std::ostream &stream, long long ns)
+{
+	stream << ns / 1000 << '.';
+	long long frac = ns % 1000;
+	if(frac < 100) stream << '0';
+	if(frac < 10) stream << '0';
+	stream << frac;
+}
+
+void tracing::write_trace(std::ostream &stream)
+{
+	stream << "{\"traceEvents\":[";
+	bool first = true;
+	for(const auto &ev : events)
+	{
+		const auto &stats = *ev.stats;
+		if(!first)
+		{
+			stream << ',';
+		}
+		first = false;
+		stream << "\n{\"name\":";
+		write_json_string(stream, stats.handler);
+		stream << ",\"cat\":\"" << stats.kind << "\",\"ph\":\"X\",\"ts\":";
+		write_us(stream, ev.start);
+		stream << ",\"dur\":";
+		write_us(stream, ev.duration);
+		stream << ",\"pid\":1,\"tid\":1,\"args\":{\"id\":" << ev.id << ",\"target\":";
+		write_json_string(stream, stats.target);
+		stream << "}}";
+	}
+	stream << "\n],\"displayTimeUnit\":\"ns\"}\n";
+}
@@ -0,0 +1,92 @@
+#ifndef TRACING_H_INCLUDED
+#define TRACING_H_INCLUDED
+
+#include "main.h"
+#include "fixes/linux.h"
+#include "sdk/amx/amx.h"
+#include <string>
+#include <chrono>
+#include <ostream>
+#include <memory>
+#include <unordered_map>
+
+namespace tracing
+{
+	// Measures the handlers registered for callbacks and native hooks.
+	// Every invocation is also stored as an event for the trace file.
+
+	typedef std::chrono::steady_clock clock;
+
+	struct handler_stats
+	{
+		// "callback" or "hook"
+		const char *kind = nullptr;
+		// the public function of the handler
+		std::string handler;
+		// the callback or native it is attached to
+		std::string target;
+		long long count = 0;
+		// in nanoseconds, including all code the handler runs
+		long long total = 0;
+		// invocations in progress
+		int running = 0;
+		// events in the trace that refer to the statistics
+		size_t events = 0;
+		// the handler was removed, so the statistics are deleted when nothing refers to them
+		bool retired = false;
+	};
+
+	extern bool enabled;
+
+	inline bool active()
+	{
+		return enabled && is_main_thread;
+	}
+
+	// the statistics of the handler with the id; the names are empty if it was not seen yet
+	handler_stats &get(cell id);
+	// called when the handler is removed, so that a new handler at the same address starts anew
+	void remove(cell id);
+	void record(cell id, handler_stats &stats, clock::time_point start, clock::time_point end);
+	// called when an invocation ends, deletes the statistics of a removed handler if they are no longer needed
+	void finish(handler_stats &stats);
+	// clears all counters and events
+	void reset();
+	// the statistics of the handlers that were not removed
+	const std::unordered_map<cell, std::unique_ptr<handler_stats>> &get_all();
+	size_t num_events();
+	size_t num_dropped();
+	// writes the events in the Chrome trace event format
+	void write_trace(std::ostream &stream);
+
+	class scope
+	{
+		cell id = 0;
+		handler_stats *stats = nullptr;
+		clock::time_point start;
+
+	public:
+		scope() = default;
+		scope(const scope&) = delete;
+		scope &operator=(const scope&) = delete;
+
+		void begin(cell id, handler_stats &stats)
+		{
+			this->id = id;
+			this->stats = &stats;
+			stats.running++;
+			start = clock::now();
+		}
+
+		~scope()
+		{
+			if(stats)
+			{
+				record(id, *stats, start, clock::now());
+				finish(*stats);
+			}
+		}
+	};
+}
+
+#endif
@@ -5,6 +5,8 @@
 #include "errors.h"
 #include "amxinfo.h"
 #include "modules/tags.h"
+#include "modules/native_stats.h"
+#include "modules/leaks.h"
 #include "sdk/amx/amx.h"
 #include <unordered_map>
 
@@ -60,9 +62,21 @@ namespace impl
 	template <AMX_NATIVE Native>
 	struct native_info;
 
+	// the index of the native in the call statistics
+	template <AMX_NATIVE Native>
+	struct native_slot
+	{
+		static const size_t index;
+	};
+
+	template <AMX_NATIVE Native>
+	const size_t native_slot<Native>::index = native_stats::add(native_info<Native>::name());
+
 	template <AMX_NATIVE Native>
 	static cell AMX_NATIVE_CALL adapt_native(AMX *amx, cell *params) noexcept
 	{
+		native_stats::scope stats(native_slot<Native>::index);
+		leaks::scope site(amx);
 		try{
 			if(params[0] < native_info<Native>::arg_count() * static_cast<cell>(sizeof(cell)))
 			{
@@ -168,6 +182,10 @@ int RegisterMathNatives(AMX *amx);
 int RegisterDebugNatives(AMX *amx);
 int RegisterPoolNatives(AMX *amx);
 int RegisterExprNatives(AMX *amx);
+int RegisterIndexNatives(AMX *amx);
+int RegisterBitSetNatives(AMX *amx);
+int RegisterProfilerNatives(AMX *amx);
+int RegisterSerializeNatives(AMX *amx);
 
 inline int RegisterNatives(AMX *amx)
 {
@@ -188,6 +206,10 @@ inline int RegisterNatives(AMX *amx)
 	RegisterDebugNatives(amx);
 	RegisterPoolNatives(amx);
 	RegisterExprNatives(amx);
+	RegisterIndexNatives(amx);
+	RegisterBitSetNatives(amx);
+	RegisterProfilerNatives(amx);
+	RegisterSerializeNatives(amx);
 	return AMX_ERR_NONE;
 }
 
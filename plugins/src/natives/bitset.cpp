@@ -0,0 +1,201 @@
+#include "natives.h"
+#include "errors.h"
+#include "modules/containers.h"
+
+namespace Natives
+{
+	// native BitSet:bitset_new();
+	AMX_DEFINE_NATIVE_TAG(bitset_new, 0, bitset)
+	{
+		return bitset_pool.get_id(bitset_pool.add());
+	}
+
+	// native BitSet:bitset_new_arr(const values[], size=sizeof(values));
+	AMX_DEFINE_NATIVE_TAG(bitset_new_arr, 2, bitset)
+	{
+		auto ptr = bitset_pool.add();
+		cell *arr = amx_GetAddrSafe(amx, params[1]);
+
+		for(cell i = 0; i < params[2]; i++)
+		{
+			ptr->insert(arr[i]);
+		}
+		return bitset_pool.get_id(ptr);
+	}
+
+	// native bool:bitset_valid(BitSet:set);
+	AMX_DEFINE_NATIVE_TAG(bitset_valid, 1, bool)
+	{
+		bitset_t *ptr;
+		return bitset_pool.get_by_id(params[1], ptr);
+	}
+
+	// native bitset_delete(BitSet:set);
+	AMX_DEFINE_NATIVE_TAG(bitset_delete, 1, cell)
+	{
+		bitset_t *ptr;
+		if(!bitset_pool.get_by_id(params[1], ptr)) amx_LogicError(errors::pointer_invalid, "bit set", params[1]);
+		return bitset_pool.remove(ptr);
+	}
+
+	// native BitSet:bitset_clone(BitSet:set);
+	AMX_DEFINE_NATIVE_TAG(bitset_clone, 1, bitset)
+	{
+		bitset_t *ptr;
+		if(!bitset_pool.get_by_id(params[1], ptr)) amx_LogicError(errors::pointer_invalid, "bit set", params[1]);
+		return bitset_pool.get_id(bitset_pool.add(bitset_t(*ptr)));
+	}
+
+	// native bitset_size(BitSet:set);
+	AMX_DEFINE_NATIVE_TAG(bitset_size, 1, cell)
+	{
+		bitset_t *ptr;
+		if(!bitset_pool.get_by_id(params[1], ptr)) amx_LogicError(errors::pointer_invalid, "bit set", params[1]);
+		return static_cast<cell>(ptr->size());
+	}
+
+	// native bitset_clear(BitSet:set);
+	AMX_DEFINE_NATIVE_TAG(bitset_clear, 1, cell)
+	{
+		bitset_t *ptr;
+		if(!bitset_pool.get_by_id(params[1], ptr)) amx_LogicError(errors::pointer_invalid, "bit set", params[1]);
+		bitset_t().swap(*ptr);
+		return 1;
+	}
+
+	// native bool:bitset_add(BitSet:set, value);
+	AMX_DEFINE_NATIVE_TAG(bitset_add, 2, bool)
+	{
+		bitset_t *ptr;
+		if(!bitset_pool.get_by_id(params[1], ptr)) amx_LogicError(errors::pointer_invalid, "bit set", params[1]);
+		return ptr->insert(params[2]);
+	}
+
+	// native bitset_add_arr(BitSet:set, const values[], size=sizeof(values));
+	AMX_DEFINE_NATIVE_TAG(bitset_add_arr, 3, cell)
+	{
+		bitset_t *ptr;
+		if(!bitset_pool.get_by_id(params[1], ptr)) amx_LogicError(errors::pointer_invalid, "bit set", params[1]);
+		cell *arr = amx_GetAddrSafe(amx, params[2]);
+		cell count = 0;
+		for(cell i = 0; i < params[3]; i++)
+		{
+			if(ptr->insert(arr[i]))
+			{
+				count++;
+			}
+		}
+		return count;
+	}
+
+	// native bool:bitset_remove(BitSet:set, value);
+	AMX_DEFINE_NATIVE_TAG(bitset_remove, 2, bool)
+	{
+		bitset_t *ptr;
+		if(!bitset_pool.get_by_id(params[1], ptr)) amx_LogicError(errors::pointer_invalid, "bit set", params[1]);
+		return ptr->erase(params[2]);
+	}
+
+	// native bool:bitset_contains(BitSet:set, value);
+	AMX_DEFINE_NATIVE_TAG(bitset_contains, 2, bool)
+	{
+		bitset_t *ptr;
+		if(!bitset_pool.get_by_id(params[1], ptr)) amx_LogicError(errors::pointer_invalid, "bit set", params[1]);
+		return ptr->contains(params[2]);
+	}
+
+	// native bool:bitset_equals(BitSet:set, BitSet:other);
+	AMX_DEFINE_NATIVE_TAG(bitset_equals, 2, bool)
+	{
+		bitset_t *ptr, *other;
+		if(!bitset_pool.get_by_id(params[1], ptr)) amx_LogicError(errors::pointer_invalid, "bit set", params[1]);
+		if(!bitset_pool.get_by_id(params[2], other)) amx_LogicError(errors::pointer_invalid, "bit set", params[2]);
+		return *ptr == *other;
+	}
+
+	// native bitset_union(BitSet:set, BitSet:other);
+	AMX_DEFINE_NATIVE_TAG(bitset_union, 2, cell)
+	{
+		bitset_t *ptr, *other;
+		if(!bitset_pool.get_by_id(params[1], ptr)) amx_LogicError(errors::pointer_invalid, "bit set", params[1]);
+		if(!bitset_pool.get_by_id(params[2], other)) amx_LogicError(errors::pointer_invalid, "bit set", params[2]);
+		ptr->unite(*other);
+		return static_cast<cell>(ptr->size());
+	}
+
+	// native bitset_intersect(BitSet:set, BitSet:other);
+	AMX_DEFINE_NATIVE_TAG(bitset_intersect, 2, cell)
+	{
+		bitset_t *ptr, *other;
+		if(!bitset_pool.get_by_id(params[1], ptr)) amx_LogicError(errors::pointer_invalid, "bit set", params[1]);
+		if(!bitset_pool.get_by_id(params[2], other)) amx_LogicError(errors::pointer_invalid, "bit set", params[2]);
+		ptr->intersect(*other);
+		return static_cast<cell>(ptr->size());
+	}
+
+	// native bitset_difference(BitSet:set, BitSet:other);
+	AMX_DEFINE_NATIVE_TAG(bitset_difference, 2, cell)
+	{
+		bitset_t *ptr, *other;
+		if(!bitset_pool.get_by_id(params[1], ptr)) amx_LogicError(errors::pointer_invalid, "bit set", params[1]);
+		if(!bitset_pool.get_by_id(params[2], other)) amx_LogicError(errors::pointer_invalid, "bit set", params[2]);
+		ptr->subtract(*other);
+		return static_cast<cell>(ptr->size());
+	}
+
+	// native bitset_get_arr(BitSet:set, values[], size=sizeof(values));
+	AMX_DEFINE_NATIVE_TAG(bitset_get_arr, 3, cell)
+	{
+		bitset_t *ptr;
+		if(!bitset_pool.get_by_id(params[1], ptr)) amx_LogicError(errors::pointer_invalid, "bit set", params[1]);
+		cell *arr = amx_GetAddrSafe(amx, params[2]);
+		cell size = params[3];
+		cell count = 0;
+		ptr->for_each([&](cell value)
+		{
+			if(count < size)
+			{
+				arr[count++] = value;
+			}
+		});
+		return count;
+	}
+
+	// native Iter:bitset_iter(BitSet:set);
+	AMX_DEFINE_NATIVE_TAG(bitset_iter, 1, iter)
+	{
+		std::shared_ptr<bitset_t> ptr;
+		if(!bitset_pool.get_by_id(params[1], ptr)) amx_LogicError(errors::pointer_invalid, "bit set", params[1]);
+		auto &iter = iter_pool.emplace_derived<bitset_iterator_t>(ptr);
+		return iter_pool.get_id(iter);
+	}
+}
+
+static AMX_NATIVE_INFO native_list[] =
+{
+	AMX_DECLARE_NATIVE(bitset_new),
+	AMX_DECLARE_NATIVE(bitset_new_arr),
+	AMX_DECLARE_NATIVE(bitset_valid),
+	AMX_DECLARE_NATIVE(bitset_delete),
+	AMX_DECLARE_NATIVE(bitset_clone),
+	AMX_DECLARE_NATIVE(bitset_size),
+	AMX_DECLARE_NATIVE(bitset_clear),
+
+	AMX_DECLARE_NATIVE(bitset_add),
+	AMX_DECLARE_NATIVE(bitset_add_arr),
+	AMX_DECLARE_NATIVE(bitset_remove),
+	AMX_DECLARE_NATIVE(bitset_contains),
+	AMX_DECLARE_NATIVE(bitset_equals),
+
+	AMX_DECLARE_NATIVE(bitset_union),
+	AMX_DECLARE_NATIVE(bitset_intersect),
+	AMX_DECLARE_NATIVE(bitset_difference),
+
+	AMX_DECLARE_NATIVE(bitset_get_arr),
+	AMX_DECLARE_NATIVE(bitset_iter),
+};
+
+int RegisterBitSetNatives(AMX *amx)
+{
+	return amx_Register(amx, native_list, sizeof(native_list) / sizeof(*native_list));
+}
@@ -0,0 +1,175 @@
+#include "natives.h"
+#include "errors.h"
+#include "modules/containers.h"
+#include "modules/expressions.h"
+#include "modules/indexes.h"
+
+static index_t *get_index(AMX *amx, cell id, std::shared_ptr<index_t> &ptr)
+{
+	if(!index_pool.get_by_id(id, ptr)) amx_LogicError(errors::pointer_invalid, "index", id);
+	if(ptr->expired()) amx_LogicError(errors::operation_not_supported, "index");
+	ptr->update(amx);
+	return ptr.get();
+}
+
+static cell make_iter(const std::shared_ptr<index_t> &ptr, size_t begin, size_t end)
+{
+	if(end < begin)
+	{
+		end = begin;
+	}
+	auto &iter = iter_pool.emplace_derived<index_iterator_t>(ptr, begin, end);
+	return iter_pool.get_id(iter);
+}
+
+namespace Natives
+{
+	// native Index:index_new_list(List:list, offset=0);
+	AMX_DEFINE_NATIVE_TAG(index_new_list, 1, index)
+	{
+		std::shared_ptr<list_t> ptr;
+		if(!list_pool.get_by_id(params[1], ptr)) amx_LogicError(errors::pointer_invalid, "list", params[1]);
+		cell offset = optparam(2, 0);
+		if(offset < -1) amx_LogicError(errors::out_of_range, "offset");
+		return index_pool.get_id(index_pool.emplace(ptr, offset));
+	}
+
+	// native Index:index_new_list_expr(List:list, Expression:key);
+	AMX_DEFINE_NATIVE_TAG(index_new_list_expr, 2, index)
+	{
+		std::shared_ptr<list_t> ptr;
+		if(!list_pool.get_by_id(params[1], ptr)) amx_LogicError(errors::pointer_invalid, "list", params[1]);
+		expression_ptr expr;
+		if(!expression_pool.get_by_id(params[2], expr)) amx_LogicError(errors::pointer_invalid, "expression", params[2]);
+		return index_pool.get_id(index_pool.emplace(ptr, std::move(expr)));
+	}
+
+	// native Index:index_new_map(Map:map, offset=0);
+	AMX_DEFINE_NATIVE_TAG(index_new_map, 1, index)
+	{
+		std::shared_ptr<map_t> ptr;
+		if(!map_pool.get_by_id(params[1], ptr)) amx_LogicError(errors::pointer_invalid, "map", params[1]);
+		cell offset = optparam(2, 0);
+		if(offset < -1) amx_LogicError(errors::out_of_range, "offset");
+		return index_pool.get_id(index_pool.emplace(ptr, offset));
+	}
+
+	// native Index:index_new_map_expr(Map:map, Expression:key);
+	AMX_DEFINE_NATIVE_TAG(index_new_map_expr, 2, index)
+	{
+		std::shared_ptr<map_t> ptr;
+		if(!map_pool.get_by_id(params[1], ptr)) amx_LogicError(errors::pointer_invalid, "map", params[1]);
+		expression_ptr expr;
+		if(!expression_pool.get_by_id(params[2], expr)) amx_LogicError(errors::pointer_invalid, "expression", params[2]);
+		return index_pool.get_id(index_pool.emplace(ptr, std::move(expr)));
+	}
+
+	// native bool:index_valid(Index:index);
+	AMX_DEFINE_NATIVE_TAG(index_valid, 1, bool)
+	{
+		index_t *ptr;
+		return index_pool.get_by_id(params[1], ptr) && !ptr->expired();
+	}
+
+	// native index_delete(Index:index);
+	AMX_DEFINE_NATIVE_TAG(index_delete, 1, cell)
+	{
+		index_t *ptr;
+		if(!index_pool.get_by_id(params[1], ptr)) amx_LogicError(errors::pointer_invalid, "index", params[1]);
+		return index_pool.remove(ptr);
+	}
+
+	// native index_size(Index:index);
+	AMX_DEFINE_NATIVE_TAG(index_size, 1, cell)
+	{
+		std::shared_ptr<index_t> ptr;
+		return static_cast<cell>(get_index(amx, params[1], ptr)->size());
+	}
+
+	// native index_rebuild(Index:index);
+	AMX_DEFINE_NATIVE_TAG(index_rebuild, 1, cell)
+	{
+		std::shared_ptr<index_t> ptr;
+		if(!index_pool.get_by_id(params[1], ptr)) amx_LogicError(errors::pointer_invalid, "index", params[1]);
+		if(ptr->expired()) amx_LogicError(errors::operation_not_supported, "index");
+		ptr->rebuild(amx);
+		return static_cast<cell>(ptr->size());
+	}
+
+	// native Iter:index_iter(Index:index);
+	AMX_DEFINE_NATIVE_TAG(index_iter, 1, iter)
+	{
+		std::shared_ptr<index_t> ptr;
+		get_index(amx, params[1], ptr);
+		return make_iter(ptr, 0, ptr->size());
+	}
+
+	// native Iter:index_range(Index:index, AnyTag:lower, AnyTag:upper, TagTag:lower_tag_id=tagof(lower), TagTag:upper_tag_id=tagof(upper));
+	AMX_DEFINE_NATIVE_TAG(index_range, 5, iter)
+	{
+		std::shared_ptr<index_t> ptr;
+		get_index(amx, params[1], ptr);
+		size_t begin = ptr->lower_bound(dyn_object(amx, params[2], params[4]));
+		size_t end = ptr->upper_bound(dyn_object(amx, params[3], params[5]));
+		return make_iter(ptr, begin, end);
+	}
+
+	// native Iter:index_equal(Index:index, AnyTag:value, TagTag:tag_id=tagof(value));
+	AMX_DEFINE_NATIVE_TAG(index_equal, 3, iter)
+	{
+		std::shared_ptr<index_t> ptr;
+		get_index(amx, params[1], ptr);
+		dyn_object key(amx, params[2], params[3]);
+		return make_iter(ptr, ptr->lower_bound(key), ptr->upper_bound(key));
+	}
+
+	// native Iter:index_from(Index:index, AnyTag:lower, TagTag:tag_id=tagof(lower));
+	AMX_DEFINE_NATIVE_TAG(index_from, 3, iter)
+	{
+		std::shared_ptr<index_t> ptr;
+		get_index(amx, params[1], ptr);
+		return make_iter(ptr, ptr->lower_bound(dyn_object(amx, params[2], params[3])), ptr->size());
+	}
+
+	// native Iter:index_to(Index:index, AnyTag:upper, TagTag:tag_id=tagof(upper));
+	AMX_DEFINE_NATIVE_TAG(index_to, 3, iter)
+	{
+		std::shared_ptr<index_t> ptr;
+		get_index(amx, params[1], ptr);
+		return make_iter(ptr, 0, ptr->upper_bound(dyn_object(amx, params[2], params[3])));
+	}
+
+	// native index_count_range(Index:index, AnyTag:lower, AnyTag:upper, TagTag:lower_tag_id=tagof(lower), TagTag:upper_tag_id=tagof(upper));
+	AMX_DEFINE_NATIVE_TAG(index_count_range, 5, cell)
+	{
+		std::shared_ptr<index_t> ptr;
+		get_index(amx, params[1], ptr);
+		size_t begin = ptr->lower_bound(dyn_object(amx, params[2], params[4]));
+		size_t end = ptr->upper_bound(dyn_object(amx, params[3], params[5]));
+		return end > begin ? static_cast<cell>(end - begin) : 0;
+	}
+}
+
+static AMX_NATIVE_INFO native_list[] =
+{
+	AMX_DECLARE_NATIVE(index_new_list),
+	AMX_DECLARE_NATIVE(index_new_list_expr),
+	AMX_DECLARE_NATIVE(index_new_map),
+	AMX_DECLARE_NATIVE(index_new_map_expr),
+	AMX_DECLARE_NATIVE(index_valid),
+	AMX_DECLARE_NATIVE(index_delete),
+	AMX_DECLARE_NATIVE(index_size),
+	AMX_DECLARE_NATIVE(index_rebuild),
+
+	AMX_DECLARE_NATIVE(index_iter),
+	AMX_DECLARE_NATIVE(index_range),
+	AMX_DECLARE_NATIVE(index_equal),
+	AMX_DECLARE_NATIVE(index_from),
+	AMX_DECLARE_NATIVE(index_to),
+	AMX_DECLARE_NATIVE(index_count_range),
+};
+
+int RegisterIndexNatives(AMX *amx)
+{
+	return amx_Register(amx, native_list, sizeof(native_list) / sizeof(*native_list));
+}
@@ -5,6 +5,7 @@
 #include "modules/strings.h"
 #include "modules/expressions.h"
 #include "modules/iterators.h"
+#include "modules/snapshots.h"
 #include "objects/dyn_object.h"
 #include "fixes/linux.h"
 
@@ -156,7 +157,18 @@ public:
 	static cell AMX_NATIVE_CALL map_iter_at(AMX *amx, cell *params)
 	{
 		std::shared_ptr<map_t> ptr;
-		if(!map_pool.get_by_id(params[1], ptr)) amx_LogicError(errors::pointer_invalid, "map", params[1]);
+		if(!map_pool.get_by_id(params[1], ptr))
+		{
+			std::shared_ptr<snapshot_t> snapshot;
+			if(!snapshot_pool.get_by_id(params[1], snapshot) || !snapshot->is_map()) amx_LogicError(errors::pointer_invalid, "map", params[1]);
+			size_t index;
+			if(!snapshot->find(KeyFactory(amx, params[KeyIndices]...), index))
+			{
+				index = snapshot->size();
+			}
+			auto &iter = iter_pool.emplace_derived<snapshot_iterator_t>(snapshot, index);
+			return iter_pool.get_id(iter);
+		}
 
 		auto &iter = iter_pool.add(std::make_unique<map_iterator_t>(ptr, ptr->find(KeyFactory(amx, params[KeyIndices]...))));
 		return iter_pool.get_id(iter);
@@ -219,29 +231,38 @@ static cell AMX_NATIVE_CALL iter_set_cells_md(AMX *amx, cell *params)
 	});
 }
 
+// moves a new iterator to the index, or outside if it is negative
+static cell iter_from_index(object_pool<dyn_iterator>::object_ptr iter, cell index)
+{
+	if(index < 0)
+	{
+		iter->reset();
+	}else{
+		for(cell i = 0; i < index; i++)
+		{
+			if(!iter->move_next())
+			{
+				break;
+			}
+		}
+	}
+	return iter_pool.get_id(iter);
+}
+
 namespace Natives
 {
 	// native Iter:list_iter(List:list, index=0);
 	AMX_DEFINE_NATIVE_TAG(list_iter, 1, iter)
 	{
 		std::shared_ptr<list_t> ptr;
-		if(!list_pool.get_by_id(params[1], ptr)) amx_LogicError(errors::pointer_invalid, "list", params[1]);
-		
-		auto &iter = iter_pool.emplace_derived<list_iterator_t>(ptr);
-		cell index = optparam(2, 0);
-		if(index < 0)
+		if(!list_pool.get_by_id(params[1], ptr))
 		{
-			iter->reset();
-		}else{
-			for(cell i = 0; i < index; i++)
-			{
-				if(!iter->move_next())
-				{
-					break;
-				}
-			}
+			std::shared_ptr<snapshot_t> snapshot;
+			if(!snapshot_pool.get_by_id(params[1], snapshot) || snapshot->is_map()) amx_LogicError(errors::pointer_invalid, "list", params[1]);
+			return iter_from_index(iter_pool.emplace_derived<snapshot_iterator_t>(snapshot), optparam(2, 0));
 		}
-		return iter_pool.get_id(iter);
+		
+		return iter_from_index(iter_pool.emplace_derived<list_iterator_t>(ptr), optparam(2, 0));
 	}
 
 	// native list_add_iter(List:list, Iter:iter, index=-1);
@@ -283,23 +304,14 @@ namespace Natives
 	AMX_DEFINE_NATIVE_TAG(map_iter, 1, iter)
 	{
 		std::shared_ptr<map_t> ptr;
-		if(!map_pool.get_by_id(params[1], ptr)) amx_LogicError(errors::pointer_invalid, "map", params[1]);
-		
-		auto &iter = iter_pool.emplace_derived<map_iterator_t>(ptr);
-		cell index = optparam(2, 0);
-		if(index < 0)
+		if(!map_pool.get_by_id(params[1], ptr))
 		{
-			iter->reset();
-		}else{
-			for(cell i = 0; i < index; i++)
-			{
-				if(!iter->move_next())
-				{
-					break;
-				}
-			}
+			std::shared_ptr<snapshot_t> snapshot;
+			if(!snapshot_pool.get_by_id(params[1], snapshot) || !snapshot->is_map()) amx_LogicError(errors::pointer_invalid, "map", params[1]);
+			return iter_from_index(iter_pool.emplace_derived<snapshot_iterator_t>(snapshot), optparam(2, 0));
 		}
-		return iter_pool.get_id(iter);
+		
+		return iter_from_index(iter_pool.emplace_derived<map_iterator_t>(ptr), optparam(2, 0));
 	}
 
 	// native Iter:map_iter_at(Map:map, AnyTag:key, TagTag:key_tag_id=tagof(key));
@@ -748,6 +760,68 @@ namespace Natives
 		return iter_pool.get_id(iter_pool.emplace_derived<project_iterator>(std::move(iter), std::move(expr)));
 	}
 
+	// native iter_get_range(IterTag:iter, AnyTag:values[], offset=0, size=sizeof(values));
+	AMX_DEFINE_NATIVE_TAG(iter_get_range, 4, cell)
+	{
+		if(params[3] < 0) amx_LogicError(errors::out_of_range, "offset");
+		if(params[4] < 0) amx_LogicError(errors::out_of_range, "size");
+		dyn_iterator *iter;
+		if(!iter_pool.get_by_id(params[1], iter)) amx_LogicError(errors::pointer_invalid, "iterator", params[1]);
+		cell *addr = amx_GetAddrSafe(amx, params[2]);
+		cell count = 0;
+		while(count < params[4] && iter->valid())
+		{
+			addr[count++] = value_read(iter, [&](const dyn_object &obj)
+			{
+				return obj.get_cell(params[3]);
+			});
+			if(!iter->move_next())
+			{
+				break;
+			}
+		}
+		return count;
+	}
+
+	// native iter_get_key_range(IterTag:iter, AnyTag:keys[], offset=0, size=sizeof(keys));
+	AMX_DEFINE_NATIVE_TAG(iter_get_key_range, 4, cell)
+	{
+		if(params[3] < 0) amx_LogicError(errors::out_of_range, "offset");
+		if(params[4] < 0) amx_LogicError(errors::out_of_range, "size");
+		dyn_iterator *iter;
+		if(!iter_pool.get_by_id(params[1], iter)) amx_LogicError(errors::pointer_invalid, "iterator", params[1]);
+		cell *addr = amx_GetAddrSafe(amx, params[2]);
+		cell count = 0;
+		while(count < params[4] && iter->valid())
+		{
+			addr[count++] = key_read(iter, [&](const dyn_object &obj)
+			{
+				return obj.get_cell(params[3]);
+			});
+			if(!iter->move_next())
+			{
+				break;
+			}
+		}
+		return count;
+	}
+
+	// native Iter:iter_insert_range(IterTag:iter, const AnyTag:values[], size=sizeof(values), TagTag:tag_id=tagof(values));
+	AMX_DEFINE_NATIVE_TAG(iter_insert_range, 4, iter)
+	{
+		if(params[3] < 0) amx_LogicError(errors::out_of_range, "size");
+		dyn_iterator *iter;
+		if(!iter_pool.get_by_id(params[1], iter)) amx_LogicError(errors::pointer_invalid, "iterator", params[1]);
+		cell *addr = amx_GetAddrSafe(amx, params[2]);
+		auto tag = tags::find_tag(amx, params[4]);
+		// each insertion lands before the previous one, so go backwards to keep the order
+		for(cell i = params[3] - 1; i >= 0; i--)
+		{
+			if(!iter->insert(dyn_object(addr[i], tag))) amx_LogicError(errors::operation_not_supported, "iterator");
+		}
+		return params[1];
+	}
+
 	// native Iter:iter_move_next(IterTag:iter, steps=1);
 	AMX_DEFINE_NATIVE_TAG(iter_move_next, 1, iter)
 	{
@@ -1319,6 +1393,10 @@ static AMX_NATIVE_INFO native_list[] =
 	AMX_DECLARE_NATIVE(iter_filter),
 	AMX_DECLARE_NATIVE(iter_project),
 
+	AMX_DECLARE_NATIVE(iter_get_range),
+	AMX_DECLARE_NATIVE(iter_get_key_range),
+	AMX_DECLARE_NATIVE(iter_insert_range),
+
 	AMX_DECLARE_NATIVE(iter_move_next),
 	AMX_DECLARE_NATIVE(iter_move_previous),
 	AMX_DECLARE_NATIVE(iter_to_first),
@@ -67,9 +67,9 @@ public:
 		linked_list_t *ptr;
 		if(!linked_list_pool.get_by_id(params[1], ptr)) amx_LogicError(errors::pointer_invalid, "linked list", params[1]);
 		auto find = Factory(amx, params[Indices]...);
-		return std::count_if(ptr->begin(), ptr->end(), [&](const std::shared_ptr<dyn_object> &obj)
+		return std::count_if(ptr->begin(), ptr->end(), [&](const dyn_object &obj)
 		{
-			return *obj == find;
+			return obj == find;
 		});
 	}
 };
@@ -200,7 +200,7 @@ namespace Natives
 		linked_list_pool.remove(ptr);
 		for(auto &obj : old)
 		{
-			obj->release();
+			obj.release();
 		}
 		return 1;
 	}
@@ -213,7 +213,7 @@ namespace Natives
 		auto l = linked_list_pool.add();
 		for(auto &&obj : *ptr)
 		{
-			l->push_back(obj->clone());
+			l->push_back(obj.clone());
 		}
 		return linked_list_pool.get_id(l);
 	}
@@ -244,7 +244,7 @@ namespace Natives
 		ptr->swap(old);
 		for(auto &obj : old)
 		{
-			obj->release();
+			obj.release();
 		}
 		return 1;
 	}
@@ -395,7 +395,7 @@ namespace Natives
 		if(static_cast<ucell>(params[2]) >= ptr->size()) amx_LogicError(errors::out_of_range, "index");
 		auto it = ptr->begin();
 		std::advance(it, params[2]);
-		(*it)->release();
+		it->release();
 		ptr->erase(it);
 		return 1;
 	}
@@ -529,9 +529,9 @@ namespace Natives
 		{
 			if(args.size() == 0)
 			{
-				args.push_back(std::cref(**it));
+				args.push_back(std::cref(*it));
 			}else{
-				args[0] = std::cref(**it);
+				args[0] = std::cref(*it);
 			}
 			if(expr->execute_bool(args, info))
 			{
@@ -561,13 +561,13 @@ namespace Natives
 		{
 			if(args.size() == 0)
 			{
-				args.push_back(std::cref(**it));
+				args.push_back(std::cref(*it));
 			}else{
-				args[0] = std::cref(**it);
+				args[0] = std::cref(*it);
 			}
 			if(expr->execute_bool(args, info))
 			{
-				(*it)->release();
+				it->release();
 				it = ptr->erase(it);
 				count++;
 			}else{
@@ -618,13 +618,13 @@ namespace Natives
 		expression::args_type args;
 		expression::exec_info info(amx);
 
-		return std::count_if(ptr->begin(), ptr->end(), [&](const std::shared_ptr<dyn_object> &obj)
+		return std::count_if(ptr->begin(), ptr->end(), [&](const dyn_object &obj)
 		{
 			if(args.size() == 0)
 			{
-				args.push_back(std::cref(*obj));
+				args.push_back(std::cref(obj));
 			}else{
-				args[0] = std::cref(*obj);
+				args[0] = std::cref(obj);
 			}
 			return expr->execute_bool(args, info);
 		});
@@ -4,10 +4,21 @@
 #include "modules/variants.h"
 #include "modules/expressions.h"
 #include "modules/tag_ops.h"
+#include "modules/snapshots.h"
+#include "utils/radix_sort.h"
+#include "utils/cell_search.h"
 
 #include <vector>
 #include <algorithm>
 
+// Obtains the snapshot opened as a list if the id does not belong to a list
+static snapshot_t *list_snapshot(cell id)
+{
+	snapshot_t *ptr;
+	if(!snapshot_pool.get_by_id(id, ptr) || ptr->is_map()) amx_LogicError(errors::pointer_invalid, "list", id);
+	return ptr;
+}
+
 template <size_t... Indices>
 class value_at
 {
@@ -32,7 +43,7 @@ public:
 			amx_LogicError(errors::out_of_range, "index");
 			return 0;
 		}else{
-			ptr->insert(ptr->begin() + index, Factory(amx, params[Indices]...));
+			ptr->insert_at(index, Factory(amx, params[Indices]...));
 			return index;
 		}
 	}
@@ -45,7 +56,7 @@ public:
 		list_t *ptr;
 		if(!list_pool.get_by_id(params[1], ptr)) amx_LogicError(errors::pointer_invalid, "list", params[1]);
 		if(static_cast<ucell>(params[2]) >= ptr->size()) amx_LogicError(errors::out_of_range, "index");
-		(*ptr)[params[2]] = Factory(amx, params[Indices]...);
+		ptr->set(params[2], Factory(amx, params[Indices]...));
 		return 1;
 	}
 
@@ -55,8 +66,17 @@ public:
 	{
 		if(params[2] < 0) amx_LogicError(errors::out_of_range, "index");
 		list_t *ptr;
-		if(!list_pool.get_by_id(params[1], ptr)) amx_LogicError(errors::pointer_invalid, "list", params[1]);
+		if(!list_pool.get_by_id(params[1], ptr))
+		{
+			auto snapshot = list_snapshot(params[1]);
+			if(static_cast<ucell>(params[2]) >= snapshot->size()) amx_LogicError(errors::out_of_range, "index");
+			return Factory(amx, snapshot->value_at(params[2]), params[Indices]...);
+		}
 		if(static_cast<ucell>(params[2]) >= ptr->size()) amx_LogicError(errors::out_of_range, "index");
+		if(ptr->is_typed())
+		{
+			return Factory(amx, dyn_object(ptr->get_cells()[params[2]], ptr->get_cell_tag()), params[Indices]...);
+		}
 		return Factory(amx, (*ptr)[params[2]], params[Indices]...);
 	}
 	
@@ -75,9 +95,30 @@ public:
 		{
 			if(index < 0 || static_cast<ucell>(index) >= ptr->size()) amx_LogicError(errors::out_of_range, "index");
 			auto find = Factory(amx, params[Indices]...);
+			element_matcher matches(find);
+			if(ptr->is_typed())
+			{
+				const auto &cells = ptr->get_cells();
+				tag_ptr tag = ptr->get_cell_tag();
+				cell key;
+				if(matches.cell_key(tag, key))
+				{
+					const cell *end = cells.data() + cells.size();
+					const cell *it = aux::find_cell(cells.data() + index, end, key);
+					return it != end ? static_cast<cell>(it - cells.data()) : -1;
+				}
+				for(size_t i = static_cast<size_t>(index); i < cells.size(); i++)
+				{
+					if(matches(cells[i], tag))
+					{
+						return static_cast<cell>(i);
+					}
+				}
+				return -1;
+			}
 			for(size_t i = static_cast<size_t>(index); i < ptr->size(); i++)
 			{
-				if((*ptr)[i] == find)
+				if(matches((*ptr)[i]))
 				{
 					return static_cast<cell>(i);
 				}
@@ -101,9 +142,31 @@ public:
 		{
 			if(index < 0 || static_cast<ucell>(index) >= ptr->size()) amx_LogicError(errors::out_of_range, "index");
 			auto find = Factory(amx, params[Indices]...);
+			element_matcher matches(find);
+			if(ptr->is_typed())
+			{
+				const auto &cells = ptr->get_cells();
+				tag_ptr tag = ptr->get_cell_tag();
+				cell key;
+				if(matches.cell_key(tag, key))
+				{
+					const cell *end = cells.data() + index + 1;
+					const cell *it = aux::find_last_cell(cells.data(), end, key);
+					return it != end ? static_cast<cell>(it - cells.data()) : -1;
+				}
+				while(index >= 0)
+				{
+					if(matches(cells[index], tag))
+					{
+						return index;
+					}
+					index--;
+				}
+				return -1;
+			}
 			while(index >= 0)
 			{
-				if((*ptr)[index] == find)
+				if(matches((*ptr)[index]))
 				{
 					return index;
 				}
@@ -136,7 +199,20 @@ public:
 	{
 		list_t *ptr;
 		if(!list_pool.get_by_id(params[1], ptr)) amx_LogicError(errors::pointer_invalid, "list", params[1]);
-		return std::count(ptr->begin(), ptr->end(), Factory(amx, params[Indices]...));
+		auto find = Factory(amx, params[Indices]...);
+		element_matcher matches(find);
+		if(ptr->is_typed())
+		{
+			tag_ptr tag = ptr->get_cell_tag();
+			const auto &cells = ptr->get_cells();
+			cell key;
+			if(matches.cell_key(tag, key))
+			{
+				return static_cast<cell>(aux::count_cell(cells.data(), cells.data() + cells.size(), key));
+			}
+			return std::count_if(cells.begin(), cells.end(), [&](cell value){ return matches(value, tag); });
+		}
+		return std::count_if(ptr->begin(), ptr->end(), matches);
 	}
 };
 
@@ -152,6 +228,7 @@ static cell AMX_NATIVE_CALL list_set_cell(AMX *amx, cell *params)
 	auto &obj = (*ptr)[params[2]];
 	if(TagIndex && !obj.tag_assignable(amx, params[TagIndex])) return 0;
 	obj.set_cell({params[3]}, params[4]);
+	ptr->touch_at(params[2]);
 	return 1;
 }
 
@@ -245,14 +322,18 @@ namespace Natives
 	AMX_DEFINE_NATIVE_TAG(list_valid, 1, bool)
 	{
 		list_t *ptr;
-		return list_pool.get_by_id(params[1], ptr);
+		snapshot_t *snapshot;
+		return list_pool.get_by_id(params[1], ptr) || (snapshot_pool.get_by_id(params[1], snapshot) && !snapshot->is_map());
 	}
 
 	// native list_delete(List:list);
 	AMX_DEFINE_NATIVE_TAG(list_delete, 1, cell)
 	{
 		list_t *ptr;
-		if(!list_pool.get_by_id(params[1], ptr)) amx_LogicError(errors::pointer_invalid, "list", params[1]);
+		if(!list_pool.get_by_id(params[1], ptr))
+		{
+			return snapshot_pool.remove(list_snapshot(params[1]));
+		}
 		return list_pool.remove(ptr);
 	}
 
@@ -288,7 +369,10 @@ namespace Natives
 	AMX_DEFINE_NATIVE_TAG(list_size, 1, cell)
 	{
 		list_t *ptr;
-		if(!list_pool.get_by_id(params[1], ptr)) amx_LogicError(errors::pointer_invalid, "list", params[1]);
+		if(!list_pool.get_by_id(params[1], ptr))
+		{
+			return static_cast<cell>(list_snapshot(params[1])->size());
+		}
 		return static_cast<cell>(ptr->size());
 	}
 
@@ -453,7 +537,7 @@ namespace Natives
 		list_t *ptr;
 		if(!list_pool.get_by_id(params[1], ptr)) amx_LogicError(errors::pointer_invalid, "list", params[1]);
 		if(static_cast<ucell>(params[2]) >= ptr->size()) amx_LogicError(errors::out_of_range, "index");
-		ptr->erase(ptr->begin() + params[2]);
+		ptr->erase_at(params[2], params[2] + 1);
 		return 1;
 	}
 
@@ -465,9 +549,13 @@ namespace Natives
 		if(!list_pool.get_by_id(params[1], ptr)) amx_LogicError(errors::pointer_invalid, "list", params[1]);
 		if(static_cast<ucell>(params[2]) >= ptr->size()) amx_LogicError(errors::out_of_range, "index");
 
-		auto it = ptr->begin() + params[2];
-		it->release();
-		ptr->erase(it);
+		if(ptr->is_typed())
+		{
+			dyn_object(ptr->get_cells()[params[2]], ptr->get_cell_tag()).release();
+		}else{
+			(*ptr)[params[2]].release();
+		}
+		ptr->erase_at(params[2], params[2] + 1);
 		return 1;
 	}
 
@@ -482,7 +570,7 @@ namespace Natives
 		ucell end = params[3];
 		if(begin >= ptr->size()) amx_LogicError(errors::out_of_range, "begin");
 		if(end >= ptr->size() || end < begin) amx_LogicError(errors::out_of_range, "end");
-		ptr->erase(ptr->begin() + params[2], ptr->begin() + params[3]);
+		ptr->erase_at(begin, end);
 		return 1;
 	}
 
@@ -499,9 +587,14 @@ namespace Natives
 		if(end >= ptr->size() || end < begin) amx_LogicError(errors::out_of_range, "end");
 		for(ucell i = begin; i <= end; i++)
 		{
-			(*ptr)[i].release();
+			if(ptr->is_typed())
+			{
+				dyn_object(ptr->get_cells()[i], ptr->get_cell_tag()).release();
+			}else{
+				(*ptr)[i].release();
+			}
 		}
-		ptr->erase(ptr->begin() + params[2], ptr->begin() + params[3]);
+		ptr->erase_at(begin, end);
 		return 1;
 	}
 
@@ -553,6 +646,113 @@ namespace Natives
 		return value_at<0>::list_get<dyn_func_str_s>(amx, params);
 	}
 
+	// native list_get_range(List:list, AnyTag:values[], index=0, offset=0, size=sizeof(values));
+	AMX_DEFINE_NATIVE_TAG(list_get_range, 5, cell)
+	{
+		if(params[3] < 0) amx_LogicError(errors::out_of_range, "index");
+		if(params[4] < 0) amx_LogicError(errors::out_of_range, "offset");
+		if(params[5] < 0) amx_LogicError(errors::out_of_range, "size");
+		list_t *ptr;
+		if(!list_pool.get_by_id(params[1], ptr)) amx_LogicError(errors::pointer_invalid, "list", params[1]);
+		if(static_cast<ucell>(params[3]) > ptr->size()) amx_LogicError(errors::out_of_range, "index");
+		cell *addr = amx_GetAddrSafe(amx, params[2]);
+		size_t count = std::min(ptr->size() - params[3], static_cast<size_t>(params[5]));
+		if(ptr->is_typed() && count > 0)
+		{
+			if(params[4] != 0) amx_LogicError(errors::out_of_range, "offset");
+			std::copy_n(ptr->get_cells().begin() + params[3], count, addr);
+			return static_cast<cell>(count);
+		}
+		for(size_t i = 0; i < count; i++)
+		{
+			addr[i] = (*ptr)[params[3] + i].get_cell(params[4]);
+		}
+		return static_cast<cell>(count);
+	}
+
+	// native list_get_range_safe(List:list, AnyTag:values[], index=0, offset=0, size=sizeof(values), TagTag:tag_id=tagof(values));
+	AMX_DEFINE_NATIVE_TAG(list_get_range_safe, 6, cell)
+	{
+		if(params[3] < 0) amx_LogicError(errors::out_of_range, "index");
+		if(params[4] < 0) amx_LogicError(errors::out_of_range, "offset");
+		if(params[5] < 0) amx_LogicError(errors::out_of_range, "size");
+		list_t *ptr;
+		if(!list_pool.get_by_id(params[1], ptr)) amx_LogicError(errors::pointer_invalid, "list", params[1]);
+		if(static_cast<ucell>(params[3]) > ptr->size()) amx_LogicError(errors::out_of_range, "index");
+		cell *addr = amx_GetAddrSafe(amx, params[2]);
+		auto tag = tags::find_tag(amx, params[6]);
+		size_t count = std::min(ptr->size() - params[3], static_cast<size_t>(params[5]));
+		if(ptr->is_typed() && count > 0)
+		{
+			const auto &cells = ptr->get_cells();
+			if(!dyn_object(cells[params[3]], ptr->get_cell_tag()).tag_assignable(tag))
+			{
+				return 0;
+			}
+			if(params[4] != 0) amx_LogicError(errors::out_of_range, "offset");
+			std::copy_n(cells.begin() + params[3], count, addr);
+			return static_cast<cell>(count);
+		}
+		for(size_t i = 0; i < count; i++)
+		{
+			const auto &obj = (*ptr)[params[3] + i];
+			if(!obj.tag_assignable(tag))
+			{
+				return static_cast<cell>(i);
+			}
+			addr[i] = obj.get_cell(params[4]);
+		}
+		return static_cast<cell>(count);
+	}
+
+	// native list_add_range(List:list, const AnyTag:values[], index=-1, size=sizeof(values), TagTag:tag_id=tagof(values));
+	AMX_DEFINE_NATIVE_TAG(list_add_range, 5, cell)
+	{
+		cell index = params[3];
+		if(index < -1) amx_LogicError(errors::out_of_range, "index");
+		if(params[4] < 0) amx_LogicError(errors::out_of_range, "size");
+		list_t *ptr;
+		if(!list_pool.get_by_id(params[1], ptr)) amx_LogicError(errors::pointer_invalid, "list", params[1]);
+		if(index != -1 && static_cast<ucell>(index) > ptr->size()) amx_LogicError(errors::out_of_range, "index");
+		cell *addr = amx_GetAddrSafe(amx, params[2]);
+		auto tag = tags::find_tag(amx, params[5]);
+		if(index == -1)
+		{
+			index = static_cast<cell>(ptr->size());
+			ptr->reserve(ptr->size() + params[4]);
+			for(cell i = 0; i < params[4]; i++)
+			{
+				ptr->push_back(dyn_object(addr[i], tag));
+			}
+		}else{
+			std::vector<dyn_object> values;
+			values.reserve(params[4]);
+			for(cell i = 0; i < params[4]; i++)
+			{
+				values.emplace_back(addr[i], tag);
+			}
+			ptr->insert(ptr->begin() + index, std::make_move_iterator(values.begin()), std::make_move_iterator(values.end()));
+		}
+		return index;
+	}
+
+	// native list_set_range(List:list, index, const AnyTag:values[], size=sizeof(values), TagTag:tag_id=tagof(values));
+	AMX_DEFINE_NATIVE_TAG(list_set_range, 5, cell)
+	{
+		if(params[2] < 0) amx_LogicError(errors::out_of_range, "index");
+		if(params[4] < 0) amx_LogicError(errors::out_of_range, "size");
+		list_t *ptr;
+		if(!list_pool.get_by_id(params[1], ptr)) amx_LogicError(errors::pointer_invalid, "list", params[1]);
+		if(static_cast<ucell>(params[2]) + static_cast<ucell>(params[4]) > ptr->size()) amx_LogicError(errors::out_of_range, "size");
+		cell *addr = amx_GetAddrSafe(amx, params[3]);
+		auto tag = tags::find_tag(amx, params[5]);
+		for(cell i = 0; i < params[4]; i++)
+		{
+			ptr->set(params[2] + i, dyn_object(addr[i], tag));
+		}
+		return params[4];
+	}
+
 	// native list_set(List:list, index, AnyTag:value, TagTag:tag_id=tagof(value));
 	AMX_DEFINE_NATIVE_TAG(list_set, 4, cell)
 	{
@@ -641,8 +841,17 @@ namespace Natives
 	{
 		if(params[2] < 0) amx_LogicError(errors::out_of_range, "index");
 		list_t *ptr;
-		if(!list_pool.get_by_id(params[1], ptr)) amx_LogicError(errors::pointer_invalid, "list", params[1]);
+		if(!list_pool.get_by_id(params[1], ptr))
+		{
+			auto snapshot = list_snapshot(params[1]);
+			if(static_cast<ucell>(params[2]) >= snapshot->size()) amx_LogicError(errors::out_of_range, "index");
+			return snapshot->tag_at(amx, params[2]);
+		}
 		if(static_cast<ucell>(params[2]) >= ptr->size()) amx_LogicError(errors::out_of_range, "index");
+		if(ptr->is_typed())
+		{
+			return ptr->get_cell_tag()->get_id(amx);
+		}
 		auto &obj = (*ptr)[params[2]];
 		return obj.get_tag(amx);
 	}
@@ -652,12 +861,46 @@ namespace Natives
 	{
 		if(params[2] < 0) amx_LogicError(errors::out_of_range, "index");
 		list_t *ptr;
-		if(!list_pool.get_by_id(params[1], ptr)) amx_LogicError(errors::pointer_invalid, "list", params[1]);
+		if(!list_pool.get_by_id(params[1], ptr))
+		{
+			auto snapshot = list_snapshot(params[1]);
+			if(static_cast<ucell>(params[2]) >= snapshot->size()) amx_LogicError(errors::out_of_range, "index");
+			return snapshot->value_at(params[2]).get_size();
+		}
 		if(static_cast<ucell>(params[2]) >= ptr->size()) amx_LogicError(errors::out_of_range, "index");
+		if(ptr->is_typed())
+		{
+			return 1;
+		}
 		auto &obj = (*ptr)[params[2]];
 		return obj.get_size();
 	}
 
+	// native bool:list_build_snapshot(List:list, const file[]);
+	AMX_DEFINE_NATIVE_TAG(list_build_snapshot, 2, bool)
+	{
+		list_t *ptr;
+		if(!list_pool.get_by_id(params[1], ptr)) amx_LogicError(errors::pointer_invalid, "list", params[1]);
+		const char *file;
+		amx_StrParam(amx, params[2], file);
+		if(!file) amx_FormalError(errors::arg_empty, "file");
+		return snapshot_t::build(*ptr, file);
+	}
+
+	// native List:list_open_snapshot(const file[]);
+	AMX_DEFINE_NATIVE_TAG(list_open_snapshot, 1, list)
+	{
+		const char *file;
+		amx_StrParam(amx, params[1], file);
+		if(!file) amx_FormalError(errors::arg_empty, "file");
+		auto snapshot = snapshot_t::open(file);
+		if(!snapshot || snapshot->is_map())
+		{
+			return 0;
+		}
+		return snapshot_pool.get_id(snapshot_pool.add(std::move(snapshot)));
+	}
+
 	// native list_find(List:list, AnyTag:value, index=0, TagTag:tag_id=tagof(value));
 	AMX_DEFINE_NATIVE_TAG(list_find, 4, cell)
 	{
@@ -931,6 +1174,161 @@ namespace Natives
 		}
 	};
 
+	typedef std::uint32_t(*sort_key_func)(cell value);
+
+	static std::uint32_t signed_sort_key(cell value)
+	{
+		return static_cast<std::uint32_t>(value) ^ 0x80000000u;
+	}
+
+	static std::uint32_t unsigned_sort_key(cell value)
+	{
+		return static_cast<std::uint32_t>(value);
+	}
+
+	static std::uint32_t float_sort_key(cell value)
+	{
+		auto bits = static_cast<std::uint32_t>(value);
+		if(bits == 0x80000000u)
+		{
+			// -0.0 compares equal to 0.0
+			bits = 0;
+		}
+		return (bits & 0x80000000u) ? ~bits : bits ^ 0x80000000u;
+	}
+
+	// Built-in tags whose comparison is equivalent to ordering an unsigned key
+	static sort_key_func find_sort_key(tag_ptr tag)
+	{
+		switch(tag->uid)
+		{
+			case tags::tag_cell:
+			case tags::tag_bool:
+			case tags::tag_char:
+			case tags::tag_signed:
+				return signed_sort_key;
+			case tags::tag_unsigned:
+				return unsigned_sort_key;
+			case tags::tag_float:
+				return float_sort_key;
+		}
+		return nullptr;
+	}
+
+	// Sorts lists whose elements share a built-in tag and are compared by a single cell
+	static bool list_sort_radix(list_t &list, cell offset, bool simple, bool reverse)
+	{
+		size_t count = list.size();
+		if(count < 64 || count > UINT32_MAX)
+		{
+			return false;
+		}
+		tag_ptr tag = list[0].get_tag();
+		sort_key_func key_func = find_sort_key(tag);
+		if(!key_func)
+		{
+			return false;
+		}
+
+		std::vector<aux::radix_entry> entries(count);
+		for(size_t i = 0; i < count; i++)
+		{
+			size_t index = reverse ? count - 1 - i : i;
+			const dyn_object &obj = list[index];
+			if(obj.get_tag() != tag)
+			{
+				return false;
+			}
+			const cell *addr;
+			if(simple)
+			{
+				if(obj.end() - obj.begin() != 1)
+				{
+					return false;
+				}
+				addr = obj.begin();
+			}else if(!(addr = obj.get_cell_addr(&offset, 1)))
+			{
+				return false;
+			}
+			entries[i].key = key_func(*addr);
+			entries[i].index = static_cast<std::uint32_t>(index);
+		}
+
+		aux::radix_sort(entries);
+
+		std::vector<dyn_object> sorted;
+		sorted.reserve(count);
+		for(const auto &entry : entries)
+		{
+			sorted.push_back(std::move(list[entry.index]));
+		}
+		for(size_t i = 0; i < count; i++)
+		{
+			list[reverse ? count - 1 - i : i] = std::move(sorted[i]);
+		}
+		return true;
+	}
+
+	// Sorts a list in the typed storage by comparing the cells directly
+	static void list_sort_cells(list_t &list, bool reverse, bool stable)
+	{
+		auto &cells = list.get_cells();
+		tag_ptr tag = list.get_cell_tag();
+		size_t count = cells.size();
+		if(count < 2)
+		{
+			return;
+		}
+		sort_key_func key_func = find_sort_key(tag);
+		if(key_func && count >= 64 && count <= UINT32_MAX)
+		{
+			std::vector<aux::radix_entry> entries(count);
+			for(size_t i = 0; i < count; i++)
+			{
+				size_t index = reverse ? count - 1 - i : i;
+				entries[i].key = key_func(cells[index]);
+				entries[i].index = static_cast<std::uint32_t>(index);
+			}
+
+			aux::radix_sort(entries);
+
+			std::vector<cell> sorted;
+			sorted.reserve(count);
+			for(const auto &entry : entries)
+			{
+				sorted.push_back(cells[entry.index]);
+			}
+			for(size_t i = 0; i < count; i++)
+			{
+				cells[reverse ? count - 1 - i : i] = sorted[i];
+			}
+			return;
+		}
+
+		const auto &ops = tag->get_ops();
+		auto less = [&](cell a, cell b)
+		{
+			return ops.lt(tag, a, b);
+		};
+		if(!reverse)
+		{
+			if(stable)
+			{
+				std::stable_sort(cells.begin(), cells.end(), less);
+			}else{
+				std::sort(cells.begin(), cells.end(), less);
+			}
+		}else{
+			if(stable)
+			{
+				std::stable_sort(cells.rbegin(), cells.rend(), less);
+			}else{
+				std::sort(cells.rbegin(), cells.rend(), less);
+			}
+		}
+	}
+
 	// native list_sort(List:list, offset=0, size=1, bool:reverse=false, bool:stable=true);
 	AMX_DEFINE_NATIVE_TAG(list_sort, 1, cell)
 	{
@@ -958,6 +1356,18 @@ namespace Natives
 
 		bool simple = offset == 0 && size == -1;
 
+		if(ptr->is_typed() && offset == 0 && (simple || size == 1))
+		{
+			list_sort_cells(*ptr, reverse, stable);
+			return 1;
+		}
+
+		ptr->touch();
+		if((simple || size == 1) && list_sort_radix(*ptr, offset, simple, reverse))
+		{
+			return 1;
+		}
+
 		if(!reverse)
 		{
 			auto begin = ptr->begin(), end = ptr->end();
@@ -1037,6 +1447,7 @@ namespace Natives
 
 		expression::exec_info info(amx);
 		expr_sorter sorter(expr, info);
+		ptr->touch();
 		if(!reverse)
 		{
 			auto begin = ptr->begin(), end = ptr->end();
@@ -1057,6 +1468,268 @@ namespace Natives
 		}
 		return 1;
 	}
+
+	struct object_sorter
+	{
+		bool operator()(const dyn_object &a, const dyn_object &b) const
+		{
+			return a < b;
+		}
+	};
+
+	template <class Sorter>
+	struct reverse_sorter
+	{
+		Sorter sorter;
+
+		reverse_sorter(const Sorter &sorter) : sorter(sorter)
+		{
+
+		}
+
+		bool operator()(const dyn_object &a, const dyn_object &b)
+		{
+			return sorter(b, a);
+		}
+	};
+
+	template <class Sorter>
+	struct index_sorter
+	{
+		const list_t &list;
+		Sorter sorter;
+
+		index_sorter(const list_t &list, const Sorter &sorter) : list(list), sorter(sorter)
+		{
+
+		}
+
+		bool operator()(size_t a, size_t b)
+		{
+			return sorter(list[a], list[b]);
+		}
+	};
+
+	// Calls op with the comparator list_sort would use for the arguments
+	template <class Op>
+	static void call_sorter(Op &op, cell offset, cell size, bool reverse)
+	{
+		if(offset == 0 && size == -1)
+		{
+			if(reverse)
+			{
+				op(reverse_sorter<object_sorter>(object_sorter()));
+			}else{
+				op(object_sorter());
+			}
+		}else{
+			if(reverse)
+			{
+				op(reverse_sorter<cell_sorter>(cell_sorter(offset, size)));
+			}else{
+				op(cell_sorter(offset, size));
+			}
+		}
+	}
+
+	template <class Op>
+	static void call_sorter(Op &op, expr_sorter &sorter, bool reverse)
+	{
+		if(reverse)
+		{
+			op(reverse_sorter<expr_sorter>(sorter));
+		}else{
+			op(sorter);
+		}
+	}
+
+	static void get_sorter_args(AMX *amx, cell *params, size_t arg, cell &offset, cell &size, bool &reverse)
+	{
+		offset = optparam(arg, 0);
+		if(offset < 0) amx_LogicError(errors::out_of_range, "offset");
+		size = optparam(arg + 1, -1);
+		if(size < -1) amx_LogicError(errors::out_of_range, "size");
+		reverse = optparam(arg + 2, 0);
+	}
+
+	struct partial_sort_op
+	{
+		list_t &list;
+		size_t count;
+
+		template <class Sorter>
+		void operator()(Sorter sorter)
+		{
+			std::partial_sort(list.begin(), list.begin() + count, list.end(), sorter);
+		}
+	};
+
+	struct nth_element_op
+	{
+		list_t &list;
+		size_t index;
+
+		template <class Sorter>
+		void operator()(Sorter sorter)
+		{
+			std::nth_element(list.begin(), list.begin() + index, list.end(), sorter);
+		}
+	};
+
+	// Finds the indices of the first count elements of the sorted list, in order
+	struct top_k_op
+	{
+		const list_t &list;
+		size_t count;
+		std::vector<size_t> indices;
+
+		top_k_op(const list_t &list, size_t count) : list(list), count(count)
+		{
+
+		}
+
+		template <class Sorter>
+		void operator()(Sorter sorter)
+		{
+			indices.resize(list.size());
+			for(size_t i = 0; i < indices.size(); i++)
+			{
+				indices[i] = i;
+			}
+			index_sorter<Sorter> cmp(list, sorter);
+			auto middle = indices.begin() + count;
+			std::partial_sort(indices.begin(), middle, indices.end(), [&](size_t a, size_t b)
+			{
+				// equal elements keep their original order
+				if(cmp(a, b)) return true;
+				if(cmp(b, a)) return false;
+				return a < b;
+			});
+			indices.erase(middle, indices.end());
+		}
+	};
+
+	static size_t get_count(const list_t *ptr, cell count)
+	{
+		if(count < 0) amx_LogicError(errors::out_of_range, "count");
+		return std::min(static_cast<size_t>(count), ptr->size());
+	}
+
+	static cell make_top_k_list(const list_t *ptr, const std::vector<size_t> &indices)
+	{
+		auto l = list_pool.add();
+		l->reserve(indices.size());
+		for(size_t index : indices)
+		{
+			l->push_back((*ptr)[index]);
+		}
+		return list_pool.get_id(l);
+	}
+
+	// native unit:list_sort_partial(List:list, count, offset=0, size=-1, bool:reverse=false);
+	AMX_DEFINE_NATIVE_TAG(list_sort_partial, 2, cell)
+	{
+		list_t *ptr;
+		if(!list_pool.get_by_id(params[1], ptr)) amx_LogicError(errors::pointer_invalid, "list", params[1]);
+		partial_sort_op op{*ptr, get_count(ptr, params[2])};
+		cell offset, size;
+		bool reverse;
+		get_sorter_args(amx, params, 3, offset, size, reverse);
+		call_sorter(op, offset, size, reverse);
+		ptr->touch();
+		return 1;
+	}
+
+	// native unit:list_sort_partial_expr(List:list, count, Expression:expr, bool:reverse=false);
+	AMX_DEFINE_NATIVE_TAG(list_sort_partial_expr, 3, cell)
+	{
+		list_t *ptr;
+		if(!list_pool.get_by_id(params[1], ptr)) amx_LogicError(errors::pointer_invalid, "list", params[1]);
+		expression *expr;
+		if(!expression_pool.get_by_id(params[3], expr)) amx_LogicError(errors::pointer_invalid, "expression", params[3]);
+		partial_sort_op op{*ptr, get_count(ptr, params[2])};
+		expression::exec_info info(amx);
+		expr_sorter sorter(expr, info);
+		call_sorter(op, sorter, optparam(4, 0));
+		ptr->touch();
+		return 1;
+	}
+
+	// native list_nth(List:list, index, offset=0, size=-1, bool:reverse=false);
+	AMX_DEFINE_NATIVE_TAG(list_nth, 2, cell)
+	{
+		list_t *ptr;
+		if(!list_pool.get_by_id(params[1], ptr)) amx_LogicError(errors::pointer_invalid, "list", params[1]);
+		if(params[2] < 0 || static_cast<ucell>(params[2]) >= ptr->size()) amx_LogicError(errors::out_of_range, "index");
+		nth_element_op op{*ptr, static_cast<size_t>(params[2])};
+		cell offset, size;
+		bool reverse;
+		get_sorter_args(amx, params, 3, offset, size, reverse);
+		call_sorter(op, offset, size, reverse);
+		ptr->touch();
+		return params[2];
+	}
+
+	// native list_nth_expr(List:list, index, Expression:expr, bool:reverse=false);
+	AMX_DEFINE_NATIVE_TAG(list_nth_expr, 3, cell)
+	{
+		list_t *ptr;
+		if(!list_pool.get_by_id(params[1], ptr)) amx_LogicError(errors::pointer_invalid, "list", params[1]);
+		if(params[2] < 0 || static_cast<ucell>(params[2]) >= ptr->size()) amx_LogicError(errors::out_of_range, "index");
+		expression *expr;
+		if(!expression_pool.get_by_id(params[3], expr)) amx_LogicError(errors::pointer_invalid, "expression", params[3]);
+		nth_element_op op{*ptr, static_cast<size_t>(params[2])};
+		expression::exec_info info(amx);
+		expr_sorter sorter(expr, info);
+		call_sorter(op, sorter, optparam(4, 0));
+		ptr->touch();
+		return params[2];
+	}
+
+	// native List:list_top_k(List:list, count, offset=0, size=-1, bool:reverse=false);
+	AMX_DEFINE_NATIVE_TAG(list_top_k, 2, list)
+	{
+		list_t *ptr;
+		if(!list_pool.get_by_id(params[1], ptr)) amx_LogicError(errors::pointer_invalid, "list", params[1]);
+		top_k_op op(*ptr, get_count(ptr, params[2]));
+		cell offset, size;
+		bool reverse;
+		get_sorter_args(amx, params, 3, offset, size, reverse);
+		call_sorter(op, offset, size, reverse);
+		return make_top_k_list(ptr, op.indices);
+	}
+
+	// native List:list_top_k_expr(List:list, count, Expression:expr, bool:reverse=false);
+	AMX_DEFINE_NATIVE_TAG(list_top_k_expr, 3, list)
+	{
+		list_t *ptr;
+		if(!list_pool.get_by_id(params[1], ptr)) amx_LogicError(errors::pointer_invalid, "list", params[1]);
+		expression *expr;
+		if(!expression_pool.get_by_id(params[3], expr)) amx_LogicError(errors::pointer_invalid, "expression", params[3]);
+		top_k_op op(*ptr, get_count(ptr, params[2]));
+		expression::exec_info info(amx);
+		expr_sorter sorter(expr, info);
+		call_sorter(op, sorter, optparam(4, 0));
+		return make_top_k_list(ptr, op.indices);
+	}
+
+	// native list_top_k_indices(List:list, indices[], count=sizeof indices, offset=0, size=-1, bool:reverse=false);
+	AMX_DEFINE_NATIVE_TAG(list_top_k_indices, 3, cell)
+	{
+		list_t *ptr;
+		if(!list_pool.get_by_id(params[1], ptr)) amx_LogicError(errors::pointer_invalid, "list", params[1]);
+		top_k_op op(*ptr, get_count(ptr, params[3]));
+		cell offset, size;
+		bool reverse;
+		get_sorter_args(amx, params, 4, offset, size, reverse);
+		cell *addr = amx_GetAddrSafe(amx, params[2]);
+		call_sorter(op, offset, size, reverse);
+		for(size_t i = 0; i < op.indices.size(); i++)
+		{
+			addr[i] = static_cast<cell>(op.indices[i]);
+		}
+		return static_cast<cell>(op.indices.size());
+	}
 }
 
 static AMX_NATIVE_INFO native_list[] =
@@ -1104,6 +1777,10 @@ static AMX_NATIVE_INFO native_list[] =
 	AMX_DECLARE_NATIVE(list_get_arr_safe),
 	AMX_DECLARE_NATIVE(list_get_str_safe),
 	AMX_DECLARE_NATIVE(list_get_str_safe_s),
+	AMX_DECLARE_NATIVE(list_get_range),
+	AMX_DECLARE_NATIVE(list_get_range_safe),
+	AMX_DECLARE_NATIVE(list_add_range),
+	AMX_DECLARE_NATIVE(list_set_range),
 
 	AMX_DECLARE_NATIVE(list_set),
 	AMX_DECLARE_NATIVE(list_set_arr),
@@ -1141,9 +1818,19 @@ static AMX_NATIVE_INFO native_list[] =
 
 	AMX_DECLARE_NATIVE(list_sort),
 	AMX_DECLARE_NATIVE(list_sort_expr),
+	AMX_DECLARE_NATIVE(list_sort_partial),
+	AMX_DECLARE_NATIVE(list_sort_partial_expr),
+	AMX_DECLARE_NATIVE(list_nth),
+	AMX_DECLARE_NATIVE(list_nth_expr),
+	AMX_DECLARE_NATIVE(list_top_k),
+	AMX_DECLARE_NATIVE(list_top_k_expr),
+	AMX_DECLARE_NATIVE(list_top_k_indices),
 
 	AMX_DECLARE_NATIVE(list_tagof),
 	AMX_DECLARE_NATIVE(list_sizeof),
+
+	AMX_DECLARE_NATIVE(list_build_snapshot),
+	AMX_DECLARE_NATIVE(list_open_snapshot),
 };
 
 int RegisterListNatives(AMX *amx)
@@ -3,9 +3,18 @@
 #include "modules/containers.h"
 #include "modules/variants.h"
 #include "modules/expressions.h"
+#include "modules/snapshots.h"
 #include <iterator>
 #include <algorithm>
 
+// Obtains the snapshot opened as a map if the id does not belong to a map
+static snapshot_t *map_snapshot(cell id)
+{
+	snapshot_t *ptr;
+	if(!snapshot_pool.get_by_id(id, ptr) || !ptr->is_map()) amx_LogicError(errors::pointer_invalid, "map", id);
+	return ptr;
+}
+
 template <size_t... KeyIndices>
 class key_at
 {
@@ -44,7 +53,17 @@ public:
 		static cell AMX_NATIVE_CALL map_get(AMX *amx, cell *params)
 		{
 			map_t *ptr;
-			if(!map_pool.get_by_id(params[1], ptr)) amx_LogicError(errors::pointer_invalid, "map", params[1]);
+			if(!map_pool.get_by_id(params[1], ptr))
+			{
+				auto snapshot = map_snapshot(params[1]);
+				size_t index;
+				if(snapshot->find(KeyFactory(amx, params[KeyIndices]...), index))
+				{
+					return ValueFactory(amx, snapshot->value_at(index), params[ValueIndices]...);
+				}
+				amx_LogicError(errors::element_not_present);
+				return 0;
+			}
 			auto it = ptr->find(KeyFactory(amx, params[KeyIndices]...));
 			if(it != ptr->end())
 			{
@@ -92,7 +111,11 @@ public:
 	static cell AMX_NATIVE_CALL map_has_key(AMX *amx, cell *params)
 	{
 		map_t *ptr;
-		if(!map_pool.get_by_id(params[1], ptr)) amx_LogicError(errors::pointer_invalid, "map", params[1]);
+		if(!map_pool.get_by_id(params[1], ptr))
+		{
+			size_t index;
+			return map_snapshot(params[1])->find(KeyFactory(amx, params[KeyIndices]...), index);
+		}
 		auto it = ptr->find(KeyFactory(amx, params[KeyIndices]...));
 		if(it != ptr->end())
 		{
@@ -114,6 +137,7 @@ public:
 			auto &obj = it->second;
 			if(TagIndex && !obj.tag_assignable(amx, params[TagIndex])) return 0;
 			obj.set_cell(params[3], params[4]);
+			ptr->touch_at(it);
 			return 1;
 		}
 		amx_LogicError(errors::element_not_present);
@@ -125,7 +149,17 @@ public:
 	static cell AMX_NATIVE_CALL map_tagof(AMX *amx, cell *params)
 	{
 		map_t *ptr;
-		if(!map_pool.get_by_id(params[1], ptr)) amx_LogicError(errors::pointer_invalid, "map", params[1]);
+		if(!map_pool.get_by_id(params[1], ptr))
+		{
+			auto snapshot = map_snapshot(params[1]);
+			size_t index;
+			if(snapshot->find(KeyFactory(amx, params[KeyIndices]...), index))
+			{
+				return snapshot->tag_at(amx, index);
+			}
+			amx_LogicError(errors::element_not_present);
+			return 0;
+		}
 		auto it = ptr->find(KeyFactory(amx, params[KeyIndices]...));
 		if(it != ptr->end())
 		{
@@ -140,7 +174,17 @@ public:
 	static cell AMX_NATIVE_CALL map_sizeof(AMX *amx, cell *params)
 	{
 		map_t *ptr;
-		if(!map_pool.get_by_id(params[1], ptr)) amx_LogicError(errors::pointer_invalid, "map", params[1]);
+		if(!map_pool.get_by_id(params[1], ptr))
+		{
+			auto snapshot = map_snapshot(params[1]);
+			size_t index;
+			if(snapshot->find(KeyFactory(amx, params[KeyIndices]...), index))
+			{
+				return snapshot->value_at(index).get_size();
+			}
+			amx_LogicError(errors::element_not_present);
+			return 0;
+		}
 		auto it = ptr->find(KeyFactory(amx, params[KeyIndices]...));
 		if(it != ptr->end())
 		{
@@ -165,7 +209,12 @@ public:
 		cell index = params[2];
 		if(index < 0) amx_LogicError(errors::out_of_range, "index");
 		map_t *ptr;
-		if(!map_pool.get_by_id(params[1], ptr)) amx_LogicError(errors::pointer_invalid, "map", params[1]);
+		if(!map_pool.get_by_id(params[1], ptr))
+		{
+			auto snapshot = map_snapshot(params[1]);
+			if(static_cast<size_t>(index) >= snapshot->size()) amx_LogicError(errors::out_of_range, "index");
+			return ValueFactory(amx, snapshot->key_at(index), params[ValueIndices]...);
+		}
 		if(static_cast<size_t>(index) >= ptr->size()) amx_LogicError(errors::out_of_range, "index");
 		auto it = ptr->begin();
 		std::advance(it, index);
@@ -184,7 +233,12 @@ public:
 		cell index = params[2];
 		if(index < 0) amx_LogicError(errors::out_of_range, "index");
 		map_t *ptr;
-		if(!map_pool.get_by_id(params[1], ptr)) amx_LogicError(errors::pointer_invalid, "map", params[1]);
+		if(!map_pool.get_by_id(params[1], ptr))
+		{
+			auto snapshot = map_snapshot(params[1]);
+			if(static_cast<size_t>(index) >= snapshot->size()) amx_LogicError(errors::out_of_range, "index");
+			return ValueFactory(amx, snapshot->value_at(index), params[ValueIndices]...);
+		}
 		if(static_cast<size_t>(index) >= ptr->size()) amx_LogicError(errors::out_of_range, "index");
 		auto it = ptr->begin();
 		std::advance(it, index);
@@ -533,14 +587,18 @@ namespace Natives
 	AMX_DEFINE_NATIVE_TAG(map_valid, 1, bool)
 	{
 		map_t *ptr;
-		return map_pool.get_by_id(params[1], ptr);
+		snapshot_t *snapshot;
+		return map_pool.get_by_id(params[1], ptr) || (snapshot_pool.get_by_id(params[1], snapshot) && snapshot->is_map());
 	}
 
 	// native map_delete(Map:map);
 	AMX_DEFINE_NATIVE_TAG(map_delete, 1, cell)
 	{
 		map_t *ptr;
-		if(!map_pool.get_by_id(params[1], ptr)) amx_LogicError(errors::pointer_invalid, "map", params[1]);
+		if(!map_pool.get_by_id(params[1], ptr))
+		{
+			return snapshot_pool.remove(map_snapshot(params[1]));
+		}
 		map_t old(ptr->ordered());
 		ptr->swap(old);
 		return map_pool.remove(ptr);
@@ -580,7 +638,10 @@ namespace Natives
 	AMX_DEFINE_NATIVE_TAG(map_size, 1, cell)
 	{
 		map_t *ptr;
-		if(!map_pool.get_by_id(params[1], ptr)) amx_LogicError(errors::pointer_invalid, "map", params[1]);
+		if(!map_pool.get_by_id(params[1], ptr))
+		{
+			return static_cast<cell>(map_snapshot(params[1])->size());
+		}
 		return static_cast<cell>(ptr->size());
 	}
 
@@ -1807,6 +1868,63 @@ namespace Natives
 		return value_at<3, 4, 5>::map_value_at<dyn_func_arr>(amx, params);
 	}
 
+	// native map_keys_range(Map:map, AnyTag:keys[], index=0, offset=0, size=sizeof(keys));
+	AMX_DEFINE_NATIVE_TAG(map_keys_range, 5, cell)
+	{
+		if(params[3] < 0) amx_LogicError(errors::out_of_range, "index");
+		if(params[4] < 0) amx_LogicError(errors::out_of_range, "offset");
+		if(params[5] < 0) amx_LogicError(errors::out_of_range, "size");
+		map_t *ptr;
+		if(!map_pool.get_by_id(params[1], ptr)) amx_LogicError(errors::pointer_invalid, "map", params[1]);
+		if(static_cast<ucell>(params[3]) > ptr->size()) amx_LogicError(errors::out_of_range, "index");
+		cell *addr = amx_GetAddrSafe(amx, params[2]);
+		auto it = ptr->begin();
+		std::advance(it, params[3]);
+		cell count = 0;
+		for(; count < params[5] && it != ptr->end(); ++it, ++count)
+		{
+			addr[count] = it->first.get_cell(params[4]);
+		}
+		return count;
+	}
+
+	// native map_values_range(Map:map, AnyTag:values[], index=0, offset=0, size=sizeof(values));
+	AMX_DEFINE_NATIVE_TAG(map_values_range, 5, cell)
+	{
+		if(params[3] < 0) amx_LogicError(errors::out_of_range, "index");
+		if(params[4] < 0) amx_LogicError(errors::out_of_range, "offset");
+		if(params[5] < 0) amx_LogicError(errors::out_of_range, "size");
+		map_t *ptr;
+		if(!map_pool.get_by_id(params[1], ptr)) amx_LogicError(errors::pointer_invalid, "map", params[1]);
+		if(static_cast<ucell>(params[3]) > ptr->size()) amx_LogicError(errors::out_of_range, "index");
+		cell *addr = amx_GetAddrSafe(amx, params[2]);
+		auto it = ptr->begin();
+		std::advance(it, params[3]);
+		cell count = 0;
+		for(; count < params[5] && it != ptr->end(); ++it, ++count)
+		{
+			addr[count] = it->second.get_cell(params[4]);
+		}
+		return count;
+	}
+
+	// native map_set_range(Map:map, const AnyTag:keys[], const AnyTag:values[], size=sizeof(keys), TagTag:key_tag_id=tagof(keys), TagTag:value_tag_id=tagof(values));
+	AMX_DEFINE_NATIVE_TAG(map_set_range, 6, cell)
+	{
+		if(params[4] < 0) amx_LogicError(errors::out_of_range, "size");
+		map_t *ptr;
+		if(!map_pool.get_by_id(params[1], ptr)) amx_LogicError(errors::pointer_invalid, "map", params[1]);
+		cell *keys = amx_GetAddrSafe(amx, params[2]);
+		cell *values = amx_GetAddrSafe(amx, params[3]);
+		auto key_tag = tags::find_tag(amx, params[5]);
+		auto value_tag = tags::find_tag(amx, params[6]);
+		for(cell i = 0; i < params[4]; i++)
+		{
+			(*ptr)[dyn_object(keys[i], key_tag)] = dyn_object(values[i], value_tag);
+		}
+		return params[4];
+	}
+
 	// native map_count(Map:map, AnyTag:value, TagTag:tag_id=tagof(value));
 	AMX_DEFINE_NATIVE_TAG(map_count, 3, cell)
 	{
@@ -1926,6 +2044,31 @@ namespace Natives
 	{
 		return key_at<2>::map_sizeof<dyn_func_var>(amx, params);
 	}
+
+	// native bool:map_build_snapshot(Map:map, const file[]);
+	AMX_DEFINE_NATIVE_TAG(map_build_snapshot, 2, bool)
+	{
+		map_t *ptr;
+		if(!map_pool.get_by_id(params[1], ptr)) amx_LogicError(errors::pointer_invalid, "map", params[1]);
+		const char *file;
+		amx_StrParam(amx, params[2], file);
+		if(!file) amx_FormalError(errors::arg_empty, "file");
+		return snapshot_t::build(*ptr, file);
+	}
+
+	// native Map:map_open_snapshot(const file[]);
+	AMX_DEFINE_NATIVE_TAG(map_open_snapshot, 1, map)
+	{
+		const char *file;
+		amx_StrParam(amx, params[1], file);
+		if(!file) amx_FormalError(errors::arg_empty, "file");
+		auto snapshot = snapshot_t::open(file);
+		if(!snapshot || !snapshot->is_map())
+		{
+			return 0;
+		}
+		return snapshot_pool.get_id(snapshot_pool.add(std::move(snapshot)));
+	}
 }
 
 static AMX_NATIVE_INFO native_list[] =
@@ -2102,6 +2245,9 @@ static AMX_NATIVE_INFO native_list[] =
 	AMX_DECLARE_NATIVE(map_var_value_at),
 	AMX_DECLARE_NATIVE(map_value_at_safe),
 	AMX_DECLARE_NATIVE(map_arr_value_at_safe),
+	AMX_DECLARE_NATIVE(map_keys_range),
+	AMX_DECLARE_NATIVE(map_values_range),
+	AMX_DECLARE_NATIVE(map_set_range),
 
 	AMX_DECLARE_NATIVE(map_count),
 	AMX_DECLARE_NATIVE(map_count_arr),
@@ -2120,6 +2266,9 @@ static AMX_NATIVE_INFO native_list[] =
 	AMX_DECLARE_NATIVE(map_str_s_sizeof),
 	AMX_DECLARE_NATIVE(map_var_tagof),
 	AMX_DECLARE_NATIVE(map_var_sizeof),
+
+	AMX_DECLARE_NATIVE(map_build_snapshot),
+	AMX_DECLARE_NATIVE(map_open_snapshot),
 };
 
 int RegisterMapNatives(AMX *amx)
@@ -138,14 +138,12 @@ cell *find_symbol_addr(AMX *amx, cell index, cell level, AMX_DBG_SYMBOL *&sym, c
 class debug_symbol_var_iterator : public dyn_iterator, public object_pool<dyn_iterator>::ref_container_virtual
 {
 	amx::handle amx;
-	AMX_DBG *dbg;
-	cell func;
+	const std::vector<uint16_t> *variables;
 
 	cell index;
-	cell current;
 
 public:
-	debug_symbol_var_iterator(AMX *amx, AMX_DBG *dbg, cell func) : amx(amx::load(amx)), dbg(dbg), func(func)
+	debug_symbol_var_iterator(AMX *amx, AMX_DBG *dbg, cell func) : amx(amx::load(amx)), variables(&debug::get_symbols(dbg).variables(dbg->symboltbl[func])), index(-2)
 	{
 
 	}
@@ -157,66 +155,44 @@ public:
 
 	virtual bool valid() const override
 	{
-		return !expired() && current >= 0 && current < dbg->hdr->symbols;
+		return !expired() && index >= 0 && static_cast<size_t>(index) < variables->size();
 	}
 
 	virtual bool move_next() override
 	{
-		if(current != -2)
+		if(index != -2 && static_cast<size_t>(++index) < variables->size())
 		{
-			ucell codestart = dbg->symboltbl[func]->codestart;
-			ucell codeend = dbg->symboltbl[func]->codeend;
-			while(++current < dbg->hdr->symbols)
-			{
-				auto var = dbg->symboltbl[current];
-				if(var->ident != iFUNCTN && var->codestart >= codestart && var->codeend <= codeend)
-				{
-					index++;
-					return true;
-				}
-			}
+			return true;
 		}
-		current = -2;
+		index = -2;
 		return false;
 	}
 
 	virtual bool move_previous() override
 	{
-		if(current != -2)
+		if(index != -2 && --index >= 0)
 		{
-			ucell codestart = dbg->symboltbl[func]->codestart;
-			ucell codeend = dbg->symboltbl[func]->codeend;
-			while(--current >= 0)
-			{
-				auto var = dbg->symboltbl[current];
-				if(var->ident != iFUNCTN && var->codestart >= codestart && var->codeend <= codeend)
-				{
-					index--;
-					return true;
-				}
-			}
+			return true;
 		}
-		current = -2;
+		index = -2;
 		return false;
 	}
 
 	virtual bool set_to_first() override
 	{
-		current = -1;
 		index = -1;
 		return move_next();
 	}
 
 	virtual bool set_to_last() override
 	{
-		current = dbg->hdr->symbols;
-		index = 0;
+		index = static_cast<cell>(variables->size());
 		return move_previous();
 	}
 
 	virtual bool reset() override
 	{
-		current = -2;
+		index = -2;
 		return true;
 	}
 
@@ -252,7 +228,7 @@ public:
 
 	virtual size_t get_hash() const override
 	{
-		return std::hash<cell>()(current);
+		return std::hash<cell>()(index);
 	}
 
 	virtual bool operator==(const dyn_iterator &obj) const override
@@ -260,7 +236,7 @@ public:
 		auto other = dynamic_cast<const debug_symbol_var_iterator*>(&obj);
 		if(other != nullptr)
 		{
-			return !amx.owner_before(other->amx) && !other->amx.owner_before(amx) && current == other->current;
+			return !amx.owner_before(other->amx) && !other->amx.owner_before(amx) && variables == other->variables && index == other->index;
 		}
 		return false;
 	}
@@ -272,11 +248,11 @@ protected:
 		{
 			if(type == typeid(std::shared_ptr<const dyn_object>))
 			{
-				*reinterpret_cast<std::shared_ptr<const dyn_object>*>(value) = std::make_shared<dyn_object>(current, tags::find_tag(tags::tag_symbol));
+				*reinterpret_cast<std::shared_ptr<const dyn_object>*>(value) = std::make_shared<dyn_object>((*variables)[index], tags::find_tag(tags::tag_symbol));
 				return true;
 			}else if(type == typeid(std::shared_ptr<const std::pair<const dyn_object, dyn_object>>))
 			{
-				*reinterpret_cast<std::shared_ptr<const std::pair<const dyn_object, dyn_object>>*>(value) = std::make_shared<std::pair<const dyn_object, dyn_object>>(std::pair<const dyn_object, dyn_object>(dyn_object(index, tags::find_tag(tags::tag_cell)), dyn_object(current, tags::find_tag(tags::tag_symbol))));
+				*reinterpret_cast<std::shared_ptr<const std::pair<const dyn_object, dyn_object>>*>(value) = std::make_shared<std::pair<const dyn_object, dyn_object>>(std::pair<const dyn_object, dyn_object>(dyn_object(index, tags::find_tag(tags::tag_cell)), dyn_object((*variables)[index], tags::find_tag(tags::tag_symbol))));
 				return true;
 			}
 		}
@@ -442,21 +418,8 @@ namespace Natives
 		cell kind = optparam(3, -1);
 		cell cls = optparam(4, -1);
 
-		cell minindex = std::numeric_limits<cell>::min();
-		ucell mindist;
-		for(uint16_t i = 0; i < dbg->hdr->symbols; i++)
-		{
-			auto sym = dbg->symboltbl[i];
-			if((sym->ident == iFUNCTN || (sym->codestart <= cip && sym->codeend > cip)) && ((1 << (sym->ident - 1)) & kind) && ((1 << sym->vclass) & cls) && !std::strcmp(sym->name, name))
-			{
-				if(minindex == std::numeric_limits<cell>::min() || sym->codeend - sym->codestart < mindist)
-				{
-					minindex = i;
-					mindist = sym->codeend - sym->codestart;
-				}
-			}
-		}
-		return minindex;
+		cell index = debug::get_symbols(dbg).find_symbol(name, cip, kind, cls);
+		return index != -1 ? index : std::numeric_limits<cell>::min();
 	}
 
 	// native Symbol:debug_func(code=cellmin);
@@ -474,21 +437,8 @@ namespace Natives
 			return 0;
 		}
 
-		cell minindex = std::numeric_limits<cell>::min();
-		ucell mindist;
-		for(uint16_t i = 0; i < dbg->hdr->symbols; i++)
-		{
-			auto sym = dbg->symboltbl[i];
-			if(sym->ident == iFUNCTN && sym->codestart <= cip && sym->codeend > cip)
-			{
-				if(minindex == std::numeric_limits<cell>::min() || sym->codeend - sym->codestart < mindist)
-				{
-					minindex = i;
-					mindist = sym->codeend - sym->codestart;
-				}
-			}
-		}
-		return minindex;
+		cell index = debug::get_symbols(dbg).find_function(cip, cip + 1);
+		return index != -1 ? index : std::numeric_limits<cell>::min();
 	}
 
 	// native Symbol:debug_var(AnyTag:&var);
@@ -508,19 +458,10 @@ namespace Natives
 
 		if(addr < amx->hlw) // data variable
 		{
-			for(uint16_t i = 0; i < dbg->hdr->symbols; i++)
+			cell index = debug::get_symbols(dbg).find_global(addr);
+			if(index != -1)
 			{
-				auto sym = dbg->symboltbl[i];
-				if(sym->vclass == 0 || sym->vclass == 2) // global/static
-				{
-					if(sym->ident == iVARIABLE || sym->ident == iARRAY)
-					{
-						if(sym->address == addr)
-						{
-							return i;
-						}
-					}
-				}
+				return index;
 			}
 		}else{ // stack variable
 			auto data = amx_GetData(amx);
@@ -541,19 +482,10 @@ namespace Natives
 			{
 				addr -= frm;
 
-				for(uint16_t i = 0; i < dbg->hdr->symbols; i++)
+				cell index = debug::get_symbols(dbg).find_local(addr, cip);
+				if(index != -1)
 				{
-					auto sym = dbg->symboltbl[i];
-					if(sym->vclass == 1) // local
-					{
-						if(sym->ident == iVARIABLE || sym->ident == iARRAY)
-						{
-							if(sym->address == addr && sym->codestart <= cip && cip < sym->codeend)
-							{
-								return i;
-							}
-						}
-					}
+					return index;
 				}
 			}
 		}
@@ -665,26 +597,13 @@ namespace Natives
 		}
 		auto insym = dbg->symboltbl[index];
 
-		cell minindex = std::numeric_limits<cell>::min();
 		if(insym->vclass == 0)
 		{
-			return minindex;
+			return std::numeric_limits<cell>::min();
 		}
 
-		ucell mindist;
-		for(uint16_t i = 0; i < dbg->hdr->symbols; i++)
-		{
-			auto sym = dbg->symboltbl[i];
-			if(sym->ident == iFUNCTN && sym->codestart <= insym->codestart && sym->codeend >= insym->codeend)
-			{
-				if(minindex == std::numeric_limits<cell>::min() || sym->codeend - sym->codestart < mindist)
-				{
-					minindex = i;
-					mindist = sym->codeend - sym->codestart;
-				}
-			}
-		}
-		return minindex;
+		cell func = debug::get_symbols(dbg).find_function(insym->codestart, insym->codeend);
+		return func != -1 ? func : std::numeric_limits<cell>::min();
 	}
 
 	// native debug_symbol_name(Symbol:symbol, name[], size=sizeof(name));
@@ -1408,19 +1327,16 @@ namespace Natives
 		cell argslen = params[0] - sizeof(cell);
 		cell argsneeded = 0;
 		bool error = false;
-		for(uint16_t i = 0; i < dbg->hdr->symbols; i++)
+		for(uint16_t i : debug::get_symbols(dbg).parameters(sym))
 		{
 			auto vsym = dbg->symboltbl[i];
-			if(vsym->ident != iFUNCTN && vsym->vclass == 1 && vsym->codestart >= sym->codestart && vsym->codeend <= sym->codeend)
+			cell addr = vsym->address - 2 * sizeof(cell);
+			if(addr > argslen)
 			{
-				cell addr = vsym->address - 2 * sizeof(cell);
-				if(addr > argslen)
+				error = true;
+				if(addr > argsneeded)
 				{
-					error = true;
-					if(addr > argsneeded)
-					{
-						argsneeded = addr;
-					}
+					argsneeded = addr;
 				}
 			}
 		}
@@ -1475,19 +1391,16 @@ namespace Natives
 		cell argslen = list->size() * sizeof(cell);
 		cell argsneeded = 0;
 		bool error = false;
-		for(uint16_t i = 0; i < dbg->hdr->symbols; i++)
+		for(uint16_t i : debug::get_symbols(dbg).parameters(sym))
 		{
 			auto vsym = dbg->symboltbl[i];
-			if(vsym->ident != iFUNCTN && vsym->vclass == 1 && vsym->codestart >= sym->codestart && vsym->codeend <= sym->codeend)
+			cell addr = vsym->address - 2 * sizeof(cell);
+			if(addr > argslen)
 			{
-				cell addr = vsym->address - 2 * sizeof(cell);
-				if(addr > argslen)
+				error = true;
+				if(addr > argsneeded)
 				{
-					error = true;
-					if(addr > argsneeded)
-					{
-						argsneeded = addr;
-					}
+					argsneeded = addr;
 				}
 			}
 		}
@@ -1547,27 +1460,24 @@ namespace Natives
 		cell argslen = params[0] - sizeof(cell);
 		cell argsneeded = 0;
 		bool error = false;
-		for(uint16_t i = 0; i < dbg->hdr->symbols; i++)
+		for(uint16_t i : debug::get_symbols(dbg).parameters(sym))
 		{
 			auto vsym = dbg->symboltbl[i];
-			if(vsym->ident != iFUNCTN && vsym->vclass == 1 && vsym->codestart >= sym->codestart && vsym->codeend <= sym->codeend)
+			cell addr = vsym->address - 2 * sizeof(cell);
+			if(addr > argslen)
 			{
-				cell addr = vsym->address - 2 * sizeof(cell);
-				if(addr > argslen)
-				{
-					error = true;
-					if(addr > argsneeded)
-					{
-						argsneeded = addr;
-					}
-				}
-				if(vsym->ident == iVARIABLE && addr > 0)
+				error = true;
+				if(addr > argsneeded)
 				{
-					auto arg = reinterpret_cast<cell*>(reinterpret_cast<unsigned char*>(stk) + addr);
-					cell val = *arg;
-					*arg = *reinterpret_cast<cell*>(data + val);
+					argsneeded = addr;
 				}
 			}
+			if(vsym->ident == iVARIABLE && addr > 0)
+			{
+				auto arg = reinterpret_cast<cell*>(reinterpret_cast<unsigned char*>(stk) + addr);
+				cell val = *arg;
+				*arg = *reinterpret_cast<cell*>(data + val);
+			}
 		}
 		if(error)
 		{
@@ -1629,19 +1539,16 @@ namespace Natives
 		cell argslen = list->size() * sizeof(cell);
 		cell argsneeded = 0;
 		bool error = false;
-		for(uint16_t i = 0; i < dbg->hdr->symbols; i++)
+		for(uint16_t i : debug::get_symbols(dbg).parameters(sym))
 		{
 			auto vsym = dbg->symboltbl[i];
-			if(vsym->ident != iFUNCTN && vsym->vclass == 1 && vsym->codestart >= sym->codestart && vsym->codeend <= sym->codeend)
+			cell addr = vsym->address - 2 * sizeof(cell);
+			if(addr > argslen)
 			{
-				cell addr = vsym->address - 2 * sizeof(cell);
-				if(addr > argslen)
+				error = true;
+				if(addr > argsneeded)
 				{
-					error = true;
-					if(addr > argsneeded)
-					{
-						argsneeded = addr;
-					}
+					argsneeded = addr;
 				}
 			}
 		}
@@ -1701,27 +1608,24 @@ namespace Natives
 		cell argslen = params[0] - 2 * sizeof(cell);
 		cell argsneeded = 0;
 		bool error = false;
-		for(uint16_t i = 0; i < dbg->hdr->symbols; i++)
+		for(uint16_t i : debug::get_symbols(dbg).parameters(sym))
 		{
 			auto vsym = dbg->symboltbl[i];
-			if(vsym->ident != iFUNCTN && vsym->vclass == 1 && vsym->codestart >= sym->codestart && vsym->codeend <= sym->codeend)
+			cell addr = vsym->address - 2 * sizeof(cell);
+			if(addr > argslen)
 			{
-				cell addr = vsym->address - 2 * sizeof(cell);
-				if(addr > argslen)
+				error = true;
+				if(addr > argsneeded)
 				{
-					error = true;
-					if(addr > argsneeded)
-					{
-						argsneeded = addr;
-					}
-				}
-				if(vsym->ident == iVARIABLE && addr > 0)
-				{
-					auto arg = reinterpret_cast<cell*>(reinterpret_cast<unsigned char*>(stk) + addr);
-					cell val = *arg;
-					*arg = *reinterpret_cast<cell*>(data + val);
+					argsneeded = addr;
 				}
 			}
+			if(vsym->ident == iVARIABLE && addr > 0)
+			{
+				auto arg = reinterpret_cast<cell*>(reinterpret_cast<unsigned char*>(stk) + addr);
+				cell val = *arg;
+				*arg = *reinterpret_cast<cell*>(data + val);
+			}
 		}
 		if(error)
 		{
@@ -1769,19 +1673,16 @@ namespace Natives
 		cell argslen = list->size() * sizeof(cell);
 		cell argsneeded = 0;
 		bool error = false;
-		for(uint16_t i = 0; i < dbg->hdr->symbols; i++)
+		for(uint16_t i : debug::get_symbols(dbg).parameters(sym))
 		{
 			auto vsym = dbg->symboltbl[i];
-			if(vsym->ident != iFUNCTN && vsym->vclass == 1 && vsym->codestart >= sym->codestart && vsym->codeend <= sym->codeend)
+			cell addr = vsym->address - 2 * sizeof(cell);
+			if(addr > argslen)
 			{
-				cell addr = vsym->address - 2 * sizeof(cell);
-				if(addr > argslen)
+				error = true;
+				if(addr > argsneeded)
 				{
-					error = true;
-					if(addr > argsneeded)
-					{
-						argsneeded = addr;
-					}
+					argsneeded = addr;
 				}
 			}
 		}
@@ -0,0 +1,92 @@
+#include "natives.h"
+#include "errors.h"
+#include "modules/profiler.h"
+#include "modules/containers.h"
+#include "modules/strings.h"
+
+#include <fstream>
+
+namespace Natives
+{
+	// native bool:profiler_start(interval=100);
+	AMX_DEFINE_NATIVE_TAG(profiler_start, 0, bool)
+	{
+		if(!profiler::start(amx, optparam(1, 100)))
+		{
+			amx_LogicError(errors::no_debug_error);
+		}
+		return 1;
+	}
+
+	// native bool:profiler_stop();
+	AMX_DEFINE_NATIVE_TAG(profiler_stop, 0, bool)
+	{
+		return profiler::stop(amx);
+	}
+
+	// native bool:profiler_running();
+	AMX_DEFINE_NATIVE_TAG(profiler_running, 0, bool)
+	{
+		return profiler::running(amx);
+	}
+
+	// native unit:profiler_reset();
+	AMX_DEFINE_NATIVE_TAG(profiler_reset, 0, cell)
+	{
+		profiler::reset(amx);
+		return 1;
+	}
+
+	// native profiler_samples();
+	AMX_DEFINE_NATIVE_TAG(profiler_samples, 0, cell)
+	{
+		return static_cast<cell>(profiler::num_samples(amx));
+	}
+
+	// native bool:profiler_dump(const file[]);
+	AMX_DEFINE_NATIVE_TAG(profiler_dump, 1, bool)
+	{
+		const char *file;
+		amx_StrParam(amx, params[1], file);
+		if(!file)
+		{
+			amx_FormalError(errors::arg_empty, "file");
+		}
+		std::ofstream stream(file);
+		if(!stream)
+		{
+			return 0;
+		}
+		profiler::write_collapsed(amx, stream);
+		return static_cast<bool>(stream);
+	}
+
+	// native Map:profiler_map();
+	AMX_DEFINE_NATIVE_TAG(profiler_map, 0, map)
+	{
+		auto ptr = map_pool.add();
+		for(const auto &pair : profiler::get_functions(amx))
+		{
+			auto name = strings::convert(pair.first);
+			cell times[2] = {static_cast<cell>(pair.second.self), static_cast<cell>(pair.second.total)};
+			ptr->insert(dyn_object(name.c_str(), name.size() + 1, tags::find_tag(tags::tag_char)), dyn_object(times, 2, tags::find_tag(tags::tag_cell)));
+		}
+		return map_pool.get_id(ptr);
+	}
+}
+
+static AMX_NATIVE_INFO native_list[] =
+{
+	AMX_DECLARE_NATIVE(profiler_start),
+	AMX_DECLARE_NATIVE(profiler_stop),
+	AMX_DECLARE_NATIVE(profiler_running),
+	AMX_DECLARE_NATIVE(profiler_reset),
+	AMX_DECLARE_NATIVE(profiler_samples),
+	AMX_DECLARE_NATIVE(profiler_dump),
+	AMX_DECLARE_NATIVE(profiler_map),
+};
+
+int RegisterProfilerNatives(AMX *amx)
+{
+	return amx_Register(amx, native_list, sizeof(native_list) / sizeof(*native_list));
+}
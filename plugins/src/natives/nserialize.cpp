@@ -0,0 +1,81 @@
+#include "natives.h"
+#include "errors.h"
+#include "modules/serialize.h"
+
+#include <cstring>
+#include <vector>
+
+namespace Natives
+{
+	// native bool:serialize_to_file(AnyTag:value, const file[], TagTag:tag_id=tagof value);
+	AMX_DEFINE_NATIVE_TAG(serialize_to_file, 3, bool)
+	{
+		const char *file;
+		amx_StrParam(amx, params[2], file);
+		if(!file) amx_FormalError(errors::arg_empty, "file");
+		return serialize::save_file(dyn_object(amx, params[1], params[3]), file);
+	}
+
+	// native serialize_to_buffer(AnyTag:value, buffer[], size=sizeof buffer, TagTag:tag_id=tagof value);
+	AMX_DEFINE_NATIVE_TAG(serialize_to_buffer, 4, cell)
+	{
+		std::vector<char> data;
+		if(!serialize::save_buffer(dyn_object(amx, params[1], params[4]), data))
+		{
+			return 0;
+		}
+		// the buffer is filled only if the whole value fits
+		cell needed = static_cast<cell>((data.size() + sizeof(cell) - 1) / sizeof(cell));
+		if(needed <= params[3])
+		{
+			cell *addr = amx_GetAddrSafe(amx, params[2]);
+			addr[needed - 1] = 0;
+			std::memcpy(addr, data.data(), data.size());
+		}
+		return needed;
+	}
+
+	// native bool:deserialize_from_file(const file[], &AnyTag:value, TagTag:tag_id=tagof value);
+	AMX_DEFINE_NATIVE_TAG(deserialize_from_file, 3, bool)
+	{
+		const char *file;
+		amx_StrParam(amx, params[1], file);
+		if(!file) amx_FormalError(errors::arg_empty, "file");
+		dyn_object value;
+		if(!serialize::load_file(file, value, tags::find_tag(amx, params[3])))
+		{
+			return 0;
+		}
+		cell *addr = amx_GetAddrSafe(amx, params[2]);
+		*addr = value.get_cell(0);
+		return 1;
+	}
+
+	// native bool:deserialize_from_buffer(const buffer[], &AnyTag:value, size=sizeof buffer, TagTag:tag_id=tagof value);
+	AMX_DEFINE_NATIVE_TAG(deserialize_from_buffer, 4, bool)
+	{
+		if(params[3] < 0) amx_LogicError(errors::out_of_range, "size");
+		cell *buffer = amx_GetAddrSafe(amx, params[1]);
+		dyn_object value;
+		if(!serialize::load_buffer(reinterpret_cast<const char*>(buffer), params[3] * sizeof(cell), value, tags::find_tag(amx, params[4])))
+		{
+			return 0;
+		}
+		cell *addr = amx_GetAddrSafe(amx, params[2]);
+		*addr = value.get_cell(0);
+		return 1;
+	}
+}
+
+static AMX_NATIVE_INFO native_list[] =
+{
+	AMX_DECLARE_NATIVE(serialize_to_file),
+	AMX_DECLARE_NATIVE(serialize_to_buffer),
+	AMX_DECLARE_NATIVE(deserialize_from_file),
+	AMX_DECLARE_NATIVE(deserialize_from_buffer),
+};
+
+int RegisterSerializeNatives(AMX *amx)
+{
+	return amx_Register(amx, native_list, sizeof(native_list) / sizeof(*native_list));
+}
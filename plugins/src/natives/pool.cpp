@@ -55,9 +55,10 @@ public:
 		pool_t *ptr;
 		if(!pool_pool.get_by_id(params[1], ptr)) amx_LogicError(errors::pointer_invalid, "pool", params[1]);
 		auto find = Factory(amx, params[Indices]...);
+		element_matcher matches(find);
 		for(auto it = ptr->begin(); it != ptr->end(); ++it)
 		{
-			if(*it == find)
+			if(matches(*it))
 			{
 				return ptr->index_of(it);
 			}
@@ -71,7 +72,8 @@ public:
 	{
 		pool_t *ptr;
 		if(!pool_pool.get_by_id(params[1], ptr)) amx_LogicError(errors::pointer_invalid, "pool", params[1]);
-		return std::count(ptr->begin(), ptr->end(), Factory(amx, params[Indices]...));
+		auto find = Factory(amx, params[Indices]...);
+		return std::count_if(ptr->begin(), ptr->end(), element_matcher(find));
 	}
 };
 
@@ -3,6 +3,7 @@
 #include "hooks.h"
 #include "exec.h"
 #include "context.h"
+#include "objects/reset.h"
 #include "modules/tasks.h"
 #include "modules/strings.h"
 #include "modules/format.h"
@@ -11,9 +12,14 @@
 #include "modules/containers.h"
 #include "modules/amxhook.h"
 #include "modules/expressions.h"
+#include "modules/native_stats.h"
+#include "modules/tracing.h"
+#include "modules/memory.h"
+#include "modules/leaks.h"
 #include "utils/systools.h"
 
 #include <cstring>
+#include <fstream>
 #ifdef _WIN32
 #define WIN32_LEAN_AND_MEAN
 #include <windows.h>
@@ -21,6 +27,8 @@
 #include <dlfcn.h>
 #endif
 #include <chrono>
+#include <limits>
+#include <algorithm>
 #include <time.h>
 
 namespace Natives
@@ -253,13 +261,338 @@ namespace Natives
 		return amxhook::hook_count();
 	}
 
+	// native pp_num_context_allocs();
+	AMX_DEFINE_NATIVE_TAG(pp_num_context_allocs, 0, cell)
+	{
+		return amx::context_allocs();
+	}
+
+	// native pp_num_snapshot_allocs();
+	AMX_DEFINE_NATIVE_TAG(pp_num_snapshot_allocs, 0, cell)
+	{
+		return amx::snapshot_allocs();
+	}
+
+	// native pp_last_snapshot_size();
+	AMX_DEFINE_NATIVE_TAG(pp_last_snapshot_size, 0, cell)
+	{
+		return amx::last_snapshot_size();
+	}
+
+	// native pp_num_shared_snapshots();
+	AMX_DEFINE_NATIVE_TAG(pp_num_shared_snapshots, 0, cell)
+	{
+		return amx::shared_snapshots();
+	}
+
+	// native pp_num_snapshot_fallbacks();
+	AMX_DEFINE_NATIVE_TAG(pp_num_snapshot_fallbacks, 0, cell)
+	{
+		return amx::snapshot_fallbacks();
+	}
+
+	// native pp_num_handler_allocs();
+	AMX_DEFINE_NATIVE_TAG(pp_num_handler_allocs, 0, cell)
+	{
+		return tasks::handler_allocs();
+	}
+
 	// native pp_collect();
 	AMX_DEFINE_NATIVE_TAG(pp_collect, 0, cell)
 	{
-		gc_collect();
+		gc_collect_full();
+		return 1;
+	}
+
+	// native bool:pp_gc_incremental(bool:incremental);
+	AMX_DEFINE_NATIVE_TAG(pp_gc_incremental, 1, bool)
+	{
+		bool orig = gc_incremental;
+		gc_incremental = params[1];
+		return orig;
+	}
+
+	// native pp_gc_sync_limit(limit);
+	AMX_DEFINE_NATIVE_TAG(pp_gc_sync_limit, 1, cell)
+	{
+		if(params[1] < 0)
+		{
+			amx_LogicError(errors::out_of_range, "limit");
+		}
+		cell orig = static_cast<cell>(gc_sync_limit);
+		gc_sync_limit = params[1];
+		return orig;
+	}
+
+	// native pp_gc_budget(max_objects, max_time_us=0);
+	AMX_DEFINE_NATIVE_TAG(pp_gc_budget, 2, cell)
+	{
+		if(params[1] < 0)
+		{
+			amx_LogicError(errors::out_of_range, "max_objects");
+		}
+		if(params[2] < 0)
+		{
+			amx_LogicError(errors::out_of_range, "max_time_us");
+		}
+		gc_batch_size = params[1];
+		gc_time_budget = params[2];
+		return 1;
+	}
+
+	// native pp_num_pending_garbage();
+	AMX_DEFINE_NATIVE_TAG(pp_num_pending_garbage, 0, cell)
+	{
+		return gc_pending();
+	}
+
+	// native pp_gc_last_pause();
+	AMX_DEFINE_NATIVE_TAG(pp_gc_last_pause, 0, cell)
+	{
+		return static_cast<cell>(gc_stats.last);
+	}
+
+	// native pp_gc_max_pause();
+	AMX_DEFINE_NATIVE_TAG(pp_gc_max_pause, 0, cell)
+	{
+		return static_cast<cell>(gc_stats.max);
+	}
+
+	// native pp_gc_total_pause();
+	AMX_DEFINE_NATIVE_TAG(pp_gc_total_pause, 0, cell)
+	{
+		return static_cast<cell>(std::min(gc_stats.total, static_cast<long long>(std::numeric_limits<cell>::max())));
+	}
+
+	// native pp_gc_num_pauses();
+	AMX_DEFINE_NATIVE_TAG(pp_gc_num_pauses, 0, cell)
+	{
+		return static_cast<cell>(gc_stats.count);
+	}
+
+	// native pp_gc_reset_stats();
+	AMX_DEFINE_NATIVE_TAG(pp_gc_reset_stats, 0, cell)
+	{
+		gc_stats = gc_pause_stats();
+		return 1;
+	}
+
+	// native unit:pp_native_stats(bool:enable);
+	AMX_DEFINE_NATIVE_TAG(pp_native_stats, 1, cell)
+	{
+		native_stats::enabled = static_cast<bool>(params[1]);
+		return 1;
+	}
+
+	// native unit:pp_native_stats_reset();
+	AMX_DEFINE_NATIVE_TAG(pp_native_stats_reset, 0, cell)
+	{
+		native_stats::reset();
 		return 1;
 	}
 
+	// native Map:pp_native_stats_map();
+	AMX_DEFINE_NATIVE_TAG(pp_native_stats_map, 0, map)
+	{
+		auto ptr = map_pool.add();
+		for(const auto &stats : native_stats::get())
+		{
+			if(stats.calls == 0)
+			{
+				continue;
+			}
+			auto name = strings::convert(stats.name);
+			cell values[3] = {
+				static_cast<cell>(std::min(stats.calls, static_cast<long long>(std::numeric_limits<cell>::max()))),
+				static_cast<cell>(std::min(stats.total / 1000, static_cast<long long>(std::numeric_limits<cell>::max()))),
+				static_cast<cell>(std::min(stats.max / 1000, static_cast<long long>(std::numeric_limits<cell>::max())))
+			};
+			(*ptr)[dyn_object(name.c_str(), name.size() + 1, tags::find_tag(tags::tag_char))] = dyn_object(values, 3, tags::find_tag(tags::tag_cell));
+		}
+		return map_pool.get_id(ptr);
+	}
+
+	// native List:pp_native_stats_histogram(const name[]);
+	AMX_DEFINE_NATIVE_TAG(pp_native_stats_histogram, 1, list)
+	{
+		const char *name;
+		amx_StrParam(amx, params[1], name);
+		if(!name) amx_FormalError(errors::arg_empty, "name");
+		for(const auto &stats : native_stats::get())
+		{
+			if(stats.name == name)
+			{
+				auto ptr = list_pool.add();
+				for(long long count : stats.histogram)
+				{
+					ptr->push_back(dyn_object(static_cast<cell>(std::min(count, static_cast<long long>(std::numeric_limits<cell>::max()))), tags::find_tag(tags::tag_cell)));
+				}
+				return list_pool.get_id(ptr);
+			}
+		}
+		amx_FormalError(errors::func_not_found, "native", name);
+		return 0;
+	}
+
+	// native unit:pp_trace_handlers(bool:enable);
+	AMX_DEFINE_NATIVE_TAG(pp_trace_handlers, 1, cell)
+	{
+		tracing::enabled = static_cast<bool>(params[1]);
+		return 1;
+	}
+
+	// native unit:pp_trace_reset();
+	AMX_DEFINE_NATIVE_TAG(pp_trace_reset, 0, cell)
+	{
+		tracing::reset();
+		return 1;
+	}
+
+	// native Map:pp_trace_stats();
+	AMX_DEFINE_NATIVE_TAG(pp_trace_stats, 0, map)
+	{
+		auto ptr = map_pool.add();
+		for(const auto &pair : tracing::get_all())
+		{
+			const auto &stats = *pair.second;
+			if(stats.count == 0)
+			{
+				continue;
+			}
+			cell values[2] = {
+				static_cast<cell>(std::min(stats.count, static_cast<long long>(std::numeric_limits<cell>::max()))),
+				static_cast<cell>(std::min(stats.total / 1000, static_cast<long long>(std::numeric_limits<cell>::max())))
+			};
+			(*ptr)[dyn_object(pair.first, tags::find_tag(tags::tag_cell))] = dyn_object(values, 2, tags::find_tag(tags::tag_cell));
+		}
+		return map_pool.get_id(ptr);
+	}
+
+	// native bool:pp_trace_dump(const file[]);
+	AMX_DEFINE_NATIVE_TAG(pp_trace_dump, 1, bool)
+	{
+		const char *file;
+		amx_StrParam(amx, params[1], file);
+		if(!file) amx_FormalError(errors::arg_empty, "file");
+		std::ofstream stream(file);
+		if(!stream)
+		{
+			return 0;
+		}
+		tracing::write_trace(stream);
+		return static_cast<bool>(stream);
+	}
+
+	// native pp_memory_usage(memory_pool:pool, &objects=0, &peak=0);
+	AMX_DEFINE_NATIVE_TAG(pp_memory_usage, 1, cell)
+	{
+		if(params[1] < 0 || params[1] >= static_cast<cell>(memory::pool_type::count)) amx_LogicError(errors::out_of_range, "pool");
+		const auto &usage = memory::get(static_cast<memory::pool_type>(params[1]));
+		*optparamref(2, 0) = static_cast<cell>(usage.objects);
+		*optparamref(3, 0) = static_cast<cell>(usage.peak);
+		return static_cast<cell>(usage.bytes);
+	}
+
+	// native pp_memory_script_usage(memory_pool:pool, &objects=0, &peak=0);
+	AMX_DEFINE_NATIVE_TAG(pp_memory_script_usage, 1, cell)
+	{
+		if(params[1] < 0 || params[1] >= static_cast<cell>(memory::pool_type::count)) amx_LogicError(errors::out_of_range, "pool");
+		const auto &usage = memory::get(amx, static_cast<memory::pool_type>(params[1]));
+		*optparamref(2, 0) = static_cast<cell>(usage.objects);
+		*optparamref(3, 0) = static_cast<cell>(usage.peak);
+		return static_cast<cell>(usage.bytes);
+	}
+
+	// native Map:pp_memory_stats();
+	AMX_DEFINE_NATIVE_TAG(pp_memory_stats, 0, map)
+	{
+		auto ptr = map_pool.add();
+		for(cell i = 0; i < static_cast<cell>(memory::pool_type::count); i++)
+		{
+			auto type = static_cast<memory::pool_type>(i);
+			const auto &usage = memory::get(type);
+			auto name = strings::convert(memory::pool_name(type));
+			cell values[3] = {static_cast<cell>(usage.objects), static_cast<cell>(usage.bytes), static_cast<cell>(usage.peak)};
+			(*ptr)[dyn_object(name.c_str(), name.size() + 1, tags::find_tag(tags::tag_char))] = dyn_object(values, 3, tags::find_tag(tags::tag_cell));
+		}
+		return map_pool.get_id(ptr);
+	}
+
+	// native unit:pp_memory_reset_peaks();
+	AMX_DEFINE_NATIVE_TAG(pp_memory_reset_peaks, 0, cell)
+	{
+		memory::reset_peaks();
+		amx::reset_snapshot_peak(amx);
+		return 1;
+	}
+
+	// native bool:pp_memory_tracking(bool:enable);
+	AMX_DEFINE_NATIVE_TAG(pp_memory_tracking, 1, bool)
+	{
+		bool orig = memory::tracking;
+		memory::enable(static_cast<bool>(params[1]));
+		return orig;
+	}
+
+	// native pp_memory_snapshots(&peak=0, &shared=0, &cached=0);
+	AMX_DEFINE_NATIVE_TAG(pp_memory_snapshots, 0, cell)
+	{
+		auto usage = amx::snapshot_memory(amx);
+		*optparamref(1, 0) = static_cast<cell>(usage.peak);
+		*optparamref(2, 0) = static_cast<cell>(usage.shared);
+		*optparamref(3, 0) = static_cast<cell>(usage.cached);
+		return static_cast<cell>(usage.live);
+	}
+
+	// native unit:pp_leak_tracking(bool:enable);
+	AMX_DEFINE_NATIVE_TAG(pp_leak_tracking, 1, cell)
+	{
+		leaks::enable(static_cast<bool>(params[1]));
+		return 1;
+	}
+
+	// native unit:pp_leak_reset();
+	AMX_DEFINE_NATIVE_TAG(pp_leak_reset, 0, cell)
+	{
+		leaks::reset();
+		return 1;
+	}
+
+	// native Map:pp_leak_map();
+	AMX_DEFINE_NATIVE_TAG(pp_leak_map, 0, map)
+	{
+		std::unordered_map<size_t, std::pair<size_t, size_t>> totals;
+		for(const auto &group : leaks::collect())
+		{
+			auto &total = totals[group.site];
+			total.first += group.objects;
+			total.second += group.bytes;
+		}
+		auto ptr = map_pool.add();
+		for(const auto &pair : totals)
+		{
+			auto name = strings::convert(leaks::describe(pair.first));
+			cell values[2] = {static_cast<cell>(pair.second.first), static_cast<cell>(pair.second.second)};
+			(*ptr)[dyn_object(name.c_str(), name.size() + 1, tags::find_tag(tags::tag_char))] = dyn_object(values, 2, tags::find_tag(tags::tag_cell));
+		}
+		return map_pool.get_id(ptr);
+	}
+
+	// native bool:pp_leak_dump(const file[]);
+	AMX_DEFINE_NATIVE_TAG(pp_leak_dump, 1, bool)
+	{
+		const char *file;
+		amx_StrParam(amx, params[1], file);
+		if(!file) amx_FormalError(errors::arg_empty, "file");
+		std::ofstream stream(file);
+		if(!stream)
+		{
+			return 0;
+		}
+		leaks::write_report(stream);
+		return static_cast<bool>(stream);
+	}
+
 	// native pp_num_natives();
 	AMX_DEFINE_NATIVE_TAG(pp_num_natives, 0, cell)
 	{
@@ -585,9 +918,42 @@ static AMX_NATIVE_INFO native_list[] =
 	AMX_DECLARE_NATIVE(pp_num_global_expressions),
 	AMX_DECLARE_NATIVE(pp_max_hooked_natives),
 	AMX_DECLARE_NATIVE(pp_num_hooked_natives),
+	AMX_DECLARE_NATIVE(pp_num_context_allocs),
+	AMX_DECLARE_NATIVE(pp_num_snapshot_allocs),
+	AMX_DECLARE_NATIVE(pp_num_handler_allocs),
+	AMX_DECLARE_NATIVE(pp_last_snapshot_size),
+	AMX_DECLARE_NATIVE(pp_num_shared_snapshots),
+	AMX_DECLARE_NATIVE(pp_num_snapshot_fallbacks),
 	AMX_DECLARE_NATIVE(pp_entry),
 	AMX_DECLARE_NATIVE(pp_entry_s),
 	AMX_DECLARE_NATIVE(pp_collect),
+	AMX_DECLARE_NATIVE(pp_gc_incremental),
+	AMX_DECLARE_NATIVE(pp_gc_sync_limit),
+	AMX_DECLARE_NATIVE(pp_gc_budget),
+	AMX_DECLARE_NATIVE(pp_num_pending_garbage),
+	AMX_DECLARE_NATIVE(pp_gc_last_pause),
+	AMX_DECLARE_NATIVE(pp_gc_max_pause),
+	AMX_DECLARE_NATIVE(pp_gc_total_pause),
+	AMX_DECLARE_NATIVE(pp_gc_num_pauses),
+	AMX_DECLARE_NATIVE(pp_gc_reset_stats),
+	AMX_DECLARE_NATIVE(pp_native_stats),
+	AMX_DECLARE_NATIVE(pp_native_stats_reset),
+	AMX_DECLARE_NATIVE(pp_native_stats_map),
+	AMX_DECLARE_NATIVE(pp_native_stats_histogram),
+	AMX_DECLARE_NATIVE(pp_trace_handlers),
+	AMX_DECLARE_NATIVE(pp_trace_reset),
+	AMX_DECLARE_NATIVE(pp_trace_stats),
+	AMX_DECLARE_NATIVE(pp_trace_dump),
+	AMX_DECLARE_NATIVE(pp_memory_usage),
+	AMX_DECLARE_NATIVE(pp_memory_script_usage),
+	AMX_DECLARE_NATIVE(pp_memory_stats),
+	AMX_DECLARE_NATIVE(pp_memory_reset_peaks),
+	AMX_DECLARE_NATIVE(pp_memory_tracking),
+	AMX_DECLARE_NATIVE(pp_memory_snapshots),
+	AMX_DECLARE_NATIVE(pp_leak_tracking),
+	AMX_DECLARE_NATIVE(pp_leak_reset),
+	AMX_DECLARE_NATIVE(pp_leak_map),
+	AMX_DECLARE_NATIVE(pp_leak_dump),
 	AMX_DECLARE_NATIVE(pp_num_natives),
 	AMX_DECLARE_NATIVE(pp_max_recursion),
 	AMX_DECLARE_NATIVE(pp_error_level),
@@ -8,6 +8,7 @@
 #include "modules/expressions.h"
 #include "modules/tag_ops.h"
 #include "objects/dyn_object.h"
+#include "utils/cell_search.h"
 
 #include <cstring>
 #include <algorithm>
@@ -591,7 +592,9 @@ namespace Natives
 
 		cell offset = optparam(3, 0);
 		strings::clamp_pos(*str, offset);
-		return str->find(params[2], static_cast<size_t>(offset));
+		const cell *begin = str->data(), *end = begin + str->size();
+		const cell *it = aux::find_cell(begin + offset, end, params[2]);
+		return it != end ? static_cast<cell>(it - begin) : -1;
 	}
 
 	// native str_find(StringTag:str, StringTag:value, offset=0);
@@ -606,7 +609,9 @@ namespace Natives
 		cell offset = optparam(3, 0);
 		strings::clamp_pos(*str1, offset);
 
-		return static_cast<cell>(str1->find(*str2, static_cast<size_t>(offset)));
+		const cell *begin = str1->data(), *end = begin + str1->size();
+		const cell *it = aux::find_cells(begin + offset, end, str2->data(), str2->size());
+		return it != end || str2->empty() ? static_cast<cell>(it - begin) : -1;
 	}
 
 	// native String:str_clear(StringTag:str);
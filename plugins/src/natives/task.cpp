@@ -4,8 +4,10 @@
 #include "errors.h"
 #include "modules/tasks.h"
 #include "modules/variants.h"
+#include "modules/containers.h"
 #include "objects/stored_param.h"
 #include <algorithm>
+#include <vector>
 
 using namespace tasks;
 
@@ -63,6 +65,201 @@ public:
 	}
 };
 
+// State shared by the handlers of a combinator, so that every completion of a subtask is processed in constant time
+struct task_combinator
+{
+	std::shared_ptr<task> created;
+	size_t remaining = 0;
+	bool finished = false;
+	std::vector<std::pair<task::handler_iterator, std::weak_ptr<task>>> handlers;
+	std::unique_ptr<std::vector<dyn_object>> results;
+};
+
+static std::shared_ptr<task> get_subtask(cell id)
+{
+	std::shared_ptr<task> ptr;
+	if(!tasks::get_by_id(id, ptr)) amx_LogicError(errors::pointer_invalid, "task", id);
+	return ptr;
+}
+
+static std::vector<std::shared_ptr<task>> get_subtasks_args(AMX *amx, cell *params, cell first)
+{
+	std::vector<std::shared_ptr<task>> list;
+	cell num = params[0] / sizeof(cell);
+	for(cell i = first; i <= num; i++)
+	{
+		list.push_back(get_subtask(*amx_GetAddrSafe(amx, params[i])));
+	}
+	return list;
+}
+
+static std::vector<std::shared_ptr<task>> get_subtasks_arr(AMX *amx, cell arr, cell size)
+{
+	if(size < 0) amx_LogicError(errors::out_of_range, "size");
+	cell *addr = amx_GetAddrSafe(amx, arr);
+	std::vector<std::shared_ptr<task>> list;
+	list.reserve(size);
+	for(cell i = 0; i < size; i++)
+	{
+		list.push_back(get_subtask(addr[i]));
+	}
+	return list;
+}
+
+static std::vector<std::shared_ptr<task>> get_subtasks_list(AMX *amx, cell id)
+{
+	list_t *ptr;
+	if(!list_pool.get_by_id(id, ptr)) amx_LogicError(errors::pointer_invalid, "list", id);
+	std::vector<std::shared_ptr<task>> list;
+	list.reserve(ptr->size());
+	for(const auto &obj : *ptr)
+	{
+		list.push_back(get_subtask(obj.get_cell(0)));
+	}
+	return list;
+}
+
+// Processes a finished subtask of task_all and similar, returning true if the combinator is finished
+static bool task_all_finished(task_combinator &state, task &t, size_t index)
+{
+	if(state.finished)
+	{
+		return false;
+	}
+	if(t.faulted())
+	{
+		state.finished = true;
+		state.results = nullptr;
+		return true;
+	}
+	if(state.results)
+	{
+		(*state.results)[index] = t.result();
+	}
+	if(--state.remaining == 0)
+	{
+		state.finished = true;
+		return true;
+	}
+	return false;
+}
+
+static dyn_object task_all_result(task_combinator &state, task &t)
+{
+	if(state.results)
+	{
+		auto list = list_pool.add();
+		for(auto &obj : *state.results)
+		{
+			list->push_back(std::move(obj));
+		}
+		state.results = nullptr;
+		return dyn_object(list_pool.get_id(list), tags::find_tag(tags::tag_list));
+	}
+	return dyn_object(tasks::get_id(&t), tags::find_tag(tags::tag_task));
+}
+
+static cell task_all(const std::vector<std::shared_ptr<task>> &list, bool collect)
+{
+	auto created = tasks::add();
+	auto state = std::make_shared<task_combinator>();
+	state->created = created;
+	state->remaining = list.size();
+	if(collect)
+	{
+		state->results.reset(new std::vector<dyn_object>(list.size()));
+	}
+
+	for(size_t i = 0; i < list.size(); i++)
+	{
+		auto &subtask = list[i];
+		if(subtask->completed() || subtask->faulted())
+		{
+			if(task_all_finished(*state, *subtask, i))
+			{
+				// the task is completed later, so that its id can still be obtained
+				if(subtask->faulted())
+				{
+					tasks::add_tick_task_error(created, 0, subtask->error());
+				}else{
+					tasks::add_tick_task_result(created, 0, task_all_result(*state, *subtask));
+				}
+				break;
+			}
+			continue;
+		}
+		subtask->register_handler([state, i](task &t)
+		{
+			if(task_all_finished(*state, t, i))
+			{
+				auto created = std::move(state->created);
+				if(t.faulted())
+				{
+					return created->set_faulted(t.error());
+				}
+				return created->set_completed(task_all_result(*state, t));
+			}
+			return 0;
+		});
+	}
+	if(list.empty())
+	{
+		tasks::add_tick_task_result(created, 0, task_all_result(*state, *created));
+	}
+	return tasks::get_id(created.get());
+}
+
+static cell task_any(const std::vector<std::shared_ptr<task>> &list)
+{
+	auto created = tasks::add();
+	auto state = std::make_shared<task_combinator>();
+	state->created = created;
+
+	for(auto &subtask : list)
+	{
+		if(subtask->completed() || subtask->faulted())
+		{
+			state->finished = true;
+			tasks::add_tick_task_result(created, 0, dyn_object(tasks::get_id(subtask.get()), tags::find_tag(tags::tag_task)));
+			break;
+		}
+		auto it = subtask->register_handler([state](task &t)
+		{
+			if(state->finished)
+			{
+				return 0;
+			}
+			state->finished = true;
+			for(auto &reg : state->handlers)
+			{
+				if(auto lock = reg.second.lock())
+				{
+					if(lock.get() != &t)
+					{
+						lock->unregister_handler(reg.first);
+					}
+				}
+			}
+			state->handlers.clear();
+			auto created = std::move(state->created);
+			return created->set_completed(dyn_object(tasks::get_id(&t), tags::find_tag(tags::tag_task)));
+		});
+		state->handlers.push_back(std::make_pair(it, subtask));
+	}
+	if(state->finished)
+	{
+		for(auto &reg : state->handlers)
+		{
+			if(auto lock = reg.second.lock())
+			{
+				lock->unregister_handler(reg.first);
+			}
+		}
+		state->handlers.clear();
+	}
+	return tasks::get_id(created.get());
+}
+
 namespace Natives
 {
 	// native Task:wait_ticks(ticks);
@@ -274,67 +471,49 @@ namespace Natives
 	// native Task:task_any(Task:...);
 	AMX_DEFINE_NATIVE_TAG(task_any, 0, task)
 	{
-		auto created = tasks::add();
-		cell num = params[0] / sizeof(cell);
-		auto list = std::make_shared<std::vector<std::pair<tasks::task::handler_iterator, std::weak_ptr<tasks::task>>>>();
-		for(cell i = 1; i <= num; i++)
-		{
-			cell *addr = amx_GetAddrSafe(amx, params[i]);
-			std::shared_ptr<task> task;
-			if(!tasks::get_by_id(*addr, task)) amx_LogicError(errors::pointer_invalid, "task", *addr);
-			
-			auto it = task->register_handler([created, list](tasks::task &t)
-			{
-				for(auto &reg : *list)
-				{
-					if(auto lock2 = reg.second.lock())
-					{
-						if(lock2.get() != &t)
-						{
-							lock2->unregister_handler(reg.first);
-						}
-					}
-				}
-				list->clear();
-				return created->set_completed(dyn_object(tasks::get_id(&t), tags::find_tag(tags::tag_task)));
-			});
-			list->push_back(std::make_pair(it, task));
-		}
-		return tasks::get_id(created.get());
+		return ::task_any(get_subtasks_args(amx, params, 1));
 	}
 
 	// native Task:task_all(Task:...);
 	AMX_DEFINE_NATIVE_TAG(task_all, 0, task)
 	{
-		auto created = tasks::add();
-		cell num = params[0] / sizeof(cell);
-		auto list = std::make_shared<std::vector<std::weak_ptr<tasks::task>>>();
-		for(cell i = 1; i <= num; i++)
-		{
-			cell *addr = amx_GetAddrSafe(amx, params[i]);
-			std::shared_ptr<task> task;
-			if(!tasks::get_by_id(*addr, task)) amx_LogicError(errors::pointer_invalid, "task", *addr);
-			
-			task->register_handler([created, list](tasks::task &t)
-			{
-				cell val = 0;
-				if(std::all_of(list->begin(), list->end(), [](std::weak_ptr<tasks::task> &ptr)
-				{
-					if(auto lock = ptr.lock())
-					{
-						return lock->completed();
-					}
-					return true;
-				}))
-				{
-					list->clear();
-					val = created->set_completed(dyn_object(tasks::get_id(&t), tags::find_tag(tags::tag_task)));
-				}
-				return val;
-			});
-			list->push_back(task);
-		}
-		return tasks::get_id(created.get());
+		return ::task_all(get_subtasks_args(amx, params, 1), false);
+	}
+
+	// native Task:task_any_arr(const Task:tasks[], size=sizeof(tasks));
+	AMX_DEFINE_NATIVE_TAG(task_any_arr, 2, task)
+	{
+		return ::task_any(get_subtasks_arr(amx, params[1], params[2]));
+	}
+
+	// native Task:task_all_arr(const Task:tasks[], size=sizeof(tasks));
+	AMX_DEFINE_NATIVE_TAG(task_all_arr, 2, task)
+	{
+		return ::task_all(get_subtasks_arr(amx, params[1], params[2]), false);
+	}
+
+	// native Task:task_any_list(List:tasks);
+	AMX_DEFINE_NATIVE_TAG(task_any_list, 1, task)
+	{
+		return ::task_any(get_subtasks_list(amx, params[1]));
+	}
+
+	// native Task:task_all_list(List:tasks);
+	AMX_DEFINE_NATIVE_TAG(task_all_list, 1, task)
+	{
+		return ::task_all(get_subtasks_list(amx, params[1]), false);
+	}
+
+	// native Task:task_when_all_results(List:tasks);
+	AMX_DEFINE_NATIVE_TAG(task_when_all_results, 1, task)
+	{
+		return ::task_all(get_subtasks_list(amx, params[1]), true);
+	}
+
+	// native Task:task_when_all_results_arr(const Task:tasks[], size=sizeof(tasks));
+	AMX_DEFINE_NATIVE_TAG(task_when_all_results_arr, 2, task)
+	{
+		return ::task_all(get_subtasks_arr(amx, params[1], params[2]), true);
 	}
 
 	// native task_state:task_wait(Task:task);
@@ -560,10 +739,14 @@ namespace Natives
 	// native task_config(task_restore:heap=task_restore_full, task_restore:stack=task_restore_full);
 	AMX_DEFINE_NATIVE_TAG(task_config, 0, cell)
 	{
+		cell heap = optparam(1, 3);
+		cell stack = optparam(2, 3);
+		if(heap < 0 || heap > static_cast<cell>(amx::restore_range::analysed)) amx_LogicError(errors::out_of_range, "heap");
+		if(stack < 0 || stack > static_cast<cell>(amx::restore_range::analysed)) amx_LogicError(errors::out_of_range, "stack");
 		amx::object owner;
 		auto &info = tasks::get_extra(amx, owner);
-		info.restore_heap = static_cast<amx::restore_range>(optparam(1, 3));
-		info.restore_stack = static_cast<amx::restore_range>(optparam(2, 3));
+		info.restore_heap = static_cast<amx::restore_range>(heap);
+		info.restore_stack = static_cast<amx::restore_range>(stack);
 		return 0;
 	}
 
@@ -770,6 +953,12 @@ static AMX_NATIVE_INFO native_list[] =
 	AMX_DECLARE_NATIVE(task_ms),
 	AMX_DECLARE_NATIVE(task_any),
 	AMX_DECLARE_NATIVE(task_all),
+	AMX_DECLARE_NATIVE(task_any_arr),
+	AMX_DECLARE_NATIVE(task_all_arr),
+	AMX_DECLARE_NATIVE(task_any_list),
+	AMX_DECLARE_NATIVE(task_all_list),
+	AMX_DECLARE_NATIVE(task_when_all_results),
+	AMX_DECLARE_NATIVE(task_when_all_results_arr),
 	AMX_DECLARE_NATIVE(task_wait),
 	AMX_DECLARE_NATIVE(task_yield),
 	AMX_DECLARE_NATIVE(task_set_yielded),
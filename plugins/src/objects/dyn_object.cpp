@@ -216,6 +216,23 @@ dyn_object::dyn_object(const cell *arr, cell size, tag_ptr tag) : rank(1), tag(t
 	init_op();
 }
 
+dyn_object::dyn_object(cell rank, const cell *data, cell size, tag_ptr tag) : rank(static_cast<unsigned char>(rank)), tag(tag)
+{
+	if(rank < 1 || rank > 3)
+	{
+		amx_LogicError(errors::out_of_range, "rank");
+	}
+	if(size < 0)
+	{
+		amx_LogicError(errors::out_of_range, "size");
+	}
+	array_data = new cell[size + 2];
+	std::memcpy(array_data + 1, data, size * sizeof(cell));
+	array_data[size + 1] = 0;
+	array_data[0] = size + 1;
+	init_op();
+}
+
 dyn_object::dyn_object(const dyn_object &obj, bool assign) : rank(obj.rank), tag(obj.tag)
 {
 	if(rank > 0)
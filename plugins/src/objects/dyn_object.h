@@ -38,6 +38,8 @@ public:
 	}
 
 	dyn_object(const cell *arr, cell size, tag_ptr tag);
+	// the data is in the layout of data_begin to end, including the indirection vectors
+	dyn_object(cell rank, const cell *data, cell size, tag_ptr tag);
 	dyn_object(AMX *amx, const cell *arr, cell size, cell size2, tag_ptr tag);
 	dyn_object(AMX *amx, const cell *arr, cell size, cell size2, cell size3, tag_ptr tag);
 
@@ -136,6 +138,12 @@ public:
 		return rank > 0 ? array_data == nullptr || *array_data <= 1 : false;
 	}
 
+	// the number of bytes allocated for the array data
+	size_t heap_size() const noexcept
+	{
+		return rank > 0 && array_data != nullptr ? (static_cast<size_t>(array_data[0]) + 1) * sizeof(cell) : 0;
+	}
+
 	bool is_null() const
 	{
 		return rank > 0 && array_data == nullptr;
@@ -5,6 +5,7 @@
 #include "utils/shared_id_set_pool.h"
 #include "sdk/amx/amx.h"
 #include <vector>
+#include <deque>
 #include <unordered_map>
 #include <type_traits>
 #include <memory>
@@ -228,25 +229,64 @@ private:
 	list_type local_object_list;
 	std::unordered_map<const_inner_ptr, const ref_container*> inner_cache;
 
+	// unreachable local objects awaiting incremental destruction
+	std::deque<list_type> garbage;
+	size_t garbage_count = 0;
+
+	// called with every newly created object, but not when objects move between the lists
+	void (*observer)(const void *obj) = nullptr;
+	// called with every object that is destroyed by the pool
+	void (*remove_observer)(const void *obj) = nullptr;
+	// called with every object obtained by its ID
+	void (*access_observer)(const void *obj) = nullptr;
+
+	void observe_removed(const list_type &list)
+	{
+		if(remove_observer)
+		{
+			for(const auto &pair : list)
+			{
+				remove_observer(pair.first);
+			}
+		}
+	}
+
+	const std::shared_ptr<ref_container> &observe(const std::shared_ptr<ref_container> &ptr)
+	{
+		if(observer)
+		{
+			observer(ptr.get());
+		}
+		return ptr;
+	}
+
+	void observe_access(const ref_container *obj)
+	{
+		if(access_observer)
+		{
+			access_observer(obj);
+		}
+	}
+
 public:
 	object_ptr add()
 	{
-		return *local_object_list.add();
+		return *observe(local_object_list.add());
 	}
 
 	object_ptr add(ObjType &&obj)
 	{
-		return *local_object_list.emplace(std::move(obj));
+		return *observe(local_object_list.emplace(std::move(obj)));
 	}
 
 	object_ptr add(ref_container &&obj)
 	{
-		return *local_object_list.add(std::move(obj));
+		return *observe(local_object_list.add(std::move(obj)));
 	}
 
 	object_ptr add(std::shared_ptr<ref_container> &&obj)
 	{
-		return *local_object_list.add(std::move(obj));
+		return *observe(local_object_list.add(std::move(obj)));
 	}
 
 	/*object_ptr add(std::unique_ptr<ref_container> &&obj)
@@ -257,13 +297,28 @@ public:
 	template <class... Args>
 	object_ptr emplace(Args &&...args)
 	{
-		return *local_object_list.emplace(std::forward<Args>(args)...);
+		return *observe(local_object_list.emplace(std::forward<Args>(args)...));
 	}
 
 	template <class Type, class... Args>
 	object_ptr emplace_derived(Args &&...args)
 	{
-		return *local_object_list.template emplace_derived<Type>(std::forward<Args>(args)...);
+		return *observe(local_object_list.template emplace_derived<Type>(std::forward<Args>(args)...));
+	}
+
+	void set_observer(void (*func)(const void *obj))
+	{
+		observer = func;
+	}
+
+	void set_remove_observer(void (*func)(const void *obj))
+	{
+		remove_observer = func;
+	}
+
+	void set_access_observer(void (*func)(const void *obj))
+	{
+		access_observer = func;
 	}
 
 	cell get_address(AMX *amx, const_object_ptr obj) const
@@ -349,19 +404,7 @@ public:
 
 	bool remove(object_ptr obj)
 	{
-		auto it = global_object_list.find(&obj);
-		if(it != global_object_list.end())
-		{
-			global_object_list.erase(it);
-			return true;
-		}
-		it = local_object_list.find(&obj);
-		if(it != local_object_list.end())
-		{
-			local_object_list.erase(it);
-			return true;
-		}
-		return false;
+		return remove_by_id(reinterpret_cast<cell>(&obj));
 	}
 
 	bool remove_by_id(cell id)
@@ -370,12 +413,14 @@ public:
 		auto it = global_object_list.find(obj);
 		if(it != global_object_list.end())
 		{
+			if(remove_observer) remove_observer(obj);
 			global_object_list.erase(it);
 			return true;
 		}
 		it = local_object_list.find(obj);
 		if(it != local_object_list.end())
 		{
+			if(remove_observer) remove_observer(obj);
 			local_object_list.erase(it);
 			return true;
 		}
@@ -386,28 +431,68 @@ public:
 	{
 		inner_cache.clear();
 		auto tmp = std::move(local_object_list);
+		observe_removed(tmp);
 		tmp.clear();
 		auto list = std::move(global_object_list);
+		observe_removed(list);
 		list.clear();
+		garbage_count = 0;
+		auto old = std::move(garbage);
+		for(const auto &list : old)
+		{
+			observe_removed(list);
+		}
+		old.clear();
 	}
 
 	void clear_tmp()
 	{
 		inner_cache.clear();
 		auto tmp = std::move(local_object_list);
+		observe_removed(tmp);
 		tmp.clear();
 	}
 
-	bool get_by_id(cell id, ref_container *&obj)
+	// detaches all local objects; they are destroyed later by collect_garbage
+	void clear_tmp_deferred()
 	{
-		obj = reinterpret_cast<ref_container*>(id);
+		inner_cache.clear();
+		if(local_object_list.size() == 0) return;
+		garbage_count += local_object_list.size();
+		garbage.push_back(std::move(local_object_list));
+	}
 
-		if(local_object_list.find(obj) != local_object_list.end())
+	size_t collect_garbage(size_t max_count)
+	{
+		size_t count = 0;
+		while(count < max_count && !garbage.empty())
 		{
-			return true;
+			auto &list = garbage.front();
+			if(list.size() == 0)
+			{
+				garbage.pop_front();
+				continue;
+			}
+			if(remove_observer) remove_observer(list.begin()->first);
+			auto ptr = list.extract(list.begin());
+			garbage_count--;
+			count++;
 		}
-		if(global_object_list.find(obj) != global_object_list.end())
+		return count;
+	}
+
+	size_t garbage_size() const
+	{
+		return garbage_count;
+	}
+
+	bool get_by_id(cell id, ref_container *&obj)
+	{
+		obj = reinterpret_cast<ref_container*>(id);
+
+		if(local_object_list.find(obj) != local_object_list.end() || global_object_list.find(obj) != global_object_list.end())
 		{
+			observe_access(obj);
 			return true;
 		}
 		return false;
@@ -417,13 +502,9 @@ public:
 	{
 		auto ptr = reinterpret_cast<ref_container*>(id);
 
-		if(local_object_list.find(ptr) != local_object_list.end())
-		{
-			obj = *ptr;
-			return true;
-		}
-		if(global_object_list.find(ptr) != global_object_list.end())
+		if(local_object_list.find(ptr) != local_object_list.end() || global_object_list.find(ptr) != global_object_list.end())
 		{
+			observe_access(ptr);
 			obj = *ptr;
 			return true;
 		}
@@ -433,12 +514,9 @@ public:
 
 	bool get_by_id(cell id, std::shared_ptr<ref_container> &obj)
 	{
-		if(local_object_list.get_by_id(id, obj))
-		{
-			return true;
-		}
-		if(global_object_list.get_by_id(id, obj))
+		if(local_object_list.get_by_id(id, obj) || global_object_list.get_by_id(id, obj))
 		{
+			observe_access(obj.get());
 			return true;
 		}
 		return false;
@@ -490,17 +568,29 @@ public:
 	{
 		obj = reinterpret_cast<ref_container*>(amx_GetData(amx) + addr);
 
-		auto it = local_object_list.find(obj);
-		if(it != local_object_list.end())
+		if(local_object_list.find(obj) != local_object_list.end() || global_object_list.find(obj) != global_object_list.end())
 		{
+			observe_access(obj);
 			return true;
 		}
-		it = global_object_list.find(obj);
-		if(it != global_object_list.end())
+		return false;
+	}
+
+	// visits all live global objects, and local objects unless global_only
+	template <class Func>
+	void for_each(Func func, bool global_only = false) const
+	{
+		if(!global_only)
 		{
-			return true;
+			for(const auto &pair : local_object_list)
+			{
+				func(*pair.second);
+			}
+		}
+		for(const auto &pair : global_object_list)
+		{
+			func(*pair.second);
 		}
-		return false;
 	}
 
 	size_t local_size() const
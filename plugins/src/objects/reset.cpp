@@ -2,9 +2,211 @@
 #include "main.h"
 #include "fixes/linux.h"
 #include <cstring>
+#include <unordered_map>
+#include <algorithm>
+
+constexpr size_t max_free_buffers = 16;
+
+size_t snapshot_alloc_count = 0;
+size_t snapshot_last_size = 0;
+size_t snapshot_shared_count = 0;
+size_t snapshot_fallback_count = 0;
+
+typedef std::shared_ptr<const std::vector<unsigned char>> shared_buffer;
+
+// snapshot buffers released by finished resets, reused by the next await
+struct snapshot_buffers : public amx::extra
+{
+	std::vector<std::vector<unsigned char>> free;
+	std::unordered_multimap<size_t, std::weak_ptr<const std::vector<unsigned char>>> shared;
+	size_t shared_sweep = 64;
+	size_t live = 0;
+	size_t peak = 0;
+
+	snapshot_buffers(AMX *amx) : amx::extra(amx)
+	{
+
+	}
+};
+
+void acquire_buffer(const amx::object &obj, std::vector<unsigned char> &buffer, size_t size)
+{
+	if(is_main_thread && obj)
+	{
+		auto &free = obj->get_extra<snapshot_buffers>().free;
+		for(auto it = free.rbegin(); it != free.rend(); ++it)
+		{
+			if(it->capacity() >= size)
+			{
+				buffer = std::move(*it);
+				free.erase(std::next(it).base());
+				break;
+			}
+		}
+	}
+	if(buffer.capacity() < size && is_main_thread)
+	{
+		snapshot_alloc_count++;
+	}
+	buffer.resize(size);
+}
+
+size_t hash_region(const unsigned char *data, size_t size)
+{
+	size_t hash = 2166136261u;
+	for(size_t i = 0; i + sizeof(cell) <= size; i += sizeof(cell))
+	{
+		cell value;
+		std::memcpy(&value, data + i, sizeof(cell));
+		hash = (hash ^ static_cast<ucell>(value)) * 16777619u;
+	}
+	return hash ^ size;
+}
+
+// returns an existing snapshot with the same contents if there is one
+shared_buffer share_region(const amx::object &obj, const unsigned char *data, size_t size)
+{
+	if(!is_main_thread || !obj)
+	{
+		return std::make_shared<std::vector<unsigned char>>(data, data + size);
+	}
+	auto &buffers = obj->get_extra<snapshot_buffers>();
+	size_t hash = hash_region(data, size);
+	auto range = buffers.shared.equal_range(hash);
+	for(auto it = range.first; it != range.second;)
+	{
+		if(auto buffer = it->second.lock())
+		{
+			if(buffer->size() == size && std::memcmp(buffer->data(), data, size) == 0)
+			{
+				snapshot_shared_count++;
+				return buffer;
+			}
+			++it;
+		}else{
+			it = buffers.shared.erase(it);
+		}
+	}
+	if(buffers.shared.size() >= buffers.shared_sweep)
+	{
+		for(auto it = buffers.shared.begin(); it != buffers.shared.end();)
+		{
+			if(it->second.expired())
+			{
+				it = buffers.shared.erase(it);
+			}else{
+				++it;
+			}
+		}
+		buffers.shared_sweep = std::max(static_cast<size_t>(64), buffers.shared.size() * 2);
+	}
+	shared_buffer buffer = std::make_shared<std::vector<unsigned char>>(data, data + size);
+	snapshot_alloc_count++;
+	buffers.shared.emplace(hash, buffer);
+	return buffer;
+}
+
+// finds the arguments of the public that is running, by following the frame chain
+// down to the entry frame, whose arguments end at reset_stk
+bool find_entry_args(AMX *amx, unsigned char *dat, cell &args_begin, cell &args_end)
+{
+	cell frm = amx->frm;
+	while(true)
+	{
+		if(frm < amx->stk || frm % sizeof(cell) != 0 || frm > amx->reset_stk - 3 * static_cast<cell>(sizeof(cell)))
+		{
+			return false;
+		}
+		// saved frm, return address, size of the arguments, arguments
+		const cell *frame = reinterpret_cast<const cell*>(dat + frm);
+		cell args = frame[2];
+		if(args >= 0 && args % sizeof(cell) == 0 && frm + 3 * static_cast<cell>(sizeof(cell)) + args == amx->reset_stk)
+		{
+			args_begin = frm + 3 * sizeof(cell);
+			args_end = amx->reset_stk;
+			return true;
+		}
+		if(frame[0] == 0 && frame[1] == 0)
+		{
+			// the entry frame does not end at reset_stk
+			return false;
+		}
+		if(frame[0] <= frm)
+		{
+			return false;
+		}
+		frm = frame[0];
+	}
+}
+
+void release_buffer(const amx::object &obj, std::vector<unsigned char> &buffer)
+{
+	if(buffer.capacity() == 0) return;
+	auto &free = obj->get_extra<snapshot_buffers>().free;
+	if(free.size() < max_free_buffers)
+	{
+		free.push_back(std::move(buffer));
+	}
+	buffer = std::vector<unsigned char>();
+}
 
 namespace amx
 {
+	size_t snapshot_allocs()
+	{
+		return snapshot_alloc_count;
+	}
+
+	size_t last_snapshot_size()
+	{
+		return snapshot_last_size;
+	}
+
+	size_t shared_snapshots()
+	{
+		return snapshot_shared_count;
+	}
+
+	size_t snapshot_fallbacks()
+	{
+		return snapshot_fallback_count;
+	}
+
+	snapshot_usage snapshot_memory(AMX *amx)
+	{
+		snapshot_usage usage;
+		const auto &obj = amx::load_lock(amx);
+		if(!obj->has_extra<snapshot_buffers>())
+		{
+			return usage;
+		}
+		auto &buffers = obj->get_extra<snapshot_buffers>();
+		usage.live = buffers.live;
+		usage.peak = buffers.peak;
+		for(const auto &pair : buffers.shared)
+		{
+			if(auto buffer = pair.second.lock())
+			{
+				usage.shared += buffer->capacity();
+			}
+		}
+		for(const auto &buffer : buffers.free)
+		{
+			usage.cached += buffer.capacity();
+		}
+		return usage;
+	}
+
+	void reset_snapshot_peak(AMX *amx)
+	{
+		const auto &obj = amx::load_lock(amx);
+		if(obj->has_extra<snapshot_buffers>())
+		{
+			auto &buffers = obj->get_extra<snapshot_buffers>();
+			buffers.peak = buffers.live;
+		}
+	}
+
 	reset::reset(AMX* amx, bool context, restore_range restore_heap, restore_range restore_stack) : amx(amx::load(amx)), cip(amx->cip), frm(amx->frm), pri(amx->pri), alt(amx->alt), hea(amx->hea), reset_hea(amx->reset_hea), stk(amx->stk), reset_stk(amx->reset_stk), restore_heap(restore_heap), restore_stack(restore_stack)
 	{
 		if(context)
@@ -16,6 +218,36 @@ namespace amx
 		unsigned char *dat;
 
 		dat = amx_GetData(amx);
+		auto obj = this->amx.lock();
+
+		cell args_begin = 0, args_end = 0;
+		bool analysed = false, outer_refs = false;
+		if(restore_heap == restore_range::analysed || restore_stack == restore_range::analysed)
+		{
+			analysed = find_entry_args(amx, dat, args_begin, args_end);
+			heap_begin = reset_hea;
+			for(cell arg = args_begin; arg < args_end; arg += sizeof(cell))
+			{
+				cell value = *reinterpret_cast<cell*>(dat + arg);
+				if(value >= amx->hlw && value < heap_begin)
+				{
+					// a string or array passed on the heap
+					heap_begin = value - value % sizeof(cell);
+				}else if(value >= args_end && value < amx->stp)
+				{
+					// a reference into the caller's frames
+					outer_refs = true;
+				}
+			}
+			if(!analysed)
+			{
+				heap_begin = amx->hlw;
+			}
+			if((!analysed || outer_refs) && is_main_thread)
+			{
+				snapshot_fallback_count++;
+			}
+		}
 
 		unsigned char *h;
 		size_t heap_size;
@@ -33,11 +265,24 @@ namespace amx
 				h = dat + amx->hlw;
 				heap_size = hea - amx->hlw;
 				break;
+			case restore_range::analysed:
+				h = dat + heap_begin;
+				heap_size = hea - heap_begin;
+				break;
+			default:
+				this->restore_heap = restore_range::none;
+				heap_size = 0;
+				break;
 		}
 		if(heap_size > 0)
 		{
-			heap = std::make_unique<unsigned char[]>(heap_size);
-			std::memcpy(heap.get(), h, heap_size);
+			if(restore_heap == restore_range::analysed)
+			{
+				shared_heap = share_region(obj, h, heap_size);
+			}else{
+				acquire_buffer(obj, heap, heap_size);
+				std::memcpy(heap.data(), h, heap_size);
+			}
 		}
 
 		size_t stack_size;
@@ -56,18 +301,47 @@ namespace amx
 			case restore_range::full:
 				stack_size = amx->stp - stk;
 				break;
+			case restore_range::analysed:
+				if(analysed && !outer_refs)
+				{
+					stack_size = args_end - stk;
+				}else{
+					stack_size = amx->stp - stk;
+				}
+				break;
+			default:
+				this->restore_stack = restore_range::none;
+				stack_size = 0;
+				break;
+		}
+		if(is_main_thread)
+		{
+			snapshot_last_size = heap_size + stack_size;
 		}
 		if(stack_size > 0)
 		{
 			unsigned char *s = dat + stk;
-			stack = std::make_unique<unsigned char[]>(stack_size);
-			std::memcpy(stack.get(), s, stack_size);
+			acquire_buffer(obj, stack, stack_size);
+			std::memcpy(stack.data(), s, stack_size);
 			if(restore_stack == restore_range::frame)
 			{
 				// set return address to 0 (HALT 0)
 				reinterpret_cast<cell&>(stack[frm + sizeof(cell) - stk]) = 0;
 			}
 		}
+		if(is_main_thread && obj)
+		{
+			accounted = heap.capacity() + stack.capacity();
+			if(accounted > 0)
+			{
+				auto &buffers = obj->get_extra<snapshot_buffers>();
+				buffers.live += accounted;
+				if(buffers.live > buffers.peak)
+				{
+					buffers.peak = buffers.live;
+				}
+			}
+		}
 	}
 
 	bool reset::restore()
@@ -100,7 +374,7 @@ namespace amx
 		amx->stk = stk;
 		amx->reset_stk = reset_stk;
 
-		if(heap)
+		if(!heap.empty())
 		{
 			unsigned char *h;
 			size_t heap_size;
@@ -118,14 +392,20 @@ namespace amx
 					h = dat + amx->hlw;
 					heap_size = hea - amx->hlw;
 					break;
+				default:
+					heap_size = 0;
+					break;
 			}
 			if(heap_size > 0)
 			{
-				std::memcpy(h, heap.get(), heap_size);
+				std::memcpy(h, heap.data(), heap_size);
 			}
+		}else if(shared_heap)
+		{
+			std::memcpy(dat + heap_begin, shared_heap->data(), shared_heap->size());
 		}
 
-		if(stack)
+		if(!stack.empty())
 		{
 			size_t stack_size;
 			switch(restore_stack)
@@ -135,7 +415,7 @@ namespace amx
 					break;
 				case restore_range::frame:
 					stack_size = frm + sizeof(cell) * 2 - stk;
-					stack_size += sizeof(cell) + reinterpret_cast<cell&>(stack[stack_size]);
+					stack_size += sizeof(cell) + reinterpret_cast<const cell&>(stack[stack_size]);
 					break;
 				case restore_range::context:
 					stack_size = reset_stk - stk;
@@ -143,35 +423,64 @@ namespace amx
 				case restore_range::full:
 					stack_size = amx->stp - stk;
 					break;
+				default:
+					stack_size = stack.size();
+					break;
 			}
 			if(stack_size > 0)
 			{
 				unsigned char *s = dat + stk;
-				std::memcpy(s, stack.get(), stack_size);
+				std::memcpy(s, stack.data(), stack_size);
 			}
 		}
 
 		return true;
 	}
 
-	reset::reset(reset &&obj) : context(std::move(obj.context)), amx(obj.amx), cip(obj.cip), frm(obj.frm), pri(obj.pri), alt(obj.alt), hea(obj.hea), reset_hea(obj.reset_hea), heap(std::move(obj.heap)), stk(obj.stk), reset_stk(obj.reset_stk), stack(std::move(obj.stack)), restore_heap(obj.restore_heap), restore_stack(obj.restore_stack)
+	reset::reset(reset &&obj) : context(std::move(obj.context)), amx(obj.amx), cip(obj.cip), frm(obj.frm), pri(obj.pri), alt(obj.alt), hea(obj.hea), reset_hea(obj.reset_hea), heap(std::move(obj.heap)), shared_heap(std::move(obj.shared_heap)), heap_begin(obj.heap_begin), stk(obj.stk), reset_stk(obj.reset_stk), stack(std::move(obj.stack)), restore_heap(obj.restore_heap), restore_stack(obj.restore_stack), accounted(obj.accounted)
 	{
-
+		obj.accounted = 0;
 	}
 
 	reset &reset::operator=(reset &&obj)
 	{
 		if(this == &obj) return *this;
 
+		release_buffers();
 		context = std::move(obj.context);
 		amx = obj.amx;
 		cip = obj.cip, frm = obj.frm, pri = obj.pri, alt = obj.alt;
 		stk = obj.stk, reset_stk = obj.reset_stk;
 		hea = obj.hea, reset_hea = obj.reset_hea;
 		heap = std::move(obj.heap);
+		shared_heap = std::move(obj.shared_heap);
+		heap_begin = obj.heap_begin;
 		stack = std::move(obj.stack);
 		restore_heap = obj.restore_heap;
 		restore_stack = obj.restore_stack;
+		accounted = obj.accounted;
+		obj.accounted = 0;
 		return *this;
 	}
+
+	reset::~reset()
+	{
+		release_buffers();
+	}
+
+	void reset::release_buffers()
+	{
+		if(!is_main_thread) return;
+		if(heap.capacity() == 0 && stack.capacity() == 0) return;
+		auto obj = amx.lock();
+		if(!obj || !obj->valid()) return;
+		if(accounted > 0)
+		{
+			auto &buffers = obj->get_extra<snapshot_buffers>();
+			buffers.live -= std::min(buffers.live, accounted);
+			accounted = 0;
+		}
+		release_buffer(obj, heap);
+		release_buffer(obj, stack);
+	}
 }
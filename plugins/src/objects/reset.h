@@ -5,6 +5,7 @@
 #include "amxinfo.h"
 
 #include <memory>
+#include <vector>
 #include "sdk/amx/amx.h"
 
 namespace amx
@@ -15,13 +16,19 @@ namespace amx
 		frame = 1,
 		context = 2,
 		full = 3,
+		analysed = 4,
 	};
 
 	struct reset
 	{
 		cell cip, frm, pri, alt, hea, reset_hea, stk, reset_stk;
 		restore_range restore_heap, restore_stack;
-		std::unique_ptr<unsigned char[]> heap, stack;
+		std::vector<unsigned char> heap, stack;
+		// analysed heap snapshots are shared between identical captures
+		std::shared_ptr<const std::vector<unsigned char>> shared_heap;
+		cell heap_begin = 0;
+		// the size of the buffers counted in the snapshot memory of the AMX
+		size_t accounted = 0;
 		amx::context context;
 
 		amx::handle amx;
@@ -34,10 +41,34 @@ namespace amx
 		}
 		reset(reset &&obj);
 		reset &operator=(reset &&obj);
+		~reset();
 
 		bool restore();
 		bool restore_no_context() const;
+
+	private:
+		void release_buffers();
+	};
+
+	size_t snapshot_allocs();
+	size_t last_snapshot_size();
+	size_t shared_snapshots();
+	// analysed snapshots that had to capture the whole stack or heap
+	size_t snapshot_fallbacks();
+
+	struct snapshot_usage
+	{
+		// bytes held by pending snapshots, and the most there were at once
+		size_t live = 0;
+		size_t peak = 0;
+		// bytes of shared heap snapshots
+		size_t shared = 0;
+		// bytes of released buffers kept for reuse
+		size_t cached = 0;
 	};
+
+	snapshot_usage snapshot_memory(AMX *amx);
+	void reset_snapshot_peak(AMX *amx);
 }
 
 #endif
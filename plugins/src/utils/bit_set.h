@@ -0,0 +1,417 @@
+#ifndef BIT_SET_H_INCLUDED
+#define BIT_SET_H_INCLUDED
+
+#include <cstddef>
+#include <cstdint>
+#include <algorithm>
+#include <iterator>
+#include <vector>
+
+namespace aux
+{
+	inline size_t popcount(std::uint64_t word)
+	{
+#ifdef __GNUC__
+		return static_cast<size_t>(__builtin_popcountll(word));
+#else
+		word = word - ((word >> 1) & 0x5555555555555555ULL);
+		word = (word & 0x3333333333333333ULL) + ((word >> 2) & 0x3333333333333333ULL);
+		word = (word + (word >> 4)) & 0x0F0F0F0F0F0F0F0FULL;
+		return static_cast<size_t>((word * 0x0101010101010101ULL) >> 56);
+#endif
+	}
+
+	inline size_t lowest_bit(std::uint64_t word)
+	{
+#ifdef __GNUC__
+		return static_cast<size_t>(__builtin_ctzll(word));
+#else
+		return popcount((word & (0 - word)) - 1);
+#endif
+	}
+
+	inline size_t highest_bit(std::uint64_t word)
+	{
+#ifdef __GNUC__
+		return 63 - static_cast<size_t>(__builtin_clzll(word));
+#else
+		size_t bit = 0;
+		while(word >>= 1)
+		{
+			bit++;
+		}
+		return bit;
+#endif
+	}
+
+	// Set of integers. Values in [0, dense_limit) are stored in a bitmap,
+	// other values in a sorted vector, so small identifiers cost one bit each
+	// and set operations on them work on whole 64-bit words.
+	template <class Value>
+	class bit_set
+	{
+		typedef std::uint64_t word;
+		static constexpr size_t word_bits = 64;
+		static constexpr Value dense_limit = 1 << 20;
+
+		std::vector<word> dense;
+		std::vector<Value> sparse;
+		size_t count = 0;
+
+		static bool is_dense(Value value)
+		{
+			return value >= 0 && value < dense_limit;
+		}
+
+		void recount()
+		{
+			count = sparse.size();
+			for(word w : dense)
+			{
+				count += popcount(w);
+			}
+		}
+
+		// finds the first set bit at or after the position
+		bool dense_next(size_t pos, Value &result) const
+		{
+			size_t index = pos / word_bits;
+			if(index >= dense.size())
+			{
+				return false;
+			}
+			word w = dense[index] & (~word() << (pos % word_bits));
+			while(true)
+			{
+				if(w)
+				{
+					result = static_cast<Value>(index * word_bits + lowest_bit(w));
+					return true;
+				}
+				if(++index >= dense.size())
+				{
+					return false;
+				}
+				w = dense[index];
+			}
+		}
+
+		// finds the last set bit at or before the position
+		bool dense_prev(size_t pos, Value &result) const
+		{
+			if(dense.empty())
+			{
+				return false;
+			}
+			size_t index = pos / word_bits;
+			word w;
+			if(index >= dense.size())
+			{
+				index = dense.size() - 1;
+				w = dense[index];
+			}else{
+				size_t shift = word_bits - 1 - pos % word_bits;
+				w = dense[index] & (~word() >> shift);
+			}
+			while(true)
+			{
+				if(w)
+				{
+					result = static_cast<Value>(index * word_bits + highest_bit(w));
+					return true;
+				}
+				if(index-- == 0)
+				{
+					return false;
+				}
+				w = dense[index];
+			}
+		}
+
+	public:
+		size_t size() const
+		{
+			return count;
+		}
+
+		bool empty() const
+		{
+			return count == 0;
+		}
+
+		// the number of bytes allocated for the elements
+		size_t allocated() const
+		{
+			return dense.capacity() * sizeof(word) + sparse.capacity() * sizeof(Value);
+		}
+
+		void clear()
+		{
+			dense.clear();
+			sparse.clear();
+			count = 0;
+		}
+
+		void swap(bit_set &other)
+		{
+			dense.swap(other.dense);
+			sparse.swap(other.sparse);
+			std::swap(count, other.count);
+		}
+
+		bool contains(Value value) const
+		{
+			if(is_dense(value))
+			{
+				size_t index = static_cast<size_t>(value) / word_bits;
+				return index < dense.size() && (dense[index] >> (value % word_bits)) & 1;
+			}
+			return std::binary_search(sparse.begin(), sparse.end(), value);
+		}
+
+		bool insert(Value value)
+		{
+			if(is_dense(value))
+			{
+				size_t index = static_cast<size_t>(value) / word_bits;
+				if(index >= dense.size())
+				{
+					dense.resize(index + 1);
+				}
+				word bit = word(1) << (value % word_bits);
+				if(dense[index] & bit)
+				{
+					return false;
+				}
+				dense[index] |= bit;
+			}else{
+				auto it = std::lower_bound(sparse.begin(), sparse.end(), value);
+				if(it != sparse.end() && *it == value)
+				{
+					return false;
+				}
+				sparse.insert(it, value);
+			}
+			count++;
+			return true;
+		}
+
+		bool erase(Value value)
+		{
+			if(is_dense(value))
+			{
+				size_t index = static_cast<size_t>(value) / word_bits;
+				if(index >= dense.size())
+				{
+					return false;
+				}
+				word bit = word(1) << (value % word_bits);
+				if(!(dense[index] & bit))
+				{
+					return false;
+				}
+				dense[index] &= ~bit;
+			}else{
+				auto it = std::lower_bound(sparse.begin(), sparse.end(), value);
+				if(it == sparse.end() || *it != value)
+				{
+					return false;
+				}
+				sparse.erase(it);
+			}
+			count--;
+			return true;
+		}
+
+		void unite(const bit_set &other)
+		{
+			if(other.dense.size() > dense.size())
+			{
+				dense.resize(other.dense.size());
+			}
+			const word *src = other.dense.data();
+			word *dst = dense.data();
+			for(size_t i = 0, n = other.dense.size(); i < n; i++)
+			{
+				dst[i] |= src[i];
+			}
+			if(!other.sparse.empty())
+			{
+				std::vector<Value> result;
+				result.reserve(sparse.size() + other.sparse.size());
+				std::set_union(sparse.begin(), sparse.end(), other.sparse.begin(), other.sparse.end(), std::back_inserter(result));
+				sparse.swap(result);
+			}
+			recount();
+		}
+
+		void intersect(const bit_set &other)
+		{
+			if(dense.size() > other.dense.size())
+			{
+				dense.resize(other.dense.size());
+			}
+			const word *src = other.dense.data();
+			word *dst = dense.data();
+			for(size_t i = 0, n = dense.size(); i < n; i++)
+			{
+				dst[i] &= src[i];
+			}
+			if(!sparse.empty())
+			{
+				std::vector<Value> result;
+				std::set_intersection(sparse.begin(), sparse.end(), other.sparse.begin(), other.sparse.end(), std::back_inserter(result));
+				sparse.swap(result);
+			}
+			recount();
+		}
+
+		void subtract(const bit_set &other)
+		{
+			const word *src = other.dense.data();
+			word *dst = dense.data();
+			for(size_t i = 0, n = std::min(dense.size(), other.dense.size()); i < n; i++)
+			{
+				dst[i] &= ~src[i];
+			}
+			if(!sparse.empty() && !other.sparse.empty())
+			{
+				std::vector<Value> result;
+				std::set_difference(sparse.begin(), sparse.end(), other.sparse.begin(), other.sparse.end(), std::back_inserter(result));
+				sparse.swap(result);
+			}
+			recount();
+		}
+
+		bool operator==(const bit_set &other) const
+		{
+			if(count != other.count || sparse != other.sparse)
+			{
+				return false;
+			}
+			size_t n = std::min(dense.size(), other.dense.size());
+			if(!std::equal(dense.begin(), dense.begin() + n, other.dense.begin()))
+			{
+				return false;
+			}
+			const std::vector<word> &longer = dense.size() > n ? dense : other.dense;
+			return std::all_of(longer.begin() + n, longer.end(), [](word w) { return w == 0; });
+		}
+
+		bool operator!=(const bit_set &other) const
+		{
+			return !(*this == other);
+		}
+
+		bool first(Value &result) const
+		{
+			if(!sparse.empty() && sparse.front() < 0)
+			{
+				result = sparse.front();
+				return true;
+			}
+			if(dense_next(0, result))
+			{
+				return true;
+			}
+			if(!sparse.empty())
+			{
+				result = sparse.front();
+				return true;
+			}
+			return false;
+		}
+
+		bool last(Value &result) const
+		{
+			if(!sparse.empty() && sparse.back() >= dense_limit)
+			{
+				result = sparse.back();
+				return true;
+			}
+			if(dense_prev(dense.size() * word_bits, result))
+			{
+				return true;
+			}
+			if(!sparse.empty())
+			{
+				result = sparse.back();
+				return true;
+			}
+			return false;
+		}
+
+		// finds the smallest value greater than the argument
+		bool next(Value value, Value &result) const
+		{
+			auto it = std::upper_bound(sparse.begin(), sparse.end(), value);
+			if(value < dense_limit - 1)
+			{
+				Value found;
+				if(dense_next(value < 0 ? 0 : static_cast<size_t>(value) + 1, found))
+				{
+					if(it == sparse.end() || found < *it)
+					{
+						result = found;
+						return true;
+					}
+				}
+			}
+			if(it != sparse.end())
+			{
+				result = *it;
+				return true;
+			}
+			return false;
+		}
+
+		// finds the largest value less than the argument
+		bool prev(Value value, Value &result) const
+		{
+			auto it = std::lower_bound(sparse.begin(), sparse.end(), value);
+			if(value > 0)
+			{
+				Value found;
+				if(dense_prev(value > dense_limit ? static_cast<size_t>(dense_limit) - 1 : static_cast<size_t>(value) - 1, found))
+				{
+					if(it == sparse.begin() || found > *std::prev(it))
+					{
+						result = found;
+						return true;
+					}
+				}
+			}
+			if(it != sparse.begin())
+			{
+				result = *std::prev(it);
+				return true;
+			}
+			return false;
+		}
+
+		template <class Func>
+		void for_each(Func f) const
+		{
+			auto it = sparse.begin();
+			for(; it != sparse.end() && *it < 0; ++it)
+			{
+				f(*it);
+			}
+			for(size_t index = 0; index < dense.size(); index++)
+			{
+				word w = dense[index];
+				while(w)
+				{
+					f(static_cast<Value>(index * word_bits + lowest_bit(w)));
+					w &= w - 1;
+				}
+			}
+			for(; it != sparse.end(); ++it)
+			{
+				f(*it);
+			}
+		}
+	};
+}
+
+#endif
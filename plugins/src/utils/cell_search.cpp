@@ -0,0 +1,350 @@
+#include "cell_search.h"
+#include <cstring>
+#include <cstdint>
+
+#if defined(__i386__) || defined(__x86_64__) || defined(_M_IX86) || defined(_M_X64)
+#define CELL_SEARCH_X86
+#include <immintrin.h>
+#ifdef _MSC_VER
+#include <intrin.h>
+#define TARGET_SSE2
+#define TARGET_AVX2
+#else
+#define TARGET_SSE2 __attribute__((target("sse2")))
+#define TARGET_AVX2 __attribute__((target("avx2")))
+#endif
+#endif
+
+typedef const cell *(*find_func)(const cell *begin, const cell *end, cell value);
+typedef const cell *(*find_sub_func)(const cell *begin, const cell *end, const cell *sub, size_t sublen);
+typedef size_t(*count_func)(const cell *begin, const cell *end, cell value);
+
+struct search_kernels
+{
+	find_func find;
+	find_func find_last;
+	find_sub_func find_sub;
+	count_func count;
+};
+
+static const cell *find_scalar(const cell *begin, const cell *end, cell value)
+{
+	for(; begin != end; ++begin)
+	{
+		if(*begin == value)
+		{
+			return begin;
+		}
+	}
+	return end;
+}
+
+static const cell *find_last_scalar(const cell *begin, const cell *end, cell value)
+{
+	for(const cell *pos = end; pos != begin;)
+	{
+		if(*--pos == value)
+		{
+			return pos;
+		}
+	}
+	return end;
+}
+
+static size_t count_scalar(const cell *begin, const cell *end, cell value)
+{
+	size_t count = 0;
+	for(; begin != end; ++begin)
+	{
+		if(*begin == value)
+		{
+			++count;
+		}
+	}
+	return count;
+}
+
+static bool equal_cells(const cell *a, const cell *b, size_t count)
+{
+	return std::memcmp(a, b, count * sizeof(cell)) == 0;
+}
+
+// searches for the start of sub among the positions [begin, last]
+static const cell *find_sub_scalar_from(const cell *begin, const cell *last, const cell *end, const cell *sub, size_t sublen)
+{
+	for(; begin <= last; ++begin)
+	{
+		if(begin[0] == sub[0] && begin[sublen - 1] == sub[sublen - 1] && equal_cells(begin + 1, sub + 1, sublen - 2))
+		{
+			return begin;
+		}
+	}
+	return end;
+}
+
+static const cell *find_sub_scalar(const cell *begin, const cell *end, const cell *sub, size_t sublen)
+{
+	return find_sub_scalar_from(begin, end - sublen, end, sub, sublen);
+}
+
+#ifdef CELL_SEARCH_X86
+static inline unsigned int lowest_bit(unsigned int mask)
+{
+#ifdef _MSC_VER
+	unsigned long index;
+	_BitScanForward(&index, mask);
+	return index;
+#else
+	return __builtin_ctz(mask);
+#endif
+}
+
+static inline unsigned int highest_bit(unsigned int mask)
+{
+#ifdef _MSC_VER
+	unsigned long index;
+	_BitScanReverse(&index, mask);
+	return index;
+#else
+	return 31 - __builtin_clz(mask);
+#endif
+}
+
+TARGET_SSE2 static const cell *find_sse2(const cell *begin, const cell *end, cell value)
+{
+	__m128i needle = _mm_set1_epi32(value);
+	for(; end - begin >= 4; begin += 4)
+	{
+		__m128i block = _mm_loadu_si128(reinterpret_cast<const __m128i*>(begin));
+		int mask = _mm_movemask_ps(_mm_castsi128_ps(_mm_cmpeq_epi32(block, needle)));
+		if(mask)
+		{
+			return begin + lowest_bit(mask);
+		}
+	}
+	return find_scalar(begin, end, value);
+}
+
+TARGET_SSE2 static const cell *find_last_sse2(const cell *begin, const cell *end, cell value)
+{
+	__m128i needle = _mm_set1_epi32(value);
+	const cell *pos = end;
+	for(; pos - begin >= 4; pos -= 4)
+	{
+		__m128i block = _mm_loadu_si128(reinterpret_cast<const __m128i*>(pos - 4));
+		int mask = _mm_movemask_ps(_mm_castsi128_ps(_mm_cmpeq_epi32(block, needle)));
+		if(mask)
+		{
+			return pos - 4 + highest_bit(mask);
+		}
+	}
+	const cell *found = find_last_scalar(begin, pos, value);
+	return found != pos ? found : end;
+}
+
+// the lanes of the accumulator are decremented by each match (the comparison produces -1)
+TARGET_SSE2 static size_t count_sse2(const cell *begin, const cell *end, cell value)
+{
+	__m128i needle = _mm_set1_epi32(value);
+	__m128i acc = _mm_setzero_si128();
+	for(; end - begin >= 4; begin += 4)
+	{
+		__m128i block = _mm_loadu_si128(reinterpret_cast<const __m128i*>(begin));
+		acc = _mm_sub_epi32(acc, _mm_cmpeq_epi32(block, needle));
+	}
+	alignas(16) std::uint32_t lanes[4];
+	_mm_store_si128(reinterpret_cast<__m128i*>(lanes), acc);
+	return static_cast<size_t>(lanes[0]) + lanes[1] + lanes[2] + lanes[3] + count_scalar(begin, end, value);
+}
+
+TARGET_SSE2 static const cell *find_sub_sse2(const cell *begin, const cell *end, const cell *sub, size_t sublen)
+{
+	__m128i first = _mm_set1_epi32(sub[0]);
+	__m128i last = _mm_set1_epi32(sub[sublen - 1]);
+	const cell *pos = begin;
+	const cell *limit = end - sublen;
+	for(; limit - pos >= 4; pos += 4)
+	{
+		__m128i block_first = _mm_loadu_si128(reinterpret_cast<const __m128i*>(pos));
+		__m128i block_last = _mm_loadu_si128(reinterpret_cast<const __m128i*>(pos + sublen - 1));
+		__m128i eq = _mm_and_si128(_mm_cmpeq_epi32(block_first, first), _mm_cmpeq_epi32(block_last, last));
+		unsigned int mask = _mm_movemask_ps(_mm_castsi128_ps(eq));
+		while(mask)
+		{
+			unsigned int bit = lowest_bit(mask);
+			if(equal_cells(pos + bit + 1, sub + 1, sublen - 2))
+			{
+				return pos + bit;
+			}
+			mask &= mask - 1;
+		}
+	}
+	return find_sub_scalar_from(pos, limit, end, sub, sublen);
+}
+
+TARGET_AVX2 static const cell *find_avx2(const cell *begin, const cell *end, cell value)
+{
+	__m256i needle = _mm256_set1_epi32(value);
+	for(; end - begin >= 8; begin += 8)
+	{
+		__m256i block = _mm256_loadu_si256(reinterpret_cast<const __m256i*>(begin));
+		int mask = _mm256_movemask_ps(_mm256_castsi256_ps(_mm256_cmpeq_epi32(block, needle)));
+		if(mask)
+		{
+			return begin + lowest_bit(mask);
+		}
+	}
+	return find_scalar(begin, end, value);
+}
+
+TARGET_AVX2 static const cell *find_last_avx2(const cell *begin, const cell *end, cell value)
+{
+	__m256i needle = _mm256_set1_epi32(value);
+	const cell *pos = end;
+	for(; pos - begin >= 8; pos -= 8)
+	{
+		__m256i block = _mm256_loadu_si256(reinterpret_cast<const __m256i*>(pos - 8));
+		int mask = _mm256_movemask_ps(_mm256_castsi256_ps(_mm256_cmpeq_epi32(block, needle)));
+		if(mask)
+		{
+			return pos - 8 + highest_bit(mask);
+		}
+	}
+	const cell *found = find_last_scalar(begin, pos, value);
+	return found != pos ? found : end;
+}
+
+TARGET_AVX2 static size_t count_avx2(const cell *begin, const cell *end, cell value)
+{
+	__m256i needle = _mm256_set1_epi32(value);
+	__m256i acc = _mm256_setzero_si256();
+	for(; end - begin >= 8; begin += 8)
+	{
+		__m256i block = _mm256_loadu_si256(reinterpret_cast<const __m256i*>(begin));
+		acc = _mm256_sub_epi32(acc, _mm256_cmpeq_epi32(block, needle));
+	}
+	alignas(32) std::uint32_t lanes[8];
+	_mm256_store_si256(reinterpret_cast<__m256i*>(lanes), acc);
+	size_t count = count_scalar(begin, end, value);
+	for(std::uint32_t lane : lanes)
+	{
+		count += lane;
+	}
+	return count;
+}
+
+TARGET_AVX2 static const cell *find_sub_avx2(const cell *begin, const cell *end, const cell *sub, size_t sublen)
+{
+	__m256i first = _mm256_set1_epi32(sub[0]);
+	__m256i last = _mm256_set1_epi32(sub[sublen - 1]);
+	const cell *pos = begin;
+	const cell *limit = end - sublen;
+	for(; limit - pos >= 8; pos += 8)
+	{
+		__m256i block_first = _mm256_loadu_si256(reinterpret_cast<const __m256i*>(pos));
+		__m256i block_last = _mm256_loadu_si256(reinterpret_cast<const __m256i*>(pos + sublen - 1));
+		__m256i eq = _mm256_and_si256(_mm256_cmpeq_epi32(block_first, first), _mm256_cmpeq_epi32(block_last, last));
+		unsigned int mask = _mm256_movemask_ps(_mm256_castsi256_ps(eq));
+		while(mask)
+		{
+			unsigned int bit = lowest_bit(mask);
+			if(equal_cells(pos + bit + 1, sub + 1, sublen - 2))
+			{
+				return pos + bit;
+			}
+			mask &= mask - 1;
+		}
+	}
+	return find_sub_scalar_from(pos, limit, end, sub, sublen);
+}
+
+static bool has_sse2()
+{
+#if defined(__x86_64__) || defined(_M_X64)
+	return true;
+#elif defined(_MSC_VER)
+	int info[4];
+	__cpuid(info, 1);
+	return (info[3] & (1 << 26)) != 0;
+#else
+	__builtin_cpu_init();
+	return __builtin_cpu_supports("sse2");
+#endif
+}
+
+static bool has_avx2()
+{
+#ifdef _MSC_VER
+	int info[4];
+	__cpuid(info, 0);
+	if(info[0] < 7)
+	{
+		return false;
+	}
+	__cpuid(info, 1);
+	// the OS must save the YMM registers
+	if(!(info[2] & (1 << 27)) || (_xgetbv(0) & 6) != 6)
+	{
+		return false;
+	}
+	__cpuidex(info, 7, 0);
+	return (info[1] & (1 << 5)) != 0;
+#else
+	__builtin_cpu_init();
+	return __builtin_cpu_supports("avx2");
+#endif
+}
+#endif
+
+static search_kernels select_kernels()
+{
+#ifdef CELL_SEARCH_X86
+	if(has_avx2())
+	{
+		return {find_avx2, find_last_avx2, find_sub_avx2, count_avx2};
+	}
+	if(has_sse2())
+	{
+		return {find_sse2, find_last_sse2, find_sub_sse2, count_sse2};
+	}
+#endif
+	return {find_scalar, find_last_scalar, find_sub_scalar, count_scalar};
+}
+
+static const search_kernels &kernels()
+{
+	static const search_kernels selected = select_kernels();
+	return selected;
+}
+
+const cell *aux::find_cell(const cell *begin, const cell *end, cell value)
+{
+	return kernels().find(begin, end, value);
+}
+
+const cell *aux::find_last_cell(const cell *begin, const cell *end, cell value)
+{
+	return kernels().find_last(begin, end, value);
+}
+
+size_t aux::count_cell(const cell *begin, const cell *end, cell value)
+{
+	return kernels().count(begin, end, value);
+}
+
+const cell *aux::find_cells(const cell *begin, const cell *end, const cell *sub, size_t sublen)
+{
+	if(sublen == 0)
+	{
+		return begin;
+	}
+	if(static_cast<size_t>(end - begin) < sublen)
+	{
+		return end;
+	}
+	if(sublen == 1)
+	{
+		return kernels().find(begin, end, sub[0]);
+	}
+	return kernels().find_sub(begin, end, sub, sublen);
+}
@@ -0,0 +1,22 @@
+#ifndef CELL_SEARCH_H_INCLUDED
+#define CELL_SEARCH_H_INCLUDED
+
+#include "sdk/amx/amx.h"
+#include <stddef.h>
+
+namespace aux
+{
+	// Searches in contiguous arrays of cells. SSE2 or AVX2 versions are
+	// selected on the first call, depending on what the processor supports.
+
+	// returns the first cell equal to value, or end
+	const cell *find_cell(const cell *begin, const cell *end, cell value);
+	// returns the last cell equal to value, or end
+	const cell *find_last_cell(const cell *begin, const cell *end, cell value);
+	// returns the number of cells equal to value
+	size_t count_cell(const cell *begin, const cell *end, cell value);
+	// returns the start of the first occurrence of [sub, sub + sublen), or end
+	const cell *find_cells(const cell *begin, const cell *end, const cell *sub, size_t sublen);
+}
+
+#endif
@@ -0,0 +1,72 @@
+#ifndef FREE_LIST_H_INCLUDED
+#define FREE_LIST_H_INCLUDED
+
+#include <cstddef>
+#include <new>
+#include <type_traits>
+
+namespace aux
+{
+	// Recycles storage for objects of a single type; not thread-safe
+	template <class Type>
+	class free_list
+	{
+		union node
+		{
+			node *next;
+			typename std::aligned_storage<sizeof(Type), alignof(Type)>::type storage;
+		};
+
+		node *head = nullptr;
+		size_t allocated = 0;
+		size_t reused = 0;
+
+	public:
+		free_list() = default;
+		free_list(const free_list&) = delete;
+		free_list &operator=(const free_list&) = delete;
+
+		void *allocate()
+		{
+			if(head)
+			{
+				node *n = head;
+				head = n->next;
+				reused++;
+				return n;
+			}
+			allocated++;
+			return ::operator new(sizeof(node));
+		}
+
+		void deallocate(void *ptr) noexcept
+		{
+			if(!ptr) return;
+			node *n = static_cast<node*>(ptr);
+			n->next = head;
+			head = n;
+		}
+
+		size_t num_allocated() const
+		{
+			return allocated;
+		}
+
+		size_t num_reused() const
+		{
+			return reused;
+		}
+
+		~free_list()
+		{
+			while(head)
+			{
+				node *n = head;
+				head = n->next;
+				::operator delete(n);
+			}
+		}
+	};
+}
+
+#endif
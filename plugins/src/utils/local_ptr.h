@@ -0,0 +1,123 @@
+#ifndef LOCAL_PTR_H_INCLUDED
+#define LOCAL_PTR_H_INCLUDED
+
+#include <cstddef>
+#include <memory>
+#include <utility>
+
+namespace aux
+{
+	// Temporary access to an object obtained from a local_weak_ptr.
+	// Holds a strong reference unless it was created by lock_local on the owning thread.
+	template <class Type>
+	class local_lock
+	{
+		Type *ptr;
+		std::shared_ptr<Type> owner;
+
+	public:
+		local_lock() : ptr(nullptr)
+		{
+
+		}
+
+		local_lock(std::nullptr_t) : ptr(nullptr)
+		{
+
+		}
+
+		explicit local_lock(Type *ptr) : ptr(ptr)
+		{
+
+		}
+
+		explicit local_lock(std::shared_ptr<Type> &&owner) : ptr(owner.get()), owner(std::move(owner))
+		{
+
+		}
+
+		Type *get() const
+		{
+			return ptr;
+		}
+
+		Type &operator*() const
+		{
+			return *ptr;
+		}
+
+		Type *operator->() const
+		{
+			return ptr;
+		}
+
+		explicit operator bool() const
+		{
+			return ptr != nullptr;
+		}
+	};
+
+	// Weak reference to an object owned by std::shared_ptr that is normally only
+	// touched by a single thread. On that thread, lock_local checks the object is
+	// alive without modifying the reference counts, which are atomic and therefore
+	// costly to update. Any other thread is handed a proper strong reference.
+	// Such a lock does not keep the object alive, so it must not be held across
+	// anything that can run user code (tag operations, expressions), as that code
+	// may destroy the object; lock_strong is used there instead.
+	template <class Type>
+	class local_weak_ptr
+	{
+		template <class Other>
+		friend class local_weak_ptr;
+
+		std::weak_ptr<Type> ref;
+		Type *ptr;
+
+	public:
+		local_weak_ptr() : ptr(nullptr)
+		{
+
+		}
+
+		local_weak_ptr(const std::shared_ptr<Type> &obj) : ref(obj), ptr(obj.get())
+		{
+
+		}
+
+		bool expired() const
+		{
+			return ref.expired();
+		}
+
+		std::shared_ptr<Type> lock() const
+		{
+			return ref.lock();
+		}
+
+		local_lock<Type> lock_local(bool owner_thread) const
+		{
+			if(owner_thread)
+			{
+				if(ref.expired())
+				{
+					return nullptr;
+				}
+				return local_lock<Type>(ptr);
+			}
+			return local_lock<Type>(ref.lock());
+		}
+
+		local_lock<Type> lock_strong() const
+		{
+			return local_lock<Type>(ref.lock());
+		}
+
+		template <class Other>
+		bool owner_before(const local_weak_ptr<Other> &obj) const
+		{
+			return ref.owner_before(obj.ref);
+		}
+	};
+}
+
+#endif
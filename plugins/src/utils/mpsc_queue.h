@@ -0,0 +1,80 @@
+#ifndef MPSC_QUEUE_H_INCLUDED
+#define MPSC_QUEUE_H_INCLUDED
+
+#include <atomic>
+#include <utility>
+
+namespace aux
+{
+	// Lock-free queue for any number of producer threads and a single consumer thread.
+	// Producers push onto a shared stack, the consumer takes the whole stack at once
+	// and keeps it in its own list in the original order.
+	template <class Type>
+	class mpsc_queue
+	{
+		struct node
+		{
+			node *next = nullptr;
+			Type value;
+
+			node(Type &&value) : value(std::move(value))
+			{
+
+			}
+		};
+
+		std::atomic<node*> pushed{nullptr};
+		node *ready = nullptr;
+
+	public:
+		mpsc_queue() = default;
+		mpsc_queue(const mpsc_queue&) = delete;
+		mpsc_queue &operator=(const mpsc_queue&) = delete;
+
+		// may be called from any thread
+		void push(Type value)
+		{
+			node *n = new node(std::move(value));
+			n->next = pushed.load(std::memory_order_relaxed);
+			while(!pushed.compare_exchange_weak(n->next, n, std::memory_order_release, std::memory_order_relaxed));
+		}
+
+		// may be called only from the consumer thread
+		bool pop(Type &value)
+		{
+			if(!ready)
+			{
+				node *n = pushed.exchange(nullptr, std::memory_order_acquire);
+				while(n)
+				{
+					node *next = n->next;
+					n->next = ready;
+					ready = n;
+					n = next;
+				}
+				if(!ready)
+				{
+					return false;
+				}
+			}
+			node *n = ready;
+			ready = n->next;
+			value = std::move(n->value);
+			delete n;
+			return true;
+		}
+
+		void clear()
+		{
+			Type value;
+			while(pop(value));
+		}
+
+		~mpsc_queue()
+		{
+			clear();
+		}
+	};
+}
+
+#endif
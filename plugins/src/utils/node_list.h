@@ -0,0 +1,460 @@
+#ifndef NODE_LIST_H_INCLUDED
+#define NODE_LIST_H_INCLUDED
+
+#include <cstddef>
+#include <iterator>
+#include <type_traits>
+#include <utility>
+
+namespace aux
+{
+	// Doubly-linked list storing its elements directly in the nodes; not thread-safe.
+	// Nodes come from a pool shared by all lists of the same type and are never
+	// returned to the system, so a node pointer stays readable after erasure.
+	// Erasing an element bumps the generation of its node, which lets a holder
+	// of an iterator detect that the element is gone.
+	template <class Type>
+	class node_list
+	{
+		struct link
+		{
+			link *prev;
+			link *next;
+		};
+
+		struct node : public link
+		{
+			size_t generation;
+			typename std::aligned_storage<sizeof(Type), alignof(Type)>::type storage;
+
+			Type &value()
+			{
+				return *reinterpret_cast<Type*>(&storage);
+			}
+		};
+
+		class node_pool
+		{
+			static constexpr size_t block_size = 64;
+
+			struct block
+			{
+				block *next;
+				node nodes[block_size];
+			};
+
+			// constant-initialized, and only releases its blocks once no node is in use,
+			// so lists with static storage can be destroyed in any order
+			block *blocks = nullptr;
+			link *free = nullptr;
+			size_t num_blocks = 0;
+			size_t used = 0;
+
+		public:
+			node *allocate()
+			{
+				if(!free)
+				{
+					block *b = new block;
+					for(size_t i = block_size; i-- > 0;)
+					{
+						b->nodes[i].generation = 1;
+						b->nodes[i].next = free;
+						free = &b->nodes[i];
+					}
+					b->next = blocks;
+					blocks = b;
+					num_blocks++;
+				}
+				node *n = static_cast<node*>(free);
+				free = n->next;
+				used++;
+				return n;
+			}
+
+			void deallocate(node *n) noexcept
+			{
+				n->generation++;
+				n->next = free;
+				free = n;
+				used--;
+			}
+
+			size_t capacity() const
+			{
+				return num_blocks * block_size;
+			}
+
+			size_t size() const
+			{
+				return used;
+			}
+
+			~node_pool()
+			{
+				if(used == 0)
+				{
+					while(blocks)
+					{
+						block *b = blocks;
+						blocks = b->next;
+						delete b;
+					}
+					free = nullptr;
+					num_blocks = 0;
+				}
+			}
+		};
+
+		static node_pool pool;
+
+		link head;
+		size_t count = 0;
+
+		template <class... Args>
+		static node *create(Args&&... args)
+		{
+			node *n = pool.allocate();
+			try{
+				new (&n->storage) Type(std::forward<Args>(args)...);
+			}catch(...)
+			{
+				pool.deallocate(n);
+				throw;
+			}
+			return n;
+		}
+
+		static void destroy(link *l) noexcept
+		{
+			node *n = static_cast<node*>(l);
+			n->value().~Type();
+			pool.deallocate(n);
+		}
+
+		void reset() noexcept
+		{
+			head.prev = head.next = &head;
+			count = 0;
+		}
+
+		void take(node_list &other) noexcept
+		{
+			if(other.count == 0)
+			{
+				reset();
+				return;
+			}
+			head = other.head;
+			head.prev->next = &head;
+			head.next->prev = &head;
+			count = other.count;
+			other.reset();
+		}
+
+		link *link_before(link *position, link *l) noexcept
+		{
+			l->next = position;
+			l->prev = position->prev;
+			position->prev->next = l;
+			position->prev = l;
+			count++;
+			return l;
+		}
+
+	public:
+		template <class Value, class Link>
+		class basic_iterator
+		{
+			friend class node_list;
+
+			Link *ptr;
+
+			explicit basic_iterator(Link *ptr) : ptr(ptr)
+			{
+
+			}
+
+		public:
+			typedef std::bidirectional_iterator_tag iterator_category;
+			typedef typename std::remove_const<Value>::type value_type;
+			typedef ptrdiff_t difference_type;
+			typedef Value *pointer;
+			typedef Value &reference;
+
+			basic_iterator() : ptr(nullptr)
+			{
+
+			}
+
+			template <class OtherValue, class OtherLink>
+			basic_iterator(const basic_iterator<OtherValue, OtherLink> &obj) : ptr(obj.ptr)
+			{
+
+			}
+
+			reference operator*() const
+			{
+				return static_cast<node*>(const_cast<link*>(ptr))->value();
+			}
+
+			pointer operator->() const
+			{
+				return &**this;
+			}
+
+			basic_iterator &operator++()
+			{
+				ptr = ptr->next;
+				return *this;
+			}
+
+			basic_iterator operator++(int)
+			{
+				basic_iterator tmp(*this);
+				ptr = ptr->next;
+				return tmp;
+			}
+
+			basic_iterator &operator--()
+			{
+				ptr = ptr->prev;
+				return *this;
+			}
+
+			basic_iterator operator--(int)
+			{
+				basic_iterator tmp(*this);
+				ptr = ptr->prev;
+				return tmp;
+			}
+
+			template <class OtherValue, class OtherLink>
+			bool operator==(const basic_iterator<OtherValue, OtherLink> &obj) const
+			{
+				return ptr == obj.ptr;
+			}
+
+			template <class OtherValue, class OtherLink>
+			bool operator!=(const basic_iterator<OtherValue, OtherLink> &obj) const
+			{
+				return ptr != obj.ptr;
+			}
+
+			// only meaningful for an iterator that pointed to an element
+			size_t generation() const
+			{
+				return static_cast<const node*>(ptr)->generation;
+			}
+
+			template <class OtherValue, class OtherLink>
+			friend class basic_iterator;
+		};
+
+		typedef Type value_type;
+		typedef Type &reference;
+		typedef const Type &const_reference;
+		typedef size_t size_type;
+		typedef ptrdiff_t difference_type;
+		typedef basic_iterator<Type, link> iterator;
+		typedef basic_iterator<const Type, const link> const_iterator;
+
+		node_list() noexcept
+		{
+			reset();
+		}
+
+		node_list(const node_list &obj) : node_list()
+		{
+			insert(end(), obj.cbegin(), obj.cend());
+		}
+
+		node_list(node_list &&obj) noexcept
+		{
+			take(obj);
+		}
+
+		node_list &operator=(const node_list &obj)
+		{
+			if(this != &obj)
+			{
+				node_list tmp(obj);
+				clear();
+				take(tmp);
+			}
+			return *this;
+		}
+
+		node_list &operator=(node_list &&obj) noexcept
+		{
+			if(this != &obj)
+			{
+				clear();
+				take(obj);
+			}
+			return *this;
+		}
+
+		~node_list()
+		{
+			clear();
+		}
+
+		iterator begin()
+		{
+			return iterator(head.next);
+		}
+
+		iterator end()
+		{
+			return iterator(&head);
+		}
+
+		const_iterator begin() const
+		{
+			return const_iterator(head.next);
+		}
+
+		const_iterator end() const
+		{
+			return const_iterator(&head);
+		}
+
+		const_iterator cbegin() const
+		{
+			return begin();
+		}
+
+		const_iterator cend() const
+		{
+			return end();
+		}
+
+		size_t size() const
+		{
+			return count;
+		}
+
+		bool empty() const
+		{
+			return count == 0;
+		}
+
+		void clear() noexcept
+		{
+			link *l = head.next;
+			while(l != &head)
+			{
+				link *next = l->next;
+				destroy(l);
+				l = next;
+			}
+			reset();
+		}
+
+		template <class... Args>
+		iterator emplace(const_iterator position, Args&&... args)
+		{
+			return iterator(link_before(const_cast<link*>(position.ptr), create(std::forward<Args>(args)...)));
+		}
+
+		iterator insert(const_iterator position, const Type &value)
+		{
+			return emplace(position, value);
+		}
+
+		iterator insert(const_iterator position, Type &&value)
+		{
+			return emplace(position, std::move(value));
+		}
+
+		template <class InputIterator>
+		iterator insert(const_iterator position, InputIterator first, InputIterator last)
+		{
+			// built separately so that a list can be inserted into itself
+			node_list tmp;
+			for(; first != last; ++first)
+			{
+				tmp.emplace(tmp.cend(), *first);
+			}
+			return splice(position, tmp);
+		}
+
+		void push_back(const Type &value)
+		{
+			emplace(cend(), value);
+		}
+
+		void push_back(Type &&value)
+		{
+			emplace(cend(), std::move(value));
+		}
+
+		iterator erase(const_iterator position)
+		{
+			link *l = const_cast<link*>(position.ptr);
+			link *next = l->next;
+			l->prev->next = next;
+			next->prev = l->prev;
+			count--;
+			destroy(l);
+			return iterator(next);
+		}
+
+		iterator erase(const_iterator first, const_iterator last)
+		{
+			while(first != last)
+			{
+				first = erase(first);
+			}
+			return iterator(const_cast<link*>(last.ptr));
+		}
+
+		// moves all elements of other before position, returns the first one moved
+		iterator splice(const_iterator position, node_list &other) noexcept
+		{
+			link *pos = const_cast<link*>(position.ptr);
+			if(other.count == 0)
+			{
+				return iterator(pos);
+			}
+			link *first = other.head.next;
+			link *last = other.head.prev;
+			first->prev = pos->prev;
+			last->next = pos;
+			pos->prev->next = first;
+			pos->prev = last;
+			count += other.count;
+			other.reset();
+			return iterator(first);
+		}
+
+		void swap(node_list &other) noexcept
+		{
+			node_list tmp(std::move(other));
+			other.take(*this);
+			take(tmp);
+		}
+
+		static size_t pool_capacity()
+		{
+			return pool.capacity();
+		}
+
+		static size_t pool_size()
+		{
+			return pool.size();
+		}
+	};
+
+	template <class Type>
+	typename node_list<Type>::node_pool node_list<Type>::pool;
+
+	template <class Type>
+	inline void swap(node_list<Type> &a, node_list<Type> &b) noexcept
+	{
+		a.swap(b);
+	}
+}
+
+#endif
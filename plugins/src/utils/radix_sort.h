@@ -0,0 +1,64 @@
+#ifndef RADIX_SORT_H_INCLUDED
+#define RADIX_SORT_H_INCLUDED
+
+#include <cstdint>
+#include <cstddef>
+#include <utility>
+#include <vector>
+
+namespace aux
+{
+	struct radix_entry
+	{
+		std::uint32_t key;
+		std::uint32_t index;
+	};
+
+	// Stable LSD radix sort on the key, one byte per pass; passes in which
+	// all keys share the same byte are skipped
+	inline void radix_sort(std::vector<radix_entry> &entries)
+	{
+		size_t count = entries.size();
+		if(count < 2) return;
+
+		size_t histogram[4][256] = {};
+		for(const auto &entry : entries)
+		{
+			for(size_t pass = 0; pass < 4; pass++)
+			{
+				histogram[pass][(entry.key >> (pass * 8)) & 0xFF]++;
+			}
+		}
+
+		std::vector<radix_entry> buffer(count);
+		radix_entry *src = entries.data();
+		radix_entry *dst = buffer.data();
+		for(size_t pass = 0; pass < 4; pass++)
+		{
+			size_t *counts = histogram[pass];
+			size_t shift = pass * 8;
+			if(counts[(src[0].key >> shift) & 0xFF] == count)
+			{
+				continue;
+			}
+			size_t offset = 0;
+			for(size_t i = 0; i < 256; i++)
+			{
+				size_t num = counts[i];
+				counts[i] = offset;
+				offset += num;
+			}
+			for(size_t i = 0; i < count; i++)
+			{
+				dst[counts[(src[i].key >> shift) & 0xFF]++] = src[i];
+			}
+			std::swap(src, dst);
+		}
+		if(src != entries.data())
+		{
+			entries.swap(buffer);
+		}
+	}
+}
+
+#endif
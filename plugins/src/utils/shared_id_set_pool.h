@@ -15,6 +15,9 @@ namespace aux
 		using map_template = std::unordered_map<Key, Value>;
 
 		map_template<Type*, std::shared_ptr<Type>> data;
+		void (*observer)(const void *value) = nullptr;
+		void (*remove_observer)(const void *value) = nullptr;
+		void (*access_observer)(const void *value) = nullptr;
 
 		typedef typename map_template<Type*, std::shared_ptr<Type>>::iterator iterator;
 		typedef typename map_template<Type*, std::shared_ptr<Type>>::const_iterator const_iterator;
@@ -23,7 +26,30 @@ namespace aux
 		const std::shared_ptr<Type> &add(std::shared_ptr<Type> &&value)
 		{
 			auto ptr = value.get();
-			return data.emplace(ptr, std::move(value)).first->second;
+			const auto &result = data.emplace(ptr, std::move(value)).first->second;
+			if(observer)
+			{
+				observer(ptr);
+			}
+			return result;
+		}
+
+		// the observer is called with every value added to the pool
+		void set_observer(void (*func)(const void *value))
+		{
+			observer = func;
+		}
+
+		// the observer is called with every value removed from the pool, except by extract
+		void set_remove_observer(void (*func)(const void *value))
+		{
+			remove_observer = func;
+		}
+
+		// the observer is called with every value obtained by its ID, since it may be modified afterwards
+		void set_access_observer(void (*func)(const void *value))
+		{
+			access_observer = func;
 		}
 
 		const std::shared_ptr<Type> &add()
@@ -63,6 +89,10 @@ namespace aux
 			auto it = data.find(value);
 			if(it != data.end())
 			{
+				if(remove_observer)
+				{
+					remove_observer(value);
+				}
 				std::shared_ptr<Type> orig(std::move(it->second));
 				data.erase(it);
 				return true;
@@ -72,6 +102,13 @@ namespace aux
 
 		void clear()
 		{
+			if(remove_observer)
+			{
+				for(const auto &pair : data)
+				{
+					remove_observer(pair.first);
+				}
+			}
 			data.clear();
 		}
 
@@ -85,11 +122,25 @@ namespace aux
 			return data.end();
 		}
 
+		const_iterator begin() const
+		{
+			return data.begin();
+		}
+
+		const_iterator end() const
+		{
+			return data.end();
+		}
+
 		bool get_by_id(cell id, Type *&value)
 		{
 			value = reinterpret_cast<Type*>(id);
 			if(data.find(value) != data.end())
 			{
+				if(access_observer)
+				{
+					access_observer(value);
+				}
 				return true;
 			}
 			return false;
@@ -100,6 +151,10 @@ namespace aux
 			auto it = data.find(reinterpret_cast<Type*>(id));
 			if(it != data.end())
 			{
+				if(access_observer)
+				{
+					access_observer(it->first);
+				}
 				value = it->second;
 				return true;
 			}
@@ -133,6 +188,10 @@ namespace aux
 
 		auto erase(iterator it) -> decltype(data.erase(it))
 		{
+			if(remove_observer)
+			{
+				remove_observer(it->first);
+			}
 			return data.erase(it);
 		}
 